@@ -1,11 +1,26 @@
 #define MINIAUDIO_IMPLEMENTATION
 #include "AudioEngine.hpp"
+#include "Trace.hpp"
+#include "dsp/CpuDispatch.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
 
-AudioEngine::AudioEngine() : internalBuffer(2, 512) {
+AudioEngine::AudioEngine() {
+    // Every session is logged for rx-replay; RX_EVENT_LOG picks the file
+    const char* logPath = std::getenv("RX_EVENT_LOG");
+    std::string defaultPath = (std::filesystem::temp_directory_path() / "rx-session.rxlog").string();
+    if (!logPath || !*logPath) logPath = defaultPath.c_str();
+    engine = rx_create_logged(44100.0, logPath);
+    if (engine) std::cout << "Event log: " << logPath << std::endl;
+    else engine = rx_create(44100.0);
+    synth = rx_get_synth(engine);
+    rx_set_tap(engine, outputTap, this);
+
     ma_device_config config = ma_device_config_init(ma_device_type_playback);
     config.playback.format   = ma_format_f32;
-    config.playback.channels = 2;
+    config.playback.channels = RX_CHANNELS;
     config.sampleRate        = 44100;
     config.dataCallback      = dataCallback;
     config.pUserData         = this;
@@ -13,43 +28,50 @@ AudioEngine::AudioEngine() : internalBuffer(2, 512) {
     if (ma_device_init(NULL, &config, &device) != MA_SUCCESS) {
         std::cerr << "Failed to initialize miniaudio device." << std::endl;
     }
-    
-    synth.setSampleRate(44100.0);
+    // Monitoring processes read the output from here; the synth runs fine without it
+    if (!sharedTap.open(SharedTap::DEFAULT_NAME, RX_CHANNELS, 44100.0)) std::cerr << sharedTap.getError() << std::endl;
 }
 
 AudioEngine::~AudioEngine() {
     ma_device_uninit(&device);
+    rx_destroy(engine);
 }
 
 void AudioEngine::dataCallback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
-    AudioEngine* engine = (AudioEngine*)pDevice->pUserData;
-    
-    // Ensure our internal planar buffer matches the requested size
-    engine->internalBuffer.resize(2, frameCount);
-    engine->internalBuffer.clear();
-    
-    // Render from synth to planar buffer
-    engine->synth.render(engine->internalBuffer);
-    
-    // Convert planar to interleaved for miniaudio output
-    float* out = (float*)pOutput;
-    float* pL = engine->internalBuffer.getChannel(0);
-    float* pR = engine->internalBuffer.getChannel(1);
-    
-    if (pL && pR) {
-        for (ma_uint32 i = 0; i < frameCount; ++i) {
-            out[i*2] = pL[i];
-            out[i*2 + 1] = pR[i];
-        }
-        // Write to scope for visualization
-        engine->scopeBuffer.write(pL, frameCount);
+    AudioEngine* audio = (AudioEngine*)pDevice->pUserData;
+    auto start = std::chrono::steady_clock::now();
+    RX_TRACE_THREAD("audio");
+    RX_TRACE_SCOPE("AudioEngine::dataCallback");
+
+    // miniaudio hands us interleaved stereo
+    rx_process_interleaved(audio->engine, (float*)pOutput, (int)frameCount, nullptr, 0);
+
+    double budget = (double)frameCount / pDevice->sampleRate;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (elapsed > budget) {
+        audio->lateCallbacks.fetch_add(1, std::memory_order_relaxed);
+        RX_TRACE_INSTANT("xrun");
     }
+    audio->sharedTap.endBlock((float)(elapsed / budget), audio->lateCallbacks.load(std::memory_order_relaxed));
+}
+
+void AudioEngine::outputTap(const float* const* channels, int frames, void* user) {
+    AudioEngine* audio = (AudioEngine*)user;
+    audio->scopeBuffer.write(channels[0], frames); // For visualization
+    audio->recorder.push(channels, frames);        // A no-op unless recording
+    audio->sharedTap.write(channels, frames);      // For rx-meter and other local readers
 }
 
 bool AudioEngine::start() {
+    // Pin and touch the render state before the first callback
+    if (!getArena().isPrefaulted()) {
+        rx_prepare_realtime(engine);
+        getArena().printFootprint(std::cout);
+        std::cout << "DSP kernels: " << CpuDispatch::isaName(CpuDispatch::isa()) << std::endl;
+    }
     return ma_device_start(&device) == MA_SUCCESS;
 }
 
 void AudioEngine::stop() {
     ma_device_stop(&device);
-}
\ No newline at end of file
+}
@@ -1,10 +1,15 @@
 #pragma once
 #include "miniaudio.h"
+#include "rx.h"
 #include "SynthEngine.hpp"
 #include "ScopeBuffer.hpp"
-#include "dsp/DspBuffer.hpp"
-#include <memory>
+#include "Recorder.hpp"
+#include "SharedTap.hpp"
+#include "RealtimeArena.hpp"
+#include <atomic>
 
+// The app's audio device: a miniaudio client of the rx embedding API, so it renders
+// through the same path as any other host
 class AudioEngine {
 public:
     AudioEngine();
@@ -16,20 +21,30 @@ public:
     void initialize() { start(); }
     void teardown() { stop(); }
     
-    SynthEngine* getSynthEngine() { return &synth; }
+    SynthEngine* getSynthEngine() { return synth; }
     
-    void noteOn(int note, int velocity) { synth.noteOn(note, velocity); }
-    void noteOff(int note) { synth.noteOff(note); }
-    void setMasterVolume(float vol) { synth.setMasterVolume(vol); }
+    void noteOn(int note, int velocity) { synth->noteOn(note, velocity); }
+    void noteOff(int note) { synth->noteOff(note); }
+    void setMasterVolume(float vol) { synth->setMasterVolume(vol); }
 
-    SynthEngine& getSynth() { return synth; }
+    SynthEngine& getSynth() { return *synth; }
+    rx_engine* getEngine() { return engine; }
     ScopeBuffer& getScopeBuffer() { return scopeBuffer; }
+    Recorder& getRecorder() { return recorder; } // Master output to disk
+    const SharedTap& getSharedTap() const { return sharedTap; } // Master output to other processes (rx-meter)
+    // Callbacks that overran their buffer's duration (likely dropouts); each is marked "xrun" in the trace
+    uint64_t getLateCallbacks() const { return lateCallbacks.load(std::memory_order_relaxed); }
+    const RealtimeArena& getArena() const { return *rx_get_arena(engine); }
 
 private:
     ma_device device;
-    SynthEngine synth;
+    rx_engine* engine = nullptr; // Owns the synth and its arena
+    SynthEngine* synth = nullptr;
     ScopeBuffer scopeBuffer;
-    DspBuffer internalBuffer; // Planar buffer for processing
+    Recorder recorder;
+    SharedTap sharedTap;
+    std::atomic<uint64_t> lateCallbacks{0};
 
     static void dataCallback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
-};
\ No newline at end of file
+    static void outputTap(const float* const* channels, int frames, void* user);
+};
@@ -0,0 +1,173 @@
+#include "Automation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static bool before(uint64_t frame, const AutomationPoint& p) { return frame < p.frame; }
+
+void AutomationLane::add(uint64_t frame, float value) {
+    auto it = std::lower_bound(points.begin(), points.end(), frame,
+                               [](const AutomationPoint& p, uint64_t f) { return p.frame < f; });
+    if (it != points.end() && it->frame == frame) it->value = value;
+    else points.insert(it, { frame, value });
+    cursor = 0;
+}
+
+void AutomationLane::record(uint64_t frame, float value) {
+    size_t n = points.size();
+    if (n > 0 && frame < points[n - 1].frame) return;
+    if (n > 0 && frame == points[n - 1].frame) {
+        points[n - 1].value = value;
+    } else if (n >= 2 && points[n - 1].value == value && points[n - 2].value == value) {
+        points[n - 1].frame = frame; // Stretch the flat run instead of adding to it
+    } else {
+        points.push_back({ frame, value });
+    }
+}
+
+void AutomationLane::seek(uint64_t frame) {
+    cursor = std::upper_bound(points.begin(), points.end(), frame, before) - points.begin();
+}
+
+float AutomationLane::valueAt(uint64_t frame) {
+    if (points.empty()) return 0.0f;
+    if (cursor > 0 && frame < points[cursor - 1].frame) seek(frame); // Went backwards
+    while (cursor < points.size() && points[cursor].frame <= frame) ++cursor;
+    if (cursor == 0) return points[0].value;
+    if (cursor == points.size()) return points.back().value;
+    const AutomationPoint& a = points[cursor - 1];
+    const AutomationPoint& b = points[cursor];
+    return a.value + (b.value - a.value) * (float)((double)(frame - a.frame) / (double)(b.frame - a.frame));
+}
+
+bool AutomationLane::isFlat(uint64_t frame, int frames) {
+    float value = valueAt(frame);
+    // Every point up to the first one past the span must hold the same value
+    for (size_t i = cursor; i < points.size(); ++i) {
+        if (points[i].value != value) return false;
+        if (points[i].frame >= frame + (uint64_t)frames) break;
+    }
+    return true;
+}
+
+bool Automation::isEmpty() const {
+    for (const auto& l : lanes) {
+        if (!l.isEmpty()) return false;
+    }
+    return true;
+}
+
+void Automation::clear() {
+    for (auto& l : lanes) l.clear();
+    std::fill(hasApplied, hasApplied + TARGET_COUNT, false);
+}
+
+void Automation::seek(uint64_t frame) {
+    for (auto& l : lanes) l.seek(frame);
+    std::fill(hasApplied, hasApplied + TARGET_COUNT, false); // Re-apply from the new position
+}
+
+void Automation::apply(SynthEngine& synth, uint64_t frame) {
+    bool changed[TARGET_COUNT] = {};
+    for (int t = 0; t < TARGET_COUNT; ++t) {
+        if (lanes[t].isEmpty()) continue;
+        float value = lanes[t].valueAt(frame);
+        if (hasApplied[t] && value == applied[t]) continue;
+        applied[t] = value;
+        hasApplied[t] = true;
+        changed[t] = true;
+    }
+    if (changed[(int)AutomationTarget::Cutoff]) synth.setFilterCutoff(applied[(int)AutomationTarget::Cutoff]);
+    if (changed[(int)AutomationTarget::Resonance]) synth.setFilterResonance(applied[(int)AutomationTarget::Resonance]);
+    if (changed[(int)AutomationTarget::Volume]) synth.setMasterVolume(applied[(int)AutomationTarget::Volume]);
+
+    // The envelope is set as a whole; stages without a lane keep the engine's values
+    int first = (int)AutomationTarget::Attack;
+    if (changed[first] || changed[first + 1] || changed[first + 2] || changed[first + 3]) {
+        float adsr[4];
+        synth.getEnvelopeParams(adsr[0], adsr[1], adsr[2], adsr[3]);
+        for (int i = 0; i < 4; ++i) {
+            if (hasApplied[first + i]) adsr[i] = applied[first + i];
+        }
+        synth.setEnvelopeParams(adsr[0], adsr[1], adsr[2], adsr[3]);
+    }
+}
+
+void Automation::render(SynthEngine& synth, DspBuffer& output, uint64_t frame) {
+    int frames = output.getNumFrames();
+    bool ramping = false;
+    for (auto& l : lanes) {
+        if (!l.isEmpty() && !l.isFlat(frame, frames)) ramping = true;
+    }
+    if (!ramping) {
+        apply(synth, frame);
+        synth.render(output);
+        return;
+    }
+
+    DspBuffer piece; // A view into the output; no allocation
+    float* channels[DspBuffer::MAX_CHANNELS];
+    for (int done = 0; done < frames;) {
+        int n = std::min(INTERVAL, frames - done);
+        apply(synth, frame + done);
+        for (int c = 0; c < output.getNumChannels(); ++c) channels[c] = output.getChannel(c) + done;
+        piece.wrap(channels, output.getNumChannels(), n);
+        synth.render(piece);
+        done += n;
+    }
+}
+
+static const char* targetNames[Automation::TARGET_COUNT] = {
+    "cutoff", "resonance", "attack", "decay", "sustain", "release", "volume"
+};
+
+const char* Automation::targetName(AutomationTarget target) {
+    return targetNames[(int)target];
+}
+
+bool Automation::load(const std::string& path, double sampleRate) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        char name[32];
+        double seconds;
+        float value;
+        if (line.empty() || line[0] == '#') continue;
+        int target = -1;
+        if (std::sscanf(line.c_str(), "%31s %lf %f", name, &seconds, &value) == 3) {
+            for (int t = 0; t < TARGET_COUNT; ++t) {
+                if (!std::strcmp(name, targetNames[t])) target = t;
+            }
+        }
+        if (target < 0 || seconds < 0.0) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected \"<target> <seconds> <value>\"";
+            clear();
+            return false;
+        }
+        lanes[target].add((uint64_t)std::llround(seconds * sampleRate), value);
+    }
+    return true;
+}
+
+bool Automation::save(const std::string& path, double sampleRate) const {
+    std::ofstream file(path);
+    if (!file) return false;
+    char line[96];
+    for (int t = 0; t < TARGET_COUNT; ++t) {
+        for (const auto& p : lanes[t].getPoints()) {
+            // Enough digits to land back on the same frame
+            std::snprintf(line, sizeof(line), "%s %.9f %.9g\n", targetNames[t], p.frame / sampleRate, p.value);
+            file << line;
+        }
+    }
+    return (bool)file;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "SynthEngine.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class AutomationTarget { Cutoff, Resonance, Attack, Decay, Sustain, Release, Volume };
+
+struct AutomationPoint {
+    uint64_t frame;
+    float value;
+};
+
+// One parameter's automation as sparse breakpoints, linear in between and held before
+// the first and after the last. Playback moves a cursor forward; seek() is a binary search.
+class AutomationLane {
+public:
+    // Keeps the points sorted; a point at an existing frame replaces it. Not for the audio thread
+    void add(uint64_t frame, float value);
+    // Appends during capture (frames must not go backwards). A run of equal values keeps
+    // only its ends, so holding a control still costs two points.
+    void record(uint64_t frame, float value);
+    void clear() { points.clear(); cursor = 0; }
+    bool isEmpty() const { return points.empty(); }
+    const std::vector<AutomationPoint>& getPoints() const { return points; }
+
+    void seek(uint64_t frame);
+    float valueAt(uint64_t frame); // Cheap when frames move forward
+    bool isFlat(uint64_t frame, int frames); // Constant over [frame, frame + frames]
+
+private:
+    std::vector<AutomationPoint> points;
+    size_t cursor = 0; // First point after the last position looked up
+};
+
+// Automation lanes for one SynthEngine, evaluated per block. Static lanes cost a compare
+// per block and never touch the engine; while any lane is ramping the block is rendered
+// in INTERVAL-frame pieces so parameters move in small steps.
+class Automation {
+public:
+    static const int TARGET_COUNT = 7;
+    static constexpr int INTERVAL = 32; // Frames between updates during ramps
+
+    AutomationLane& lane(AutomationTarget target) { return lanes[(int)target]; }
+    bool isEmpty() const;
+    void clear();
+    void seek(uint64_t frame);
+
+    // Renders output.getNumFrames() at timeline position `frame` with the lanes applied
+    void render(SynthEngine& synth, DspBuffer& output, uint64_t frame);
+
+    // Text, one point per line: "<target> <seconds> <value>", e.g. "cutoff 1.5 1200"
+    bool load(const std::string& path, double sampleRate);
+    bool save(const std::string& path, double sampleRate) const;
+    const std::string& getError() const { return error; }
+
+    static const char* targetName(AutomationTarget target);
+
+private:
+    AutomationLane lanes[TARGET_COUNT];
+    float applied[TARGET_COUNT] = {};
+    bool hasApplied[TARGET_COUNT] = {};
+    std::string error;
+
+    void apply(SynthEngine& synth, uint64_t frame);
+};
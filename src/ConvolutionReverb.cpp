@@ -0,0 +1,332 @@
+#include "ConvolutionReverb.hpp"
+#include "WavFile.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+
+static const int P = ImpulseResponse::HEAD_SIZE;
+static const int T = ImpulseResponse::TAIL_SIZE;
+
+// acc += x * h over split complex arrays; the loop vectorizes
+static void multiplyAccumulate(const float* xr, const float* xi, const float* hr, const float* hi,
+                               float* ar, float* ai, int bins) {
+    for (int k = 0; k < bins; ++k) {
+        ar[k] += xr[k] * hr[k] - xi[k] * hi[k];
+        ai[k] += xr[k] * hi[k] + xi[k] * hr[k];
+    }
+}
+
+// One overlap-save step: transform the window into the delay line at `pos`,
+// sum it against every IR partition, and return the valid half in `out`.
+static void convolveWindow(Fft& fft, const float* window, int pos, int count, int bins,
+                           float* fdlRe, float* fdlIm, const float* irRe, const float* irIm,
+                           float* accRe, float* accIm, float* time, float* out, int outCount) {
+    fft.forward(window, fdlRe + (size_t)pos * bins, fdlIm + (size_t)pos * bins);
+    std::fill(accRe, accRe + bins, 0.0f);
+    std::fill(accIm, accIm + bins, 0.0f);
+    for (int p = 0; p < count; ++p) {
+        int slot = (pos - p + count) % count; // Input from p partitions ago meets IR partition p
+        multiplyAccumulate(fdlRe + (size_t)slot * bins, fdlIm + (size_t)slot * bins,
+                           irRe + (size_t)p * bins, irIm + (size_t)p * bins, accRe, accIm, bins);
+    }
+    fft.inverse(accRe, accIm, time);
+    std::memcpy(out, time + outCount, outCount * sizeof(float));
+}
+
+void ImpulseResponse::partition(const float* samples, int count, int partitionSize, Fft& fft, Partitions& out) {
+    out.count = (count + partitionSize - 1) / partitionSize;
+    out.bins = fft.getNumBins();
+    out.re.assign((size_t)out.count * out.bins, 0.0f);
+    out.im.assign((size_t)out.count * out.bins, 0.0f);
+    std::vector<float> block(2 * partitionSize);
+    for (int p = 0; p < out.count; ++p) {
+        std::fill(block.begin(), block.end(), 0.0f);
+        int n = std::min(partitionSize, count - p * partitionSize);
+        std::copy(samples + p * partitionSize, samples + p * partitionSize + n, block.begin());
+        fft.forward(block.data(), &out.re[(size_t)p * out.bins], &out.im[(size_t)p * out.bins]);
+    }
+}
+
+std::shared_ptr<const ImpulseResponse> ImpulseResponse::fromSamples(const std::vector<std::vector<float>>& samples) {
+    std::shared_ptr<ImpulseResponse> ir(new ImpulseResponse());
+    Fft headFft(2 * HEAD_SIZE), tailFft(2 * TAIL_SIZE);
+    int channelCount = std::min((int)samples.size(), 2);
+    ir->channels.resize(channelCount);
+    for (int c = 0; c < channelCount; ++c) {
+        const std::vector<float>& s = samples[c];
+        int length = (int)s.size();
+        ir->length = std::max(ir->length, length);
+        partition(s.data(), std::min(length, TAIL_OFFSET), HEAD_SIZE, headFft, ir->channels[c].head);
+        if (length > TAIL_OFFSET) {
+            partition(s.data() + TAIL_OFFSET, length - TAIL_OFFSET, TAIL_SIZE, tailFft, ir->channels[c].tail);
+        }
+    }
+    return ir;
+}
+
+std::shared_ptr<const ImpulseResponse> ImpulseResponse::load(const std::string& filename, double sampleRate) {
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::weak_ptr<const ImpulseResponse>> cache;
+
+    std::string key = filename + "@" + std::to_string((int)sampleRate);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (auto cached = cache[key].lock()) return cached;
+
+    if (sampleRate <= 0.0) {
+        std::cerr << "Impulse response " << filename << ": invalid engine sample rate" << std::endl;
+        return nullptr;
+    }
+    WavReader wav;
+    if (!wav.load(filename)) {
+        std::cerr << "Impulse response " << filename << ": " << wav.getError() << std::endl;
+        return nullptr;
+    }
+    if (wav.getSampleRate() <= 0) {
+        std::cerr << "Impulse response " << filename << " has no sample rate" << std::endl;
+        return nullptr;
+    }
+    if (wav.getNumFrames() == 0) {
+        std::cerr << "Impulse response " << filename << " is empty" << std::endl;
+        return nullptr;
+    }
+
+    // Linear resampling is plenty for a reverb tail
+    double ratio = wav.getSampleRate() / sampleRate;
+    int frames = (int)(wav.getNumFrames() / ratio);
+    std::vector<std::vector<float>> samples(std::min(wav.getNumChannels(), 2), std::vector<float>(frames));
+    for (size_t c = 0; c < samples.size(); ++c) {
+        const std::vector<float>& src = wav.getChannel((int)c);
+        for (int i = 0; i < frames; ++i) {
+            double pos = i * ratio;
+            size_t i0 = (size_t)pos;
+            size_t i1 = std::min(i0 + 1, src.size() - 1);
+            float frac = (float)(pos - i0);
+            samples[c][i] = src[i0] + (src[i1] - src[i0]) * frac;
+        }
+    }
+
+    auto ir = fromSamples(samples);
+    cache[key] = ir;
+    return ir;
+}
+
+ConvolutionReverb::ConvolutionReverb() {}
+
+ConvolutionReverb::~ConvolutionReverb() {
+    stopWorker();
+}
+
+bool ConvolutionReverb::hasTail() const {
+    return ir && ir->channels[0].tail.count > 0;
+}
+
+void ConvolutionReverb::setImpulseResponse(std::shared_ptr<const ImpulseResponse> newIr) {
+    stopWorker();
+    ir = newIr;
+    if (!ir) return;
+
+    const auto& irHead = ir->channels[0].head;
+    const auto& irTail = ir->channels[0].tail;
+    for (int c = 0; c < CHANNELS; ++c) {
+        HeadState& h = head[c];
+        h.input.assign(2 * P, 0.0f);
+        h.fdlRe.assign((size_t)irHead.count * irHead.bins, 0.0f);
+        h.fdlIm.assign((size_t)irHead.count * irHead.bins, 0.0f);
+        h.accRe.assign(irHead.bins, 0.0f);
+        h.accIm.assign(irHead.bins, 0.0f);
+        h.time.assign(2 * P, 0.0f);
+        h.output.assign(P, 0.0f);
+
+        TailState& t = tail[c];
+        t.staging.assign(T, 0.0f);
+        for (int r = 0; r < RING; ++r) {
+            t.input[r].assign(T, 0.0f);
+            t.output[r].assign(T, 0.0f);
+        }
+        t.window.assign(2 * T, 0.0f);
+        t.fdlRe.assign((size_t)irTail.count * irTail.bins, 0.0f);
+        t.fdlIm.assign((size_t)irTail.count * irTail.bins, 0.0f);
+        t.accRe.assign(irTail.bins, 0.0f);
+        t.accIm.assign(irTail.bins, 0.0f);
+        t.time.assign(2 * T, 0.0f);
+    }
+    clearState();
+    clearWorkerState(); // No worker running yet
+    clearedFrom = clearFrom.load(std::memory_order_relaxed);
+    if (hasTail()) startWorker();
+}
+
+void ConvolutionReverb::clearState() {
+    for (int c = 0; c < CHANNELS; ++c) {
+        HeadState& h = head[c];
+        for (auto* v : { &h.input, &h.fdlRe, &h.fdlIm, &h.output }) std::fill(v->begin(), v->end(), 0.0f);
+        std::fill(tail[c].staging.begin(), tail[c].staging.end(), 0.0f);
+    }
+    fifoPos = 0;
+    headFdlPos = 0;
+    tailChunkPos = 0;
+    partitionCount = 0;
+    tailSlot = -1;
+    tailOffset = 0;
+    // Chunk counters keep counting across resets, so the worker never sees them go backwards.
+    // Chunks still in flight finish on the old state; nothing plays their output.
+    chunkBase = submitted.load(std::memory_order_relaxed);
+    clearFrom.store(chunkBase, std::memory_order_release);
+}
+
+// Worker side (or with no worker running)
+void ConvolutionReverb::clearWorkerState() {
+    for (int c = 0; c < CHANNELS; ++c) {
+        TailState& t = tail[c];
+        for (auto* v : { &t.window, &t.fdlRe, &t.fdlIm }) std::fill(v->begin(), v->end(), 0.0f);
+    }
+    tailFdlPos = 0;
+}
+
+void ConvolutionReverb::reset() {
+    if (!ir) return;
+    clearState();
+}
+
+void ConvolutionReverb::process(DspBuffer& buffer) {
+    if (!ir) return;
+    int frames = buffer.getNumFrames();
+    int channels = std::min(buffer.getNumChannels(), (int)CHANNELS);
+
+    int done = 0;
+    while (done < frames) {
+        int n = std::min(P - fifoPos, frames - done);
+        for (int c = 0; c < channels; ++c) {
+            float* x = buffer.getChannel(c) + done;
+            float* fifo = head[c].input.data() + P + fifoPos; // Second half collects the current partition
+            const float* wetHead = head[c].output.data() + fifoPos;
+            const float* wetTail = tailSlot >= 0 ? tail[c].output[tailSlot].data() + tailOffset + fifoPos : nullptr;
+            for (int i = 0; i < n; ++i) {
+                fifo[i] = x[i];
+                float wet = wetHead[i] + (wetTail ? wetTail[i] : 0.0f);
+                x[i] = x[i] * dryGain + wet * wetGain;
+            }
+        }
+        fifoPos += n;
+        done += n;
+        if (fifoPos == P) {
+            endPartition(channels);
+            fifoPos = 0;
+        }
+    }
+}
+
+void ConvolutionReverb::endPartition(int channels) {
+    for (int c = 0; c < channels; ++c) {
+        // IR channel 0 serves both sides of a mono IR
+        const ImpulseResponse::Channel& irChannel = ir->channels[std::min(c, ir->getNumChannels() - 1)];
+        const auto& irHead = irChannel.head;
+        HeadState& h = head[c];
+        convolveWindow(headFft, h.input.data(), headFdlPos, irHead.count, irHead.bins, h.fdlRe.data(), h.fdlIm.data(),
+                       irHead.re.data(), irHead.im.data(), h.accRe.data(), h.accIm.data(), h.time.data(),
+                       h.output.data(), P);
+
+        std::memcpy(tail[c].staging.data() + tailChunkPos, h.input.data() + P, P * sizeof(float));
+        std::memcpy(h.input.data(), h.input.data() + P, P * sizeof(float)); // Slide the window
+    }
+    headFdlPos = (headFdlPos + 1) % ir->channels[0].head.count;
+
+    tailChunkPos += P;
+    if (tailChunkPos == T) {
+        if (hasTail()) submitTailChunk();
+        tailChunkPos = 0;
+    }
+
+    // The head output just computed covers convolution time [k * P, (k + 1) * P)
+    uint64_t start = partitionCount * P;
+    tailOffset = (int)(start % T);
+    if (tailOffset == 0 && hasTail()) acquireTailBlock(start / T);
+    partitionCount++;
+}
+
+void ConvolutionReverb::submitTailChunk() {
+    uint64_t chunk = submitted.load(std::memory_order_relaxed);
+    int slot = (int)(chunk % RING);
+    if (chunk - completed.load(std::memory_order_acquire) >= RING) {
+        // The worker is a whole ring behind and may still be reading this slot. Drop the
+        // chunk: it is counted and stays numbered, so later tail blocks keep their timing,
+        // and the worker convolves silence in its place.
+        missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        for (int c = 0; c < CHANNELS; ++c) {
+            std::memcpy(tail[c].input[slot].data(), tail[c].staging.data(), T * sizeof(float));
+        }
+        slotChunk[slot].store(chunk, std::memory_order_relaxed);
+    }
+    submitted.store(chunk + 1, std::memory_order_release);
+    wake.notify_one(); // No lock taken: the worker's timed wait covers a lost wakeup
+}
+
+void ConvolutionReverb::acquireTailBlock(uint64_t block) {
+    // Tail output for block m comes from input chunk m - 2 (the tail starts two blocks in)
+    if (block < 2) {
+        tailSlot = -1;
+        return;
+    }
+    uint64_t chunk = chunkBase + block - 2;
+    if (completed.load(std::memory_order_acquire) <= chunk) {
+        if (!waitForTail) {
+            missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+            tailSlot = -1;
+            return;
+        }
+        while (completed.load(std::memory_order_acquire) <= chunk) std::this_thread::yield();
+    }
+    tailSlot = (int)(chunk % RING);
+}
+
+void ConvolutionReverb::processTailChunk(uint64_t chunk) {
+    uint64_t from = clearFrom.load(std::memory_order_relaxed); // Published before `submitted`
+    if (chunk >= from && clearedFrom != from) {
+        clearWorkerState();
+        clearedFrom = from;
+    }
+    int slot = (int)(chunk % RING);
+    bool dropped = slotChunk[slot].load(std::memory_order_relaxed) != chunk;
+    const auto& irTail0 = ir->channels[0].tail;
+    for (int c = 0; c < CHANNELS; ++c) {
+        const auto& irTail = ir->channels[std::min(c, ir->getNumChannels() - 1)].tail;
+        TailState& t = tail[c];
+        std::memcpy(t.window.data(), t.window.data() + T, T * sizeof(float));
+        if (dropped) std::fill(t.window.begin() + T, t.window.end(), 0.0f);
+        else std::memcpy(t.window.data() + T, t.input[slot].data(), T * sizeof(float));
+        convolveWindow(tailFft, t.window.data(), tailFdlPos, irTail.count, irTail.bins, t.fdlRe.data(), t.fdlIm.data(),
+                       irTail.re.data(), irTail.im.data(), t.accRe.data(), t.accIm.data(), t.time.data(),
+                       t.output[slot].data(), T);
+    }
+    tailFdlPos = (tailFdlPos + 1) % irTail0.count;
+}
+
+void ConvolutionReverb::workerLoop() {
+    RX_TRACE_THREAD("reverb");
+    while (!quit.load(std::memory_order_acquire)) {
+        uint64_t next = completed.load(std::memory_order_relaxed);
+        if (submitted.load(std::memory_order_acquire) > next) {
+            RX_TRACE_SCOPE("ConvolutionReverb::tail");
+            processTailChunk(next);
+            completed.store(next + 1, std::memory_order_release);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+void ConvolutionReverb::startWorker() {
+    quit.store(false, std::memory_order_release);
+    worker = std::thread(&ConvolutionReverb::workerLoop, this);
+}
+
+void ConvolutionReverb::stopWorker() {
+    if (!worker.joinable()) return;
+    quit.store(true, std::memory_order_release);
+    wake.notify_one();
+    worker.join();
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "dsp/DspBuffer.hpp"
+#include "dsp/Fft.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Impulse response pre-transformed into partition spectra for ConvolutionReverb.
+//
+// The head (first TAIL_OFFSET samples) is cut into HEAD_SIZE partitions and the
+// rest into TAIL_SIZE partitions. Each partition is stored as the spectrum of
+// its zero-padded 2x-length block, so nothing is transformed at playback time.
+class ImpulseResponse {
+public:
+    static constexpr int HEAD_SIZE = 128;
+    static constexpr int TAIL_SIZE = 2048;
+    static constexpr int TAIL_OFFSET = 2 * TAIL_SIZE; // Leaves one tail block of slack for the background thread
+
+    // Spectral form of a WAV file at `sampleRate`, resampled if needed. Results are
+    // cached per file and rate, so engines loading the same IR share one copy.
+    // Returns nullptr (and prints why) if the file cannot be used.
+    static std::shared_ptr<const ImpulseResponse> load(const std::string& filename, double sampleRate);
+    // From planar samples already in memory (1 or 2 channels)
+    static std::shared_ptr<const ImpulseResponse> fromSamples(const std::vector<std::vector<float>>& samples);
+
+    int getNumChannels() const { return (int)channels.size(); }
+    int getLength() const { return length; }
+
+private:
+    friend class ConvolutionReverb;
+
+    // Partition spectra laid out [partition][bin], real and imaginary parts split
+    struct Partitions {
+        int count = 0;
+        int bins = 0;
+        std::vector<float> re, im;
+    };
+    struct Channel {
+        Partitions head, tail;
+    };
+
+    std::vector<Channel> channels;
+    int length = 0;
+
+    ImpulseResponse() = default;
+    static void partition(const float* samples, int count, int partitionSize, Fft& fft, Partitions& out);
+};
+
+// Two-stage partitioned FFT convolution for the master bus.
+//
+// Head partitions run in the audio callback via uniformly partitioned overlap-save,
+// which costs one small FFT pair per HEAD_SIZE samples no matter how long the IR is.
+// Tail partitions run on a background thread: each completed TAIL_SIZE input chunk is
+// handed over through a lock-free ring, and its output is due one tail block later.
+// A late tail block is either waited for (offline) or dropped and counted (live). If the
+// worker falls a whole ring behind, the chunks it has no room for are convolved as
+// silence and counted; the callback never waits for it.
+// The wet signal is delayed by HEAD_SIZE samples; the dry signal is not.
+class ConvolutionReverb {
+public:
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+
+    ConvolutionReverb(const ConvolutionReverb&) = delete;
+    ConvolutionReverb& operator=(const ConvolutionReverb&) = delete;
+
+    // Allocates and restarts the background thread; call from the control thread
+    void setImpulseResponse(std::shared_ptr<const ImpulseResponse> ir);
+    void setMix(float dry, float wet) { dryGain = dry; wetGain = wet; }
+    // Offline renders wait for late tail blocks so output is deterministic
+    void setWaitForTail(bool wait) { waitForTail = wait; }
+
+    void process(DspBuffer& buffer); // In place, one or two channels
+    void reset();                    // Clears all reverb state; the worker clears its own on its next chunk
+
+    int getLatency() const { return ImpulseResponse::HEAD_SIZE; }
+    uint64_t getMissedDeadlines() const { return missedDeadlines.load(std::memory_order_relaxed); } // Late or dropped tail blocks
+
+private:
+    static const int CHANNELS = 2;
+    static const int RING = 4; // Tail chunks in flight between the callback and the worker
+
+    struct HeadState {
+        std::vector<float> input;      // Previous and current partition (overlap-save window)
+        std::vector<float> fdlRe, fdlIm; // Spectra of recent input partitions, ring of head.count
+        std::vector<float> accRe, accIm;
+        std::vector<float> time;
+        std::vector<float> output;     // Wet head output for the partition being played
+    };
+    struct TailState {
+        std::vector<float> staging;    // Callback side: current chunk being collected
+        std::vector<float> input[RING];
+        std::vector<float> output[RING];
+        std::vector<float> window;     // Worker side: overlap-save window
+        std::vector<float> fdlRe, fdlIm;
+        std::vector<float> accRe, accIm;
+        std::vector<float> time;
+    };
+
+    std::shared_ptr<const ImpulseResponse> ir;
+    Fft headFft{ 2 * ImpulseResponse::HEAD_SIZE };
+    Fft tailFft{ 2 * ImpulseResponse::TAIL_SIZE };
+    HeadState head[CHANNELS];
+    TailState tail[CHANNELS];
+    float dryGain = 1.0f;
+    float wetGain = 0.3f;
+    bool waitForTail = false;
+
+    // Callback-side position
+    int fifoPos = 0;
+    int headFdlPos = 0;
+    int tailChunkPos = 0;
+    uint64_t partitionCount = 0;
+    int tailSlot = -1;  // Ring slot holding the tail output being played, -1 = silence
+    int tailOffset = 0; // Position of the current partition inside that tail block
+    uint64_t chunkBase = 0; // Value of `submitted` at the last reset
+
+    // Worker-side position
+    int tailFdlPos = 0;
+    uint64_t clearedFrom = 0; // Last clearFrom the worker acted on
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> quit{false};
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> missedDeadlines{0};
+    std::atomic<uint64_t> clearFrom{0};       // First chunk after the last reset
+    std::atomic<uint64_t> slotChunk[RING] = {}; // Chunk whose input each slot holds; others were dropped
+
+    bool hasTail() const;
+    void endPartition(int channels);
+    void submitTailChunk();
+    void acquireTailBlock(uint64_t block);
+    void processTailChunk(uint64_t chunk);
+    void workerLoop();
+    void startWorker();
+    void stopWorker();
+    void clearState();
+    void clearWorkerState();
+};
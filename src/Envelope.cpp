@@ -18,6 +18,9 @@ void Envelope::enterStage(EnvelopeStage newStage) {
     stage = newStage;
     if (stage == EnvelopeStage::Off) {
         currentLevel = 0.0f;
+    } else if (stage == EnvelopeStage::Release) {
+        // Release ramps from wherever we are, so the tail always lasts releaseTime
+        releaseStartLevel = currentLevel;
     }
 }
 
@@ -45,7 +48,7 @@ float Envelope::getNextLevel() {
             currentLevel = sustainLevel;
             break;
         case EnvelopeStage::Release: {
-            float decrement = sustainLevel / (releaseTime * sampleRate);
+            float decrement = releaseStartLevel / (releaseTime * sampleRate);
             currentLevel -= decrement;
             if (currentLevel <= 0.0f) {
                 currentLevel = 0.0f;
@@ -59,3 +62,15 @@ float Envelope::getNextLevel() {
     }
     return currentLevel;
 }
+
+void Envelope::render(float* levels, int frames) {
+    for (int i = 0; i < frames; ++i) levels[i] = getNextLevel();
+}
+
+void Envelope::advance(int frames) {
+    // Sustain and Off hold their level, so only the ramps need stepping
+    while (frames > 0 && stage != EnvelopeStage::Sustain && stage != EnvelopeStage::Off) {
+        getNextLevel();
+        --frames;
+    }
+}
@@ -17,7 +17,10 @@ public:
     
     void enterStage(EnvelopeStage newStage);
     float getNextLevel();
+    void render(float* levels, int frames); // The next `frames` levels
+    void advance(int frames); // Same state as `frames` calls to getNextLevel()
     EnvelopeStage getCurrentStage() const { return stage; }
+    float getLevel() const { return currentLevel; }
     bool isActive() const { return stage != EnvelopeStage::Off; }
 
 private:
@@ -30,4 +33,5 @@ private:
     float releaseTime = 0.5f;  // seconds
     
     float currentLevel = 0.0f;
+    float releaseStartLevel = 0.0f;
 };
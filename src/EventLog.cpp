@@ -0,0 +1,271 @@
+#include "EventLog.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static const char MAGIC[8] = { 'R', 'X', 'E', 'V', 'L', 'O', 'G', 0 };
+
+EventLog::EventLog(int ringRecords) {
+    uint64_t size = 1;
+    while (size < (uint64_t)std::max(ringRecords, 2)) size <<= 1;
+    slots.reset(new Slot[size]);
+    mask = size - 1;
+    chunk.reserve(size);
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+bool EventLog::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "cannot write " + path;
+        return false;
+    }
+    uint32_t header[2] = { VERSION, (uint32_t)sizeof(EventRecord) };
+    std::fwrite(MAGIC, 1, sizeof(MAGIC), file);
+    std::fwrite(header, sizeof(header), 1, file);
+    error.clear();
+    dropped.store(0, std::memory_order_relaxed);
+    stopping = false;
+    running.store(true, std::memory_order_release);
+    writer = std::thread(&EventLog::writerLoop, this);
+    return true;
+}
+
+void EventLog::close() {
+    if (!writer.joinable()) return;
+    running.store(false, std::memory_order_release); // Later writes are turned away
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+    drain(); // Anything published while the writer was stopping
+
+    EventRecord end = {};
+    end.kind = EventKind::End;
+    end.data = (uint32_t)std::min<uint64_t>(dropped.load(std::memory_order_relaxed), UINT32_MAX);
+    std::fwrite(&end, sizeof(end), 1, file);
+    if (std::fclose(file) != 0) error = "write failed";
+    file = nullptr;
+}
+
+bool EventLog::write(const EventRecord* records, int count) {
+    if (!running.load(std::memory_order_relaxed)) return false;
+    // Reserve the whole run so one call's records stay together
+    uint64_t w = writeIndex.load(std::memory_order_relaxed);
+    do {
+        if (w + count - readIndex.load(std::memory_order_acquire) > mask + 1) {
+            dropped.fetch_add(count, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!writeIndex.compare_exchange_weak(w, w + count, std::memory_order_acq_rel, std::memory_order_relaxed));
+    for (int i = 0; i < count; ++i) {
+        Slot& slot = slots[(w + i) & mask];
+        slot.record = records[i];
+        slot.sequence.store(w + i + 1, std::memory_order_release);
+    }
+    return true;
+}
+
+bool EventLog::call(uint64_t frame, EventCall call, const float* args, int count) {
+    EventRecord records[MAX_ARGS];
+    int n = std::max(1, std::min(count, MAX_ARGS));
+    for (int i = 0; i < n; ++i) {
+        records[i] = {};
+        records[i].frame = frame;
+        records[i].kind = EventKind::Call;
+        records[i].index = (uint8_t)call;
+        records[i].extra = (uint16_t)i;
+        records[i].value = i < count ? args[i] : 0.0f;
+    }
+    return write(records, n);
+}
+
+// Writes out every record published so far, in order; stops at one still being written
+void EventLog::drain() {
+    uint64_t r = readIndex.load(std::memory_order_relaxed);
+    chunk.clear();
+    for (;;) {
+        Slot& slot = slots[r & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != r + 1) break;
+        chunk.push_back(slot.record);
+        ++r;
+    }
+    readIndex.store(r, std::memory_order_release);
+    if (!chunk.empty() && std::fwrite(chunk.data(), sizeof(EventRecord), chunk.size(), file) != chunk.size()) {
+        error = "write failed";
+    }
+    std::fflush(file); // A crash loses at most one interval
+}
+
+void EventLog::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(WRITE_INTERVAL_MS));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+int EventLog::arity(EventCall call) {
+    switch (call) {
+        case EventCall::NoteOn: return 2;
+        case EventCall::Envelope: return 4;
+        case EventCall::Unison: return 3;
+        case EventCall::Modulation: return 1 + ModSettings::MAX_ROUTES * 3 + 2 + 2 + 4 + 1;
+        case EventCall::Vibrato: return 2;
+        case EventCall::SendEffect: return 6;
+        case EventCall::SendLevel: return 2;
+        case EventCall::FmPatch: return 2 + Fm::OPERATORS * 7;
+        case EventCall::AllNotesOff:
+        case EventCall::Reset:
+        case EventCall::SampleLibrary:
+        case EventCall::Reverb: return 0;
+        default: return 1;
+    }
+}
+
+static const char* callNames[(int)EventCall::COUNT] = {
+    "noteOn", "noteOff", "allNotesOff", "reset", "sampleRate", "cutoff", "resonance", "envelope", "waveform",
+    "filterType", "unison", "modulation", "modWheel", "pitchBend", "bendRange", "portamento", "vibrato", "volume",
+    "sendEffect", "sendLevel", "sampleLibrary", "reverb", "synthesisModel", "fmPatch"
+};
+
+const char* EventLog::callName(EventCall call) {
+    return (int)call < (int)EventCall::COUNT ? callNames[(int)call] : "?";
+}
+
+int EventLog::packModulation(const ModSettings& s, float* args) {
+    int n = 0;
+    args[n++] = (float)s.numRoutes;
+    for (int i = 0; i < ModSettings::MAX_ROUTES; ++i) {
+        args[n++] = (float)s.routes[i].source;
+        args[n++] = (float)s.routes[i].destination;
+        args[n++] = s.routes[i].amount;
+    }
+    for (int i = 0; i < 2; ++i) {
+        args[n++] = s.lfoRate[i];
+        args[n++] = (float)s.lfoShape[i];
+    }
+    args[n++] = s.env2Attack;
+    args[n++] = s.env2Decay;
+    args[n++] = s.env2Sustain;
+    args[n++] = s.env2Release;
+    args[n++] = (float)s.controlInterval;
+    return n;
+}
+
+ModSettings EventLog::unpackModulation(const float* args) {
+    ModSettings s;
+    int n = 0;
+    s.numRoutes = (int)args[n++];
+    for (int i = 0; i < ModSettings::MAX_ROUTES; ++i) {
+        s.routes[i].source = (ModSource)(int)args[n++];
+        s.routes[i].destination = (ModDestination)(int)args[n++];
+        s.routes[i].amount = args[n++];
+    }
+    for (int i = 0; i < 2; ++i) {
+        s.lfoRate[i] = args[n++];
+        s.lfoShape[i] = (LfoShape)(int)args[n++];
+    }
+    s.env2Attack = args[n++];
+    s.env2Decay = args[n++];
+    s.env2Sustain = args[n++];
+    s.env2Release = args[n++];
+    s.controlInterval = (int)args[n++];
+    return s;
+}
+
+int EventLog::packDelay(int bus, const DelaySettings& s, float* args) {
+    args[0] = (float)bus;
+    args[1] = s.delayMs;
+    args[2] = s.depthMs;
+    args[3] = s.rateHz;
+    args[4] = s.feedback;
+    args[5] = s.stereoPhase;
+    return 6;
+}
+
+DelaySettings EventLog::unpackDelay(const float* args) {
+    return { args[1], args[2], args[3], args[4], args[5] };
+}
+
+int EventLog::packFmPatch(const FmPatch& p, float* args) {
+    int n = 0;
+    args[n++] = (float)p.algorithm;
+    args[n++] = p.feedback;
+    for (const FmOperator& op : p.ops) {
+        args[n++] = op.ratio;
+        args[n++] = op.detune;
+        args[n++] = op.level;
+        args[n++] = op.attack;
+        args[n++] = op.decay;
+        args[n++] = op.sustain;
+        args[n++] = op.release;
+    }
+    return n;
+}
+
+FmPatch EventLog::unpackFmPatch(const float* args) {
+    FmPatch p;
+    int n = 0;
+    p.algorithm = (int)args[n++];
+    p.feedback = args[n++];
+    for (FmOperator& op : p.ops) {
+        op.ratio = args[n++];
+        op.detune = args[n++];
+        op.level = args[n++];
+        op.attack = args[n++];
+        op.decay = args[n++];
+        op.sustain = args[n++];
+        op.release = args[n++];
+    }
+    return p;
+}
+
+bool EventLogFile::load(const std::string& path) {
+    records.clear();
+    complete = false;
+    droppedRecords = 0;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    char magic[8];
+    uint32_t header[2];
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) ||
+        std::fread(header, sizeof(header), 1, file) != 1) {
+        error = path + ": not an event log";
+        std::fclose(file);
+        return false;
+    }
+    if (header[0] != EventLog::VERSION || header[1] != sizeof(EventRecord)) {
+        error = path + ": event log version " + std::to_string(header[0]) + " is not supported";
+        std::fclose(file);
+        return false;
+    }
+    EventRecord record;
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        if (record.kind == EventKind::End) {
+            droppedRecords = record.data;
+            complete = true;
+            break;
+        }
+        if (record.kind == EventKind::Begin) sampleRate = record.value;
+        if (record.kind == EventKind::Call && record.index == (uint8_t)EventCall::SampleRate) sampleRate = record.value;
+        records.push_back(record);
+    }
+    std::fclose(file);
+    if (records.empty() || records[0].kind != EventKind::Begin) {
+        error = path + ": the log does not start on a fresh engine";
+        return false;
+    }
+    return true;
+}
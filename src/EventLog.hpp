@@ -0,0 +1,126 @@
+#pragma once
+#include "FmVoiceBank.hpp"
+#include "ModMatrix.hpp"
+#include "dsp/ModulatedDelay.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class EventKind : uint8_t {
+    Begin,       // Logging started on a fresh engine; value: sample rate
+    Call,        // One argument of a SynthEngine call: index = EventCall, extra = argument number
+    Midi,        // data: status | data1 << 8 | data2 << 16
+    Render,      // data: frames, index: channels
+    Skip,        // data: frames
+    Callback,    // A host callback starts; data: frames it asked for
+    CallbackEnd, // data: nanoseconds the callback took
+    End          // Last record of a file; data: records dropped on overflow
+};
+
+// SynthEngine entry points, with their arguments logged as floats in order. Sample
+// libraries and reverb impulses are data, not arguments: their calls are only marked.
+enum class EventCall : uint8_t {
+    NoteOn, NoteOff, AllNotesOff, Reset, SampleRate, Cutoff, Resonance, Envelope, Waveform, FilterType,
+    Unison, Modulation, ModWheel, PitchBend, BendRange, Portamento, Vibrato, Volume, SendEffect, SendLevel,
+    SampleLibrary, Reverb, SynthesisModel, FmPatch, COUNT
+};
+
+struct EventRecord {
+    uint64_t frame; // Engine sample position: frames rendered or skipped before it
+    union {
+        uint32_t data;
+        float value;
+    };
+    EventKind kind;
+    uint8_t index;
+    uint16_t extra;
+};
+static_assert(sizeof(EventRecord) == 16, "records are written to disk as is");
+
+// Always-on flight recorder for one SynthEngine: every MIDI event, parameter change and
+// rendered block with its sample position, and each host callback's size and duration,
+// as 16-byte records in a compact binary file that rx-replay plays back.
+//
+// Any thread may write. A call's records are reserved together with one compare-and-swap
+// on a preallocated ring and published per slot, so writing is lock-free and never
+// allocates; if the ring is full the records are dropped and counted. A writer thread
+// drains the ring to disk every WRITE_INTERVAL_MS.
+class EventLog {
+public:
+    static constexpr int MAX_ARGS = 40;
+    static constexpr int WRITE_INTERVAL_MS = 50;
+    static const uint32_t VERSION = 1;
+
+    // ringRecords is rounded up to a power of two; the default holds minutes of normal use
+    explicit EventLog(int ringRecords = 1 << 16);
+    ~EventLog(); // Stops, writing out everything logged
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    bool open(const std::string& path); // Control thread; starts the writer
+    void close();
+    bool isOpen() const { return running.load(std::memory_order_relaxed); }
+    const std::string& getError() const { return error; }
+
+    // Any thread. False if the ring was full
+    bool write(const EventRecord* records, int count);
+    bool call(uint64_t frame, EventCall call, const float* args, int count);
+    uint64_t getDroppedRecords() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Number of float arguments a call is logged with (at least one record is written)
+    static int arity(EventCall call);
+    static const char* callName(EventCall call);
+    static int packModulation(const ModSettings& settings, float* args);
+    static ModSettings unpackModulation(const float* args);
+    static int packDelay(int bus, const DelaySettings& settings, float* args);
+    static DelaySettings unpackDelay(const float* args);
+    static int packFmPatch(const FmPatch& patch, float* args);
+    static FmPatch unpackFmPatch(const float* args);
+
+private:
+    struct Slot {
+        EventRecord record;
+        std::atomic<uint64_t> sequence{0}; // Index + 1 once the record is published
+    };
+    std::unique_ptr<Slot[]> slots;
+    uint64_t mask;
+    std::atomic<uint64_t> writeIndex{0};
+    std::atomic<uint64_t> readIndex{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> running{false};
+
+    FILE* file = nullptr;
+    std::string error;
+    std::vector<EventRecord> chunk;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void drain();
+    void writerLoop();
+};
+
+// A whole log read back for replay
+class EventLogFile {
+public:
+    bool load(const std::string& path);
+    const std::vector<EventRecord>& getRecords() const { return records; }
+    double getSampleRate() const { return sampleRate; }
+    uint64_t getDroppedRecords() const { return droppedRecords; }
+    bool isComplete() const { return complete; } // Ends with an End record; false if the host crashed
+    const std::string& getError() const { return error; }
+
+private:
+    std::vector<EventRecord> records;
+    double sampleRate = 44100.0;
+    uint64_t droppedRecords = 0;
+    bool complete = false;
+    std::string error;
+};
@@ -0,0 +1,160 @@
+#include "FmVoiceBank.hpp"
+#include "Trace.hpp"
+#include "dsp/FastMath.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void FmVoiceBank::setSampleRate(double sr) {
+    sampleRate = sr;
+    for (auto& voice : envelopes) {
+        for (Envelope& env : voice) env.setSampleRate(sr / CONTROL_INTERVAL); // Stepped once per control point
+    }
+    for (int v = 0; v < VOICES; ++v) updateIncrements(v);
+}
+
+void FmVoiceBank::setPatch(const FmPatch& p) {
+    patch = p;
+    patch.algorithm = std::max(0, std::min(p.algorithm, Fm::ALGORITHMS - 1));
+    lanes.feedback = patch.feedback;
+    for (auto& voice : envelopes) {
+        for (int op = 0; op < Fm::OPERATORS; ++op) {
+            const FmOperator& o = patch.ops[op];
+            voice[op].setParameters(o.attack, o.decay, o.sustain, o.release);
+        }
+    }
+    for (int v = 0; v < VOICES; ++v) updateIncrements(v);
+}
+
+void FmVoiceBank::setPitchBend(float semitones) {
+    bendRatio = FastMath::exp2(semitones * (1.0f / 12.0f));
+    for (int v = 0; v < VOICES; ++v) updateIncrements(v);
+}
+
+void FmVoiceBank::updateIncrements(int v) {
+    if (notes[v] < 0) return;
+    double frequency = FastMath::mtof((float)notes[v]) * bendRatio;
+    for (int op = 0; op < Fm::OPERATORS; ++op) {
+        double hz = frequency * patch.ops[op].ratio + patch.ops[op].detune;
+        double cycles = hz / sampleRate;
+        cycles -= std::floor(cycles); // Aliases like any frequency above Nyquist would
+        lanes.increment[op][v] = (uint32_t)(cycles * 4294967296.0);
+    }
+}
+
+void FmVoiceBank::noteOn(int note, int velocity) {
+    if (!isActive()) {
+        // The control grid and ramps restart with the bank, so output only depends on
+        // events since it last went silent
+        for (int op = 0; op < Fm::OPERATORS; ++op) {
+            target[op] = Fm::FloatLanes{};
+            lanes.gain[op] = Fm::FloatLanes{};
+            lanes.step[op] = Fm::FloatLanes{};
+        }
+        untilControl = 0;
+    }
+    int v = 0;
+    while (v < VOICES && sounding[v]) ++v;
+    if (v == VOICES) v = 0; // All busy: steal the first, as SynthEngine does
+    if (!sounding[v]) {
+        // Idle voices start from a known state
+        for (int op = 0; op < Fm::OPERATORS; ++op) {
+            lanes.phase[op][v] = 0;
+            envelopes[v][op].enterStage(EnvelopeStage::Off);
+        }
+        lanes.history[0][v] = 0.0f;
+        lanes.history[1][v] = 0.0f;
+    }
+    notes[v] = note;
+    velocities[v] = velocity / 127.0f;
+    sounding[v] = true;
+    updateIncrements(v);
+    for (Envelope& env : envelopes[v]) env.enterStage(EnvelopeStage::Attack); // Levels rise from the next control point
+}
+
+void FmVoiceBank::noteOff(int note) {
+    for (int v = 0; v < VOICES; ++v) {
+        if (!sounding[v] || notes[v] != note) continue;
+        for (Envelope& env : envelopes[v]) {
+            if (env.isActive()) env.enterStage(EnvelopeStage::Release);
+        }
+    }
+}
+
+void FmVoiceBank::allNotesOff() {
+    for (int v = 0; v < VOICES; ++v) {
+        if (sounding[v]) noteOff(notes[v]);
+    }
+}
+
+void FmVoiceBank::reset() {
+    lanes = {};
+    lanes.feedback = patch.feedback;
+    for (int op = 0; op < Fm::OPERATORS; ++op) target[op] = Fm::FloatLanes{};
+    for (int v = 0; v < VOICES; ++v) {
+        for (Envelope& env : envelopes[v]) env.enterStage(EnvelopeStage::Off);
+        notes[v] = -1;
+        sounding[v] = false;
+    }
+    untilControl = 0;
+}
+
+bool FmVoiceBank::isActive() const {
+    for (int v = 0; v < VOICES; ++v) {
+        if (sounding[v]) return true;
+    }
+    return false;
+}
+
+void FmVoiceBank::control() {
+    int carriers = Fm::CARRIERS[patch.algorithm];
+    for (int op = 0; op < Fm::OPERATORS; ++op) {
+        lanes.gain[op] = target[op]; // Land exactly, whatever the ramp rounded to
+        bool carrier = (carriers >> op) & 1;
+        for (int v = 0; v < VOICES; ++v) {
+            float level = envelopes[v][op].getNextLevel() * patch.ops[op].level;
+            target[op][v] = carrier ? level * velocities[v] : level;
+        }
+        lanes.step[op] = (target[op] - lanes.gain[op]) * (1.0f / CONTROL_INTERVAL);
+    }
+    // A voice is done once its carriers have finished and ramped to zero
+    for (int v = 0; v < VOICES; ++v) {
+        if (!sounding[v]) continue;
+        bool audible = false;
+        for (int op = 0; op < Fm::OPERATORS; ++op) {
+            if ((carriers >> op) & 1) {
+                audible = audible || envelopes[v][op].isActive() || lanes.gain[op][v] != 0.0f || target[op][v] != 0.0f;
+            }
+        }
+        sounding[v] = audible;
+    }
+    untilControl = CONTROL_INTERVAL;
+}
+
+void FmVoiceBank::render(DspBuffer& buffer) {
+    RX_TRACE_SCOPE("FmVoiceBank::render");
+    int frames = buffer.getNumFrames();
+    float* out = buffer.getChannel(0);
+    for (int done = 0; done < frames;) {
+        if (untilControl == 0) control();
+        int n = std::min(untilControl, frames - done);
+        Fm::render(patch.algorithm, lanes, out + done, n);
+        untilControl -= n;
+        done += n;
+    }
+    for (int c = 1; c < buffer.getNumChannels(); ++c) std::memcpy(buffer.getChannel(c), out, frames * sizeof(float));
+}
+
+// Phases and envelopes move on; feedback history is left as it was
+void FmVoiceBank::skip(int frames) {
+    for (int done = 0; done < frames;) {
+        if (untilControl == 0) control();
+        int n = std::min(untilControl, frames - done);
+        for (int op = 0; op < Fm::OPERATORS; ++op) {
+            lanes.phase[op] += lanes.increment[op] * (uint32_t)n;
+            lanes.gain[op] += lanes.step[op] * (float)n;
+        }
+        untilControl -= n;
+        done += n;
+    }
+}
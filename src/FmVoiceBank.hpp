@@ -0,0 +1,62 @@
+#pragma once
+#include "Envelope.hpp"
+#include "dsp/DspBuffer.hpp"
+#include "dsp/FmKernel.hpp"
+
+struct FmOperator {
+    float ratio = 1.0f;  // Of the note frequency
+    float detune = 0.0f; // Hz added on top
+    float level = 0.0f;  // Modulation index in radians, or amplitude for a carrier
+    float attack = 0.01f;
+    float decay = 0.2f;
+    float sustain = 0.7f;
+    float release = 0.3f;
+};
+
+struct FmPatch {
+    int algorithm = 0;     // 0..Fm::ALGORITHMS-1, see dsp/FmKernel.hpp
+    float feedback = 0.0f; // Operator 4 on itself, radians
+    FmOperator ops[Fm::OPERATORS]; // ops[0] is operator 1, the bottom of every stack
+};
+
+// Four-operator FM voices, the second synthesis model beside the subtractive Voice.
+// All voices render together: each operator is one vector step across every voice's lane
+// (dsp/FmKernel.hpp), on a shared sine table with fixed-point phases. Operator envelopes
+// run at control rate on a fixed grid of CONTROL_INTERVAL frames, independent of block
+// size and restarted when a note starts the bank from silence, and their levels are
+// ramped per sample in between.
+class FmVoiceBank {
+public:
+    static const int VOICES = Fm::LANES;
+    static const int CONTROL_INTERVAL = 16;
+
+    void setSampleRate(double sr);
+    void setPatch(const FmPatch& patch);
+    const FmPatch& getPatch() const { return patch; }
+    void setPitchBend(float semitones);
+
+    void noteOn(int note, int velocity);
+    void noteOff(int note);
+    void allNotesOff();
+    void reset();
+    bool isActive() const;
+
+    // Overwrites both channels with the voices' mono sum
+    void render(DspBuffer& buffer);
+    void skip(int frames);
+
+private:
+    FmPatch patch;
+    Fm::Lanes lanes = {};
+    Envelope envelopes[VOICES][Fm::OPERATORS];
+    Fm::FloatLanes target[Fm::OPERATORS] = {}; // Gains at the next control point
+    int notes[VOICES] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+    float velocities[VOICES] = {};
+    bool sounding[VOICES] = {}; // Until the carriers have ramped to silence
+    int untilControl = 0;       // Frames to the next control point
+    double sampleRate = 44100.0;
+    float bendRatio = 1.0f;
+
+    void updateIncrements(int voice);
+    void control(); // Steps the envelopes and sets the next ramps
+};
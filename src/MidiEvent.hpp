@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Compact channel-voice event shared by the MIDI input and the file reader.
+// `time` is a sample position: absolute for file playback, block-relative for live input.
+struct MidiEvent {
+    uint32_t time = 0;
+    uint8_t status = 0; // Status byte including the channel nibble
+    uint8_t data1 = 0;
+    uint8_t data2 = 0;
+    uint8_t reserved = 0;
+
+    uint8_t type() const { return status & 0xF0; }
+    uint8_t channel() const { return status & 0x0F; }
+};
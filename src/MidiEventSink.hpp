@@ -0,0 +1,9 @@
+#pragma once
+#include "MidiEvent.hpp"
+
+// Anything that can be driven by parsed MIDI (a single synth, the multitimbral host)
+class MidiEventSink {
+public:
+    virtual ~MidiEventSink() = default;
+    virtual void handleMidiEvent(const MidiEvent& event) = 0;
+};
@@ -0,0 +1,193 @@
+#include "MidiFile.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+static uint32_t readBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t readBE16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+bool MidiFile::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        error = "cannot open " + filename;
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return parseHeader();
+}
+
+bool MidiFile::loadFromMemory(const uint8_t* data, size_t size) {
+    bytes.assign(data, data + size);
+    return parseHeader();
+}
+
+bool MidiFile::parseHeader() {
+    tracks.clear();
+    error.clear();
+
+    if (bytes.size() < 14 || std::string(bytes.begin(), bytes.begin() + 4) != "MThd") {
+        error = "missing MThd header";
+        return false;
+    }
+
+    uint32_t headerLength = readBE32(&bytes[4]);
+    format = readBE16(&bytes[8]);
+    int declaredTracks = readBE16(&bytes[10]);
+    division = readBE16(&bytes[12]);
+
+    if (format > 1) {
+        error = "unsupported SMF format " + std::to_string(format);
+        return false;
+    }
+
+    // Walk chunks; unknown chunk types are skipped as the spec requires
+    size_t pos = 8 + (size_t)headerLength;
+    while (pos + 8 <= bytes.size() && (int)tracks.size() < declaredTracks) {
+        uint32_t length = readBE32(&bytes[pos + 4]);
+        size_t begin = pos + 8;
+        size_t end = std::min(begin + (size_t)length, bytes.size()); // Tolerate truncated files
+        if (std::string(bytes.begin() + pos, bytes.begin() + pos + 4) == "MTrk") {
+            tracks.push_back({ begin, end });
+        }
+        pos = begin + length;
+    }
+
+    if (tracks.empty()) {
+        error = "no MTrk chunks";
+        return false;
+    }
+    return true;
+}
+
+MidiFileReader::MidiFileReader(const MidiFile& file, double sampleRate)
+    : file(file), sampleRate(sampleRate) {
+    setTempo(500000); // 120 BPM until told otherwise
+
+    for (const auto& t : file.tracks) {
+        TrackCursor c = { t.begin, t.end, 0, 0, false };
+        advanceDelta(c);
+        cursors.push_back(c);
+    }
+}
+
+void MidiFileReader::setTempo(uint32_t microsecondsPerQuarter) {
+    int division = file.division;
+    if (division & 0x8000) {
+        // SMPTE timing: ticks are a fixed fraction of a second, tempo is ignored
+        int fps = -(int8_t)(division >> 8);
+        int ticksPerFrame = division & 0xFF;
+        samplesPerTick = sampleRate / (double)(fps * std::max(ticksPerFrame, 1));
+    } else {
+        samplesPerTick = sampleRate * (microsecondsPerQuarter / 1000000.0) / std::max(division, 1);
+    }
+}
+
+double MidiFileReader::tickToSample(uint64_t tick) const {
+    return tempoSample + (double)(tick - tempoTick) * samplesPerTick;
+}
+
+bool MidiFileReader::readVarLen(TrackCursor& c, uint32_t& value) const {
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (c.pos >= c.end) return false;
+        uint8_t b = file.bytes[c.pos++];
+        value = (value << 7) | (b & 0x7F);
+        if (!(b & 0x80)) return true;
+    }
+    return false; // More than 4 bytes is malformed
+}
+
+void MidiFileReader::advanceDelta(TrackCursor& c) {
+    uint32_t delta;
+    if (!readVarLen(c, delta)) {
+        c.done = true;
+        return;
+    }
+    c.tick += delta;
+}
+
+bool MidiFileReader::next(MidiEvent& event) {
+    const uint8_t* data = file.bytes.data();
+
+    for (;;) {
+        // Pick the track with the earliest pending event; ties go to the lower
+        // track index so the conductor track's tempo changes apply first.
+        TrackCursor* c = nullptr;
+        for (auto& cursor : cursors) {
+            if (!cursor.done && (!c || cursor.tick < c->tick)) c = &cursor;
+        }
+        if (!c) return false;
+
+        if (c->tick != tempoTick) {
+            tempoSample = tickToSample(c->tick);
+            tempoTick = c->tick;
+        }
+        lastSample = tempoSample;
+
+        if (c->pos >= c->end) {
+            c->done = true;
+            continue;
+        }
+
+        uint8_t status = data[c->pos];
+        if (status & 0x80) {
+            c->pos++;
+        } else if (c->runningStatus) {
+            status = c->runningStatus; // Running status: reuse the previous status byte
+        } else {
+            c->done = true; // Data byte with no status to run from
+            continue;
+        }
+
+        if (status == 0xFF) {
+            // Meta event
+            if (c->pos >= c->end) { c->done = true; continue; }
+            uint8_t type = data[c->pos++];
+            uint32_t length;
+            if (!readVarLen(*c, length) || c->pos + length > c->end) { c->done = true; continue; }
+            if (type == 0x51 && length == 3) {
+                setTempo(((uint32_t)data[c->pos] << 16) | ((uint32_t)data[c->pos + 1] << 8) | data[c->pos + 2]);
+            }
+            c->pos += length;
+            c->runningStatus = 0;
+            if (type == 0x2F) {
+                c->done = true;
+                continue;
+            }
+            advanceDelta(*c);
+            continue;
+        }
+
+        if (status == 0xF0 || status == 0xF7) {
+            // Sysex or escape: length-prefixed, not forwarded to the synth
+            uint32_t length;
+            if (!readVarLen(*c, length) || c->pos + length > c->end) { c->done = true; continue; }
+            c->pos += length;
+            c->runningStatus = 0;
+            advanceDelta(*c);
+            continue;
+        }
+
+        if (status >= 0xF0) {
+            c->done = true; // System messages other than sysex are not valid in a track
+            continue;
+        }
+
+        int dataBytes = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 1 : 2;
+        if (c->pos + dataBytes > c->end) { c->done = true; continue; }
+
+        event.time = (uint32_t)(tempoSample + 0.5);
+        event.status = status;
+        event.data1 = data[c->pos] & 0x7F;
+        event.data2 = dataBytes == 2 ? (data[c->pos + 1] & 0x7F) : 0;
+        c->pos += dataBytes;
+        c->runningStatus = status;
+        advanceDelta(*c);
+        return true;
+    }
+}
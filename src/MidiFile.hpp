@@ -0,0 +1,69 @@
+#pragma once
+#include "MidiEvent.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Standard MIDI File (format 0 and 1) container.
+// Only chunk boundaries are indexed on load; events are decoded lazily by MidiFileReader.
+class MidiFile {
+public:
+    bool load(const std::string& filename);
+    bool loadFromMemory(const uint8_t* data, size_t size);
+
+    int getFormat() const { return format; }
+    int getNumTracks() const { return (int)tracks.size(); }
+    int getDivision() const { return division; }
+    const std::string& getError() const { return error; }
+
+private:
+    friend class MidiFileReader;
+
+    struct TrackChunk { size_t begin; size_t end; };
+
+    std::vector<uint8_t> bytes;
+    std::vector<TrackChunk> tracks;
+    int format = 0;
+    int division = 480;
+    std::string error;
+
+    bool parseHeader();
+};
+
+// Streams channel events from all tracks merged in time order.
+// Tempo meta events are applied as they are reached, so tick -> sample conversion
+// follows the file's tempo map without building it up front.
+class MidiFileReader {
+public:
+    MidiFileReader(const MidiFile& file, double sampleRate);
+
+    // Returns false once every track has reached its end.
+    bool next(MidiEvent& event);
+
+    // Sample position of the last event read (including meta events)
+    uint32_t getEndSample() const { return (uint32_t)(lastSample + 0.5); }
+
+private:
+    struct TrackCursor {
+        size_t pos;
+        size_t end;
+        uint64_t tick;
+        uint8_t runningStatus;
+        bool done;
+    };
+
+    const MidiFile& file;
+    double sampleRate;
+    std::vector<TrackCursor> cursors;
+
+    // Tempo map state: sample position of the last tempo change and the current rate
+    uint64_t tempoTick = 0;
+    double tempoSample = 0.0;
+    double samplesPerTick = 0.0;
+    double lastSample = 0.0;
+
+    void setTempo(uint32_t microsecondsPerQuarter);
+    double tickToSample(uint64_t tick) const;
+    bool readVarLen(TrackCursor& c, uint32_t& value) const;
+    void advanceDelta(TrackCursor& c);
+};
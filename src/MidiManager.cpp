@@ -1,7 +1,8 @@
 #include "MidiManager.hpp"
+#include "Trace.hpp"
 #include <iostream>
 
-MidiManager::MidiManager(SynthEngine& synth) : synth(synth) {
+MidiManager::MidiManager(MidiEventSink& sink) : sink(sink) {
 }
 
 MidiManager::~MidiManager() {
@@ -30,28 +31,26 @@ bool MidiManager::initialize() {
 
 void MidiManager::MidiCallback(const MIDIPacketList *pktlist, void *readProcRefCon, void *srcRefCon) {
     MidiManager* manager = static_cast<MidiManager*>(readProcRefCon);
-    MIDIPacket *packet = const_cast<MIDIPacket*>(&pktlist->packet[0]);
+    const MIDIPacket *packet = &pktlist->packet[0];
     
     for (UInt32 i = 0; i < pktlist->numPackets; ++i) {
-        manager->handleMidiMessage(packet->data, packet->length);
+        manager->handleMidiBytes(packet->data, packet->length);
         packet = MIDIPacketNext(packet);
     }
 }
 
-void MidiManager::handleMidiMessage(const uint8_t* data, size_t length) {
-    if (length < 3) return;
-    
-    uint8_t status = data[0] & 0xF0;
-    uint8_t note = data[1];
-    uint8_t velocity = data[2];
-    
-    if (status == 0x90) { // Note On
-        if (velocity > 0) {
-            synth.noteOn(note, velocity);
-        } else {
-            synth.noteOff(note); // Velocity 0 is often Note Off
+// All MIDI 1.0 parsing lives in MidiParser; this just drains batches into the sink.
+// Events are applied immediately, so the packet timestamp is not used.
+void MidiManager::handleMidiBytes(const uint8_t* data, size_t length) {
+    RX_TRACE_THREAD("midi");
+    RX_TRACE_SCOPE("MidiManager::drain");
+    while (length > 0) {
+        size_t consumed = parser.parse(data, length, 0, batch);
+        for (int i = 0; i < batch.count; ++i) {
+            sink.handleMidiEvent(batch.events[i]);
         }
-    } else if (status == 0x80) { // Note Off
-        synth.noteOff(note);
+        batch.clear();
+        data += consumed;
+        length -= consumed;
     }
 }
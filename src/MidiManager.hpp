@@ -1,10 +1,11 @@
 #pragma once
 #include <CoreMIDI/CoreMIDI.h>
-#include "SynthEngine.hpp"
+#include "MidiEventSink.hpp"
+#include "MidiParser.hpp"
 
 class MidiManager {
 public:
-    MidiManager(SynthEngine& synth);
+    MidiManager(MidiEventSink& sink); // A SynthEngine, or a MultiTimbralEngine to route by channel
     ~MidiManager();
     
     bool initialize();
@@ -12,8 +13,10 @@ public:
 private:
     MIDIClientRef midiClient;
     MIDIPortRef inputPort;
-    SynthEngine& synth;
+    MidiEventSink& sink;
+    MidiParser parser;
+    MidiEventBatch batch;
     
     static void MidiCallback(const MIDIPacketList *pktlist, void *readProcRefCon, void *srcRefCon);
-    void handleMidiMessage(const uint8_t* data, size_t length);
+    void handleMidiBytes(const uint8_t* data, size_t length);
 };
@@ -0,0 +1,62 @@
+#include "MidiParser.hpp"
+
+void MidiParser::reset() {
+    runningStatus = 0;
+    expected = 0;
+    received = 0;
+    skipBytes = 0;
+    inSysex = false;
+}
+
+size_t MidiParser::parse(const uint8_t* data, size_t length, uint32_t time, MidiEventBatch& batch) {
+    size_t i = 0;
+    while (i < length && !batch.full()) {
+        uint8_t b = data[i++];
+
+        if (b < 0x80) {
+            // Data byte
+            if (inSysex) continue;
+            if (skipBytes) { skipBytes--; continue; }
+            if (!runningStatus) { droppedBytes++; continue; }
+
+            if (received == 0 && expected == 2) {
+                data1 = b;
+                received = 1;
+                continue;
+            }
+
+            MidiEvent& e = batch.events[batch.count++];
+            e.time = time;
+            e.status = runningStatus;
+            e.data1 = expected == 2 ? data1 : b;
+            e.data2 = expected == 2 ? b : 0;
+            e.reserved = 0;
+            received = 0; // Running status: the next data byte starts a new message
+            continue;
+        }
+
+        if (b >= 0xF8) continue; // Real-time: may appear anywhere, leaves all state alone
+
+        if (b < 0xF0) {
+            // Channel voice status
+            runningStatus = b;
+            uint8_t type = b & 0xF0;
+            expected = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+            received = 0;
+            skipBytes = 0;
+            inSysex = false;
+            continue;
+        }
+
+        // System exclusive / common: cancels running status
+        runningStatus = 0;
+        received = 0;
+        inSysex = (b == 0xF0);
+        switch (b) {
+            case 0xF1: case 0xF3: skipBytes = 1; break; // MTC quarter frame, song select
+            case 0xF2: skipBytes = 2; break;            // Song position
+            default: skipBytes = 0; break;              // F4-F7: no data
+        }
+    }
+    return i;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "MidiEvent.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-capacity event batch filled by MidiParser. Lives wherever the caller puts it;
+// nothing here allocates.
+struct MidiEventBatch {
+    static const int CAPACITY = 256;
+    MidiEvent events[CAPACITY];
+    int count = 0;
+
+    bool full() const { return count == CAPACITY; }
+    void clear() { count = 0; }
+};
+
+// Incremental MIDI 1.0 byte-stream parser.
+// Handles running status, messages split across or packed into calls, 1- and 2-byte
+// channel messages, real-time bytes interleaved anywhere, and skips sysex and system
+// common messages. Only channel voice messages are emitted.
+class MidiParser {
+public:
+    // Parses until the input is consumed or the batch is full.
+    // Returns the number of bytes consumed; call again with the rest after draining the batch.
+    size_t parse(const uint8_t* data, size_t length, uint32_t time, MidiEventBatch& batch);
+
+    void reset();
+
+    uint64_t getDroppedBytes() const { return droppedBytes; } // Data bytes with no status to apply to
+
+private:
+    uint8_t runningStatus = 0;
+    uint8_t expected = 0;     // Data bytes needed by the running status
+    uint8_t received = 0;
+    uint8_t data1 = 0;
+    uint8_t skipBytes = 0;    // Remaining data bytes of a system common message
+    bool inSysex = false;
+    uint64_t droppedBytes = 0;
+};
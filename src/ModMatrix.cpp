@@ -0,0 +1,91 @@
+#include "ModMatrix.hpp"
+#include "dsp/FastMath.hpp"
+#include <algorithm>
+#include <cmath>
+
+void Lfo::advance(int frames) {
+    phase += rate * frames / sampleRate;
+    phase -= std::floor(phase);
+}
+
+float Lfo::getValue() const {
+    float t = (float)phase;
+    switch (shape) {
+        case LfoShape::Sine: return FastMath::sin2pi(t);
+        case LfoShape::Triangle: return t < 0.5f ? 4.0f * t - 1.0f : 3.0f - 4.0f * t;
+        case LfoShape::Saw: return 2.0f * t - 1.0f;
+        case LfoShape::Square: return t < 0.5f ? 1.0f : -1.0f;
+    }
+    return 0.0f;
+}
+
+void ModMatrix::setSampleRate(double sr) {
+    for (auto& lfo : lfos) lfo.setSampleRate(sr);
+    env2.setSampleRate(sr);
+}
+
+void ModMatrix::setSettings(const ModSettings& s) {
+    settings = s;
+    settings.numRoutes = std::max(0, std::min(settings.numRoutes, ModSettings::MAX_ROUTES));
+    settings.controlInterval = std::max(1, std::min(settings.controlInterval, ModSettings::MAX_CONTROL_INTERVAL));
+    for (int i = 0; i < 2; ++i) {
+        lfos[i].setRate(settings.lfoRate[i]);
+        lfos[i].setShape(settings.lfoShape[i]);
+    }
+    env2.setParameters(settings.env2Attack, settings.env2Decay, settings.env2Sustain, settings.env2Release);
+}
+
+void ModMatrix::reset() {
+    for (auto& lfo : lfos) lfo.reset();
+    env2.enterStage(EnvelopeStage::Off);
+}
+
+void ModMatrix::noteOn(int noteNumber, float vel, bool retrigger) {
+    // LFOs and env2 restart only when the voice was idle, so renders stay reproducible
+    // without resetting the phase under a sounding note. env2 can still be releasing
+    // after the amp envelope has finished; its attack would start from that level.
+    if (retrigger) {
+        for (auto& lfo : lfos) lfo.reset();
+        env2.enterStage(EnvelopeStage::Off);
+    }
+    velocity = vel;
+    keyTrack = (noteNumber - 60) / 12.0f;
+    env2.enterStage(EnvelopeStage::Attack);
+}
+
+void ModMatrix::noteOff() {
+    env2.enterStage(EnvelopeStage::Release);
+}
+
+void ModMatrix::advance(int frames) {
+    for (auto& lfo : lfos) lfo.advance(frames);
+    env2.advance(frames);
+}
+
+float ModMatrix::getSourceValue(ModSource source) const {
+    switch (source) {
+        case ModSource::Lfo1: return lfos[0].getValue();
+        case ModSource::Lfo2: return lfos[1].getValue();
+        case ModSource::Envelope2: return env2.getLevel();
+        case ModSource::Velocity: return velocity;
+        case ModSource::KeyTrack: return keyTrack;
+        case ModSource::ModWheel: return modWheel;
+    }
+    return 0.0f;
+}
+
+ModTargets ModMatrix::evaluate() const {
+    ModTargets targets;
+    for (int i = 0; i < settings.numRoutes; ++i) {
+        const ModRoute& route = settings.routes[i];
+        float value = getSourceValue(route.source) * route.amount;
+        switch (route.destination) {
+            case ModDestination::Cutoff: targets.cutoffOctaves += value; break;
+            case ModDestination::Resonance: targets.resonance += value; break;
+            case ModDestination::Pitch: targets.pitchSemitones += value; break;
+            case ModDestination::Amp: targets.amp += value; break;
+        }
+    }
+    targets.amp = std::max(targets.amp, 0.0f);
+    return targets;
+}
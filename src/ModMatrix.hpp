@@ -0,0 +1,89 @@
+#pragma once
+#include "Envelope.hpp"
+
+enum class ModSource { Lfo1, Lfo2, Envelope2, Velocity, KeyTrack, ModWheel };
+enum class ModDestination { Cutoff, Resonance, Pitch, Amp };
+enum class LfoShape { Sine, Triangle, Saw, Square };
+
+// amount units per destination: Cutoff in octaves, Resonance added to the base
+// value, Pitch in semitones, Amp as a gain offset (1 + sum, never below 0)
+struct ModRoute {
+    ModSource source;
+    ModDestination destination;
+    float amount;
+};
+
+// Patch-level modulation settings, shared by every voice of an engine
+struct ModSettings {
+    static constexpr int MAX_ROUTES = 8;
+    static constexpr int MAX_CONTROL_INTERVAL = 64;
+
+    ModRoute routes[MAX_ROUTES] = {};
+    int numRoutes = 0;
+
+    float lfoRate[2] = { 5.0f, 0.5f }; // Hz
+    LfoShape lfoShape[2] = { LfoShape::Sine, LfoShape::Triangle };
+    float env2Attack = 0.01f, env2Decay = 0.3f, env2Sustain = 0.0f, env2Release = 0.3f;
+    int controlInterval = 16; // Samples between control-rate evaluations
+
+    bool addRoute(ModSource source, ModDestination destination, float amount) {
+        if (numRoutes >= MAX_ROUTES) return false;
+        routes[numRoutes++] = { source, destination, amount };
+        return true;
+    }
+};
+
+// Summed modulation per destination, in the units of ModRoute::amount
+struct ModTargets {
+    float cutoffOctaves = 0.0f;
+    float resonance = 0.0f;
+    float pitchSemitones = 0.0f;
+    float amp = 1.0f;
+};
+
+// Low-frequency oscillator, evaluated at control rate only
+class Lfo {
+public:
+    void setSampleRate(double sr) { sampleRate = sr; }
+    void setRate(float hz) { rate = hz; }
+    void setShape(LfoShape s) { shape = s; }
+    void reset() { phase = 0.0; }
+    void advance(int frames);
+    float getValue() const; // -1..1
+
+private:
+    double sampleRate = 44100.0;
+    double phase = 0.0; // Turns
+    float rate = 1.0f;
+    LfoShape shape = LfoShape::Sine;
+};
+
+// Per-voice modulation sources and routing.
+// The voice advances the matrix by one control interval at a time and asks for
+// targets at each control point; everything in here runs at control rate.
+class ModMatrix {
+public:
+    void setSampleRate(double sr);
+    void setSettings(const ModSettings& s);
+    const ModSettings& getSettings() const { return settings; }
+    bool hasRoutes() const { return settings.numRoutes > 0; }
+    int getControlInterval() const { return settings.controlInterval; }
+
+    void reset();
+    void noteOn(int noteNumber, float velocity, bool retrigger);
+    void noteOff();
+    void setModWheel(float value) { modWheel = value; }
+
+    void advance(int frames);
+    ModTargets evaluate() const;
+
+private:
+    ModSettings settings;
+    Lfo lfos[2];
+    Envelope env2;
+    float velocity = 0.0f;
+    float keyTrack = 0.0f; // Octaves from middle C
+    float modWheel = 0.0f;
+
+    float getSourceValue(ModSource source) const;
+};
@@ -0,0 +1,88 @@
+#include "MultiTimbralEngine.hpp"
+#include "Trace.hpp"
+
+MultiTimbralEngine::MultiTimbralEngine(int numThreads) {
+    if (numThreads != 1) pool.reset(new WorkerPool(numThreads));
+
+    Preset preset = PresetManager::getFactoryPreset(0);
+    for (int p = 0; p < MAX_PARTS; ++p) setPartPreset(p, preset);
+}
+
+void MultiTimbralEngine::setSampleRate(double sr) {
+    for (auto& part : parts) part.synth.setSampleRate(sr);
+}
+
+void MultiTimbralEngine::reset() {
+    for (auto& part : parts) {
+        part.synth.reset();
+        part.bus.clear();
+        part.busDirty = false;
+    }
+}
+
+void MultiTimbralEngine::handleMidiEvent(const MidiEvent& event) {
+    Part& part = parts[event.channel()];
+    if (!part.enabled) return;
+
+    if (event.type() == 0xC0) {
+        // Program change selects a factory preset for the part
+        int count = PresetManager::getFactoryPresetCount();
+        PresetManager::applyPreset(PresetManager::getFactoryPreset(event.data1 % count), part.synth);
+        return;
+    }
+    if (event.type() == 0xB0 && event.data1 == 7) {
+        part.synth.setMasterVolume(0.2f * event.data2 / 127.0f); // Channel volume, full scale = engine default
+        return;
+    }
+    part.synth.handleMidiEvent(event);
+}
+
+void MultiTimbralEngine::render(DspBuffer& outputBuffer) {
+    int frames = outputBuffer.getNumFrames();
+
+    activeCount = 0;
+    for (int p = 0; p < MAX_PARTS; ++p) {
+        Part& part = parts[p];
+        if (part.enabled && !part.synth.isSilent()) {
+            activeParts[activeCount++] = p;
+        } else if (part.busDirty) {
+            part.bus.clear();
+            part.busDirty = false;
+        }
+    }
+
+    auto renderPart = [this, frames](int i) {
+        RX_TRACE_SCOPE_ARG("MultiTimbralEngine::part", activeParts[i]);
+        Part& part = parts[activeParts[i]];
+        part.bus.resize(2, frames);
+        part.synth.render(part.bus);
+        part.busDirty = true;
+    };
+    if (pool) {
+        pool->parallelFor(activeCount, renderPart);
+    } else {
+        for (int i = 0; i < activeCount; ++i) renderPart(i);
+    }
+
+    // Fixed summation order keeps the mix bit-identical however the parts were scheduled
+    outputBuffer.clear();
+    for (int i = 0; i < activeCount; ++i) {
+        outputBuffer.add(parts[activeParts[i]].bus);
+    }
+}
+
+void MultiTimbralEngine::setPartPreset(int part, const Preset& preset) {
+    if (part < 0 || part >= MAX_PARTS) return;
+    PresetManager::applyPreset(preset, parts[part].synth);
+}
+
+void MultiTimbralEngine::setPartVolume(int part, float volume) {
+    if (part < 0 || part >= MAX_PARTS) return;
+    parts[part].synth.setMasterVolume(volume);
+}
+
+void MultiTimbralEngine::setPartEnabled(int part, bool enabled) {
+    if (part < 0 || part >= MAX_PARTS) return;
+    parts[part].enabled = enabled;
+    if (!enabled) parts[part].synth.allNotesOff();
+}
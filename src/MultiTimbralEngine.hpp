@@ -0,0 +1,45 @@
+#pragma once
+#include "SynthEngine.hpp"
+#include "PresetManager.hpp"
+#include "MidiEventSink.hpp"
+#include "WorkerPool.hpp"
+#include "dsp/DspBuffer.hpp"
+#include <memory>
+
+// Sixteen independent SynthEngine parts, one per MIDI channel.
+// Each part has its own preset, voice pool and output bus. Sounding parts render
+// in parallel on a fixed WorkerPool and are mixed in part order, so the result
+// does not depend on thread scheduling.
+class MultiTimbralEngine : public MidiEventSink {
+public:
+    static const int MAX_PARTS = 16;
+
+    explicit MultiTimbralEngine(int numThreads = 0); // 0 = all cores, 1 = render on the caller only
+
+    void setSampleRate(double sr);
+    void reset();
+
+    void handleMidiEvent(const MidiEvent& event) override;
+    void render(DspBuffer& outputBuffer);
+
+    void setPartPreset(int part, const Preset& preset);
+    void setPartVolume(int part, float volume);
+    void setPartEnabled(int part, bool enabled);
+
+    SynthEngine& getPart(int part) { return parts[part].synth; }
+    DspBuffer& getPartBus(int part) { return parts[part].bus; }
+    int getActivePartCount() const { return activeCount; }
+
+private:
+    struct Part {
+        SynthEngine synth;
+        DspBuffer bus{2, 512};
+        bool enabled = true;
+        bool busDirty = false; // Bus holds audio from the last block it rendered
+    };
+
+    Part parts[MAX_PARTS];
+    int activeParts[MAX_PARTS];
+    int activeCount = 0;
+    std::unique_ptr<WorkerPool> pool;
+};
@@ -0,0 +1,256 @@
+#include "OfflineRenderer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+OfflineRenderer::OfflineRenderer(double sampleRate, int blockSize)
+    : sampleRate(sampleRate), blockSize(blockSize), buffer(2, blockSize) {
+    preset = PresetManager::getFactoryPreset(0);
+}
+
+RenderStats OfflineRenderer::renderFile(const std::string& midiPath, const std::string& wavPath) {
+    RenderStats stats;
+    MidiFile midi;
+    if (!midi.load(midiPath)) {
+        stats.error = midiPath + ": " + midi.getError();
+        return stats;
+    }
+
+    WavWriter writer;
+    if (!writer.open(wavPath, 2, (int)sampleRate, format)) {
+        stats.error = "cannot write " + wavPath;
+        return stats;
+    }
+    return render(midi, writer);
+}
+
+void OfflineRenderer::setMultitimbral(bool enabled, int numThreads) {
+    multi.reset(enabled ? new MultiTimbralEngine(numThreads) : nullptr);
+}
+
+void OfflineRenderer::setReverb(const std::string& irPath, float wet) {
+    reverbPath = irPath;
+    reverbWet = wet;
+    synth.setReverb(nullptr); // Loaded on the next render
+}
+
+void OfflineRenderer::setSamples(const std::string& mapPath) {
+    samplesPath = mapPath;
+    synth.setSampleLibrary(nullptr); // Loaded on the next render
+}
+
+void OfflineRenderer::renderFrames(WavWriter& writer, int frames) {
+    while (frames > 0) {
+        int n = std::min(frames, blockSize);
+        buffer.resize(2, n);
+        if (multi) multi->render(buffer);
+        else if (!automation.isEmpty()) automation.render(synth, buffer, framesWritten);
+        else synth.render(buffer);
+        float* channels[2] = { buffer.getChannel(0), buffer.getChannel(1) };
+        writer.write(channels, n);
+        frames -= n;
+        framesWritten += n;
+    }
+}
+
+RenderStats OfflineRenderer::render(const MidiFile& midi, WavWriter& writer) {
+    RenderStats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    // Nothing carries over between renders
+    synth.reset();
+    synth.setSampleRate(sampleRate);
+    PresetManager::applyPreset(preset, synth);
+    synth.setPitchBend(0.0f); // Controllers survive reset()
+    synth.setModWheel(0.0f);
+    if (multi) {
+        multi->reset();
+        multi->setSampleRate(sampleRate);
+        for (int p = 0; p < MultiTimbralEngine::MAX_PARTS; ++p) multi->setPartPreset(p, preset);
+    }
+    MidiEventSink& sink = multi ? (MidiEventSink&)*multi : (MidiEventSink&)synth;
+    automation.seek(0);
+    framesWritten = 0;
+
+    double tail = tailSeconds;
+    if (!reverbPath.empty() && !multi) {
+        // IRs are cached, so batch workers loading the same file share its spectra
+        auto ir = ImpulseResponse::load(reverbPath, sampleRate);
+        if (!ir) {
+            writer.close();
+            stats.error = "cannot load impulse response " + reverbPath;
+            return stats;
+        }
+        if (!synth.getReverb()) {
+            synth.setReverb(ir, reverbWet);
+            synth.getReverb()->setWaitForTail(true); // Offline: late tail blocks are waited for, never dropped
+        }
+        tail += ir->getLength() / sampleRate;
+    }
+
+    if (!samplesPath.empty() && !multi && !synth.getSampleStreamer()) {
+        // Libraries are cached, so batch workers share the mappings and resident heads
+        auto library = SampleLibrary::load(samplesPath);
+        if (!library) {
+            writer.close();
+            stats.error = "cannot load sample map " + samplesPath;
+            return stats;
+        }
+        synth.setSampleLibrary(library);
+        synth.getSampleStreamer()->setWaitForData(true); // Offline: never drop frames
+    }
+
+    MidiFileReader reader(midi, sampleRate);
+    uint64_t position = 0;
+    MidiEvent event;
+    while (reader.next(event)) {
+        if (event.time > position) {
+            renderFrames(writer, (int)(event.time - position));
+            position = event.time;
+        }
+        sink.handleMidiEvent(event);
+    }
+
+    uint64_t end = std::max<uint64_t>(position, reader.getEndSample()) + (uint64_t)(tail * sampleRate);
+    renderFrames(writer, (int)(end - position));
+    writer.close();
+
+    stats.ok = true;
+    stats.frames = end;
+    stats.audioSeconds = end / sampleRate;
+    stats.wallSeconds = secondsSince(start);
+    return stats;
+}
+
+// Repeats one logged SynthEngine call
+static void replayCall(SynthEngine& synth, EventCall call, const float* a) {
+    switch (call) {
+        case EventCall::NoteOn: synth.noteOn((int)a[0], (int)a[1]); break;
+        case EventCall::NoteOff: synth.noteOff((int)a[0]); break;
+        case EventCall::AllNotesOff: synth.allNotesOff(); break;
+        case EventCall::Reset: synth.reset(); break;
+        case EventCall::SampleRate: synth.setSampleRate(a[0]); break;
+        case EventCall::Cutoff: synth.setFilterCutoff(a[0]); break;
+        case EventCall::Resonance: synth.setFilterResonance(a[0]); break;
+        case EventCall::Envelope: synth.setEnvelopeParams(a[0], a[1], a[2], a[3]); break;
+        case EventCall::Waveform: synth.setWaveform((int)a[0]); break;
+        case EventCall::FilterType: synth.setFilterType((int)a[0]); break;
+        case EventCall::Unison: synth.setUnison((int)a[0], a[1], a[2]); break;
+        case EventCall::Modulation: synth.setModulation(EventLog::unpackModulation(a)); break;
+        case EventCall::ModWheel: synth.setModWheel(a[0]); break;
+        case EventCall::PitchBend: synth.setPitchBend(a[0]); break;
+        case EventCall::BendRange: synth.setPitchBendRange(a[0]); break;
+        case EventCall::Portamento: synth.setPortamento(a[0]); break;
+        case EventCall::Vibrato: synth.setVibrato(a[0], a[1]); break;
+        case EventCall::Volume: synth.setMasterVolume(a[0]); break;
+        case EventCall::SendEffect: synth.setSendEffect((int)a[0], EventLog::unpackDelay(a)); break;
+        case EventCall::SendLevel: synth.setSendLevel((int)a[0], a[1]); break;
+        case EventCall::SynthesisModel: synth.setSynthesisModel((int)a[0]); break;
+        case EventCall::FmPatch: synth.setFmPatch(EventLog::unpackFmPatch(a)); break;
+        default: break; // Sample libraries and reverb impulses are not in the log
+    }
+}
+
+RenderStats OfflineRenderer::replay(const EventLogFile& log, WavWriter& writer, std::vector<CallbackTiming>* timings) {
+    RenderStats stats;
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<SynthEngine> engine(new SynthEngine()); // As new as the one the log began on
+    DspBuffer block(2, SynthEngine::MAX_BLOCK);
+    float args[EventLog::MAX_ARGS] = {};
+    bool inCallback = false;
+    if (timings) timings->clear();
+
+    for (const EventRecord& r : log.getRecords()) {
+        switch (r.kind) {
+            case EventKind::Call: {
+                EventCall call = (EventCall)r.index;
+                if (r.extra < EventLog::MAX_ARGS) args[r.extra] = r.value;
+                if (r.extra + 1 >= std::max(1, EventLog::arity(call))) replayCall(*engine, call, args);
+                break;
+            }
+            case EventKind::Midi: {
+                MidiEvent event;
+                event.status = r.data & 0xFF;
+                event.data1 = (r.data >> 8) & 0xFF;
+                event.data2 = (r.data >> 16) & 0xFF;
+                engine->handleMidiEvent(event);
+                break;
+            }
+            case EventKind::Render: {
+                int frames = (int)r.data;
+                block.resize(std::max(1, (int)r.index), frames);
+                auto renderStart = std::chrono::steady_clock::now();
+                engine->render(block);
+                if (timings && inCallback) timings->back().replayedUs += secondsSince(renderStart) * 1e6;
+                float* channels[2] = { block.getChannel(0), block.getChannel(block.getNumChannels() > 1 ? 1 : 0) };
+                writer.write(channels, frames);
+                stats.frames += frames;
+                break;
+            }
+            case EventKind::Skip: engine->skip((int)r.data); break;
+            case EventKind::Callback:
+                if (timings) {
+                    CallbackTiming timing;
+                    timing.frame = r.frame;
+                    timing.frames = (int)r.data;
+                    timings->push_back(timing);
+                }
+                inCallback = true;
+                break;
+            case EventKind::CallbackEnd:
+                if (timings && inCallback) timings->back().loggedUs = r.data * 1e-3;
+                inCallback = false;
+                break;
+            default: break;
+        }
+    }
+    writer.close();
+
+    stats.ok = true;
+    stats.audioSeconds = stats.frames / log.getSampleRate();
+    stats.wallSeconds = secondsSince(start);
+    return stats;
+}
+
+BatchRenderer::BatchRenderer(double sampleRate, int numThreads)
+    : sampleRate(sampleRate), numThreads(numThreads) {
+    if (this->numThreads <= 0) this->numThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    preset = PresetManager::getFactoryPreset(0);
+}
+
+BatchStats BatchRenderer::run(const std::vector<RenderJob>& jobs, std::vector<RenderStats>* results) {
+    BatchStats batch;
+    batch.files = (int)jobs.size();
+    std::vector<RenderStats> stats(jobs.size());
+    std::atomic<size_t> nextJob{0};
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        OfflineRenderer renderer(sampleRate);
+        renderer.setPreset(preset);
+        renderer.setFormat(format);
+        if (!reverbPath.empty()) renderer.setReverb(reverbPath, reverbWet);
+        if (!samplesPath.empty()) renderer.setSamples(samplesPath);
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            stats[i] = renderer.renderFile(jobs[i].midiPath, jobs[i].wavPath);
+        }
+    };
+
+    int count = std::min<int>(numThreads, (int)jobs.size());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < count; ++t) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+
+    batch.wallSeconds = secondsSince(start);
+    for (const auto& s : stats) {
+        if (!s.ok) batch.failed++;
+        batch.audioSeconds += s.audioSeconds;
+    }
+    if (results) *results = std::move(stats);
+    return batch;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "SynthEngine.hpp"
+#include "MultiTimbralEngine.hpp"
+#include "PresetManager.hpp"
+#include "Automation.hpp"
+#include "EventLog.hpp"
+#include "MidiFile.hpp"
+#include "WavFile.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+struct RenderStats {
+    bool ok = false;
+    uint64_t frames = 0;
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+    std::string error;
+};
+
+// One host callback from an event log: as the host timed it and as replayed
+struct CallbackTiming {
+    uint64_t frame = 0; // Engine position at its start
+    int frames = 0;
+    double loggedUs = 0.0;
+    double replayedUs = 0.0; // Rendering its blocks again
+};
+
+// Renders MIDI files through a private SynthEngine.
+// Events are applied at their exact sample position by splitting blocks around them.
+class OfflineRenderer {
+public:
+    OfflineRenderer(double sampleRate = 44100.0, int blockSize = 512);
+
+    void setPreset(const Preset& p) { preset = p; }
+    void setTailSeconds(double seconds) { tailSeconds = seconds; }
+    void setFormat(WavFormat f) { format = f; }
+    // Route channels to a 16-part MultiTimbralEngine instead of one SynthEngine
+    void setMultitimbral(bool enabled, int numThreads = 0);
+    // Convolution reverb from a WAV impulse response (single-engine renders); empty path removes it
+    void setReverb(const std::string& irPath, float wet = 0.3f);
+    // Sample playback from a sample map (single-engine renders); empty path goes back to the oscillators
+    void setSamples(const std::string& mapPath);
+    // Parameter automation played back from the start of each render (single-engine renders)
+    void setAutomation(const Automation& a) { automation = a; }
+    // Per-stage counters (single-engine renders); open the profiler on the thread that calls render
+    void setProfiler(PerfProfiler* profiler) { synth.setProfiler(profiler); }
+
+    RenderStats renderFile(const std::string& midiPath, const std::string& wavPath);
+    RenderStats render(const MidiFile& midi, WavWriter& writer);
+    // Plays an EventLog back through a fresh engine, block for block as logged. Calls made
+    // between blocks (the audio thread's own, or a host's) replay sample for sample. A call
+    // another thread made while a block was rendering is logged after that block and
+    // replays before the next one, so around it the output matches to block granularity.
+    // The log sets the sample rate and every parameter; this renderer's settings are not used.
+    RenderStats replay(const EventLogFile& log, WavWriter& writer, std::vector<CallbackTiming>* timings = nullptr);
+
+private:
+    double sampleRate;
+    int blockSize;
+    double tailSeconds = 2.0;
+    WavFormat format = WavFormat::Float32;
+    Preset preset;
+    std::string reverbPath;
+    float reverbWet = 0.3f;
+    std::string samplesPath;
+    SynthEngine synth;
+    std::unique_ptr<MultiTimbralEngine> multi;
+    DspBuffer buffer;
+    Automation automation;
+    uint64_t framesWritten = 0; // In this render; the automation timeline
+
+    void renderFrames(WavWriter& writer, int frames);
+};
+
+struct RenderJob {
+    std::string midiPath;
+    std::string wavPath;
+};
+
+struct BatchStats {
+    int files = 0;
+    int failed = 0;
+    double audioSeconds = 0.0;
+    double wallSeconds = 0.0;
+
+    // Rendered audio seconds per wall-clock second across all workers
+    double throughput() const { return wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0; }
+};
+
+// Spreads jobs over worker threads, one OfflineRenderer (and engine) per worker.
+class BatchRenderer {
+public:
+    BatchRenderer(double sampleRate = 44100.0, int numThreads = 0); // 0 = all cores
+
+    void setPreset(const Preset& p) { preset = p; }
+    void setFormat(WavFormat f) { format = f; }
+    void setReverb(const std::string& irPath, float wet = 0.3f) { reverbPath = irPath; reverbWet = wet; }
+    void setSamples(const std::string& mapPath) { samplesPath = mapPath; }
+
+    BatchStats run(const std::vector<RenderJob>& jobs, std::vector<RenderStats>* results = nullptr);
+
+private:
+    double sampleRate;
+    int numThreads;
+    WavFormat format = WavFormat::Float32;
+    Preset preset;
+    std::string reverbPath;
+    float reverbWet = 0.3f;
+    std::string samplesPath;
+};
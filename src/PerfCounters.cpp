@@ -0,0 +1,171 @@
+#include "PerfCounters.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+void PerfProfiler::Totals::add(const Totals& other) {
+    calls += other.calls;
+    nanoseconds += other.nanoseconds;
+    for (int c = 0; c < COUNTER_COUNT; ++c) value[c] += other.value[c];
+}
+
+PerfProfiler::~PerfProfiler() {
+    for (int fd : fds) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+bool PerfProfiler::open() {
+    if (numOpen > 0) return true;
+#if defined(__linux__)
+    static const uint64_t configs[COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int leader = -1;
+    int firstError = 0;
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[c];
+        attr.disabled = leader < 0 ? 1 : 0; // The group starts when the leader is enabled
+        attr.exclude_kernel = 1;            // Allowed at perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        // This thread, any CPU
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd < 0) {
+            if (!firstError) firstError = errno;
+            continue; // Some PMUs (and most VMs) lack individual events
+        }
+        if (leader < 0) leader = fd;
+        fds[c] = fd;
+        slot[c] = numOpen++;
+    }
+    if (leader >= 0) ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    if (numOpen == COUNTER_COUNT) status = "hardware counters";
+    else if (numOpen > 0) status = "some hardware counters unavailable (" + std::string(std::strerror(firstError)) + ")";
+    else status = "hardware counters unavailable (" + std::string(std::strerror(firstError)) + "), CPU time only";
+#else
+    status = "hardware counters need Linux, CPU time only";
+#endif
+    return numOpen > 0;
+}
+
+void PerfProfiler::snapshot(uint64_t& nanoseconds, uint64_t* values) const {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    nanoseconds = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+    if (numOpen == 0) return;
+
+    // Group layout: { nr, value[nr] } in the order the events were opened
+    uint64_t group[1 + COUNTER_COUNT];
+    int leader = -1;
+    for (int c = 0; c < COUNTER_COUNT && leader < 0; ++c) leader = fds[c];
+    if (::read(leader, group, sizeof(group)) < (ssize_t)(sizeof(uint64_t) * (1 + numOpen))) return;
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        if (slot[c] >= 0) values[c] = group[1 + slot[c]];
+    }
+}
+
+void PerfProfiler::begin() {
+    snapshot(lastNanoseconds, lastValue);
+}
+
+void PerfProfiler::end(PerfStage stage) {
+    uint64_t nanoseconds = lastNanoseconds;
+    uint64_t values[COUNTER_COUNT];
+    std::memcpy(values, lastValue, sizeof(values));
+    snapshot(nanoseconds, values);
+
+    Totals& t = totals[(int)stage][voiceCount];
+    t.calls++;
+    t.nanoseconds += nanoseconds - lastNanoseconds;
+    for (int c = 0; c < COUNTER_COUNT; ++c) t.value[c] += values[c] - lastValue[c];
+
+    lastNanoseconds = nanoseconds;
+    std::memcpy(lastValue, values, sizeof(values));
+}
+
+PerfProfiler::Totals PerfProfiler::total(PerfStage stage) const {
+    Totals sum;
+    for (int v = 0; v <= MAX_VOICE_COUNT; ++v) sum.add(totals[(int)stage][v]);
+    return sum;
+}
+
+void PerfProfiler::clear() {
+    for (auto& stage : totals) {
+        for (auto& t : stage) t = Totals();
+    }
+}
+
+const char* PerfProfiler::stageName(PerfStage stage) {
+    static const char* names[STAGE_COUNT] = { "oscillator", "filter", "envelope", "mix", "output" };
+    return names[(int)stage];
+}
+
+const char* PerfProfiler::counterName(Counter c) {
+    static const char* names[COUNTER_COUNT] = { "cycles", "instructions", "cache-misses", "branch-misses" };
+    return names[c];
+}
+
+// Per call, or "-" for a counter that could not be opened
+static void formatPerCall(char* text, size_t size, const PerfProfiler& p, PerfProfiler::Counter c, const PerfProfiler::Totals& t) {
+    if (!p.isAvailable(c) || t.calls == 0) std::snprintf(text, size, "-");
+    else std::snprintf(text, size, "%.1f", (double)t.value[c] / t.calls);
+}
+
+void PerfProfiler::print(std::ostream& out) const {
+    char line[160];
+    out << "stage profile: " << status << "\n";
+    std::snprintf(line, sizeof(line), "%-11s %9s %10s %10s %12s %6s %10s %10s\n", "stage", "calls", "ms", "cycles",
+                  "instructions", "IPC", "cache-miss", "branch-miss");
+    out << line;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        Totals t = total((PerfStage)s);
+        if (t.calls == 0) continue;
+        char cells[COUNTER_COUNT][24];
+        for (int c = 0; c < COUNTER_COUNT; ++c) formatPerCall(cells[c], sizeof(cells[c]), *this, (Counter)c, t);
+        char ipcText[16] = "-";
+        if (isAvailable(Cycles) && isAvailable(Instructions)) std::snprintf(ipcText, sizeof(ipcText), "%.2f", t.ipc());
+        std::snprintf(line, sizeof(line), "%-11s %9llu %10.3f %10s %12s %6s %10s %10s\n", stageName((PerfStage)s),
+                      (unsigned long long)t.calls, t.nanoseconds * 1e-6, cells[Cycles], cells[Instructions], ipcText,
+                      cells[CacheMisses], cells[BranchMisses]);
+        out << line;
+    }
+
+    // Voice counts are sampled per block, so the voice stages show how per-voice cost
+    // changes with polyphony (cache pressure) and mix/output show the per-block cost
+    bool counters = isAvailable(Cycles);
+    out << "per call by sounding voices (" << (counters ? "cycles" : "ns") << ")\n";
+    std::snprintf(line, sizeof(line), "%-7s", "voices");
+    out << line;
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        std::snprintf(line, sizeof(line), " %11s", stageName((PerfStage)s));
+        out << line;
+    }
+    out << "\n";
+    for (int v = 0; v <= MAX_VOICE_COUNT; ++v) {
+        bool any = false;
+        for (int s = 0; s < STAGE_COUNT; ++s) any |= totals[s][v].calls > 0;
+        if (!any) continue;
+        std::snprintf(line, sizeof(line), "%-7d", v);
+        out << line;
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            const Totals& t = totals[s][v];
+            if (t.calls == 0) std::snprintf(line, sizeof(line), " %11s", "-");
+            else std::snprintf(line, sizeof(line), " %11.0f", (double)(counters ? t.value[Cycles] : t.nanoseconds) / t.calls);
+            out << line;
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+enum class PerfStage { Oscillator, Filter, Envelope, Mix, Output };
+
+// Per-stage hardware counters for tuning the render kernels (instrumentation, not for shipping builds).
+//
+// On Linux, open() starts a perf_event_open group (cycles, instructions, cache misses,
+// branch misses) on the calling thread, which must be the one that renders. Each stage
+// is bracketed by begin()/end() and the deltas are summed per stage and per number of
+// sounding voices. Counters the kernel refuses (containers, VMs, perf_event_paranoid,
+// other platforms) read as unavailable; thread CPU time is always measured.
+// Every read is a syscall, so expect roughly a microsecond of overhead per stage.
+class PerfProfiler {
+public:
+    static const int STAGE_COUNT = 5;
+    static const int MAX_VOICE_COUNT = 16;
+    enum Counter { Cycles, Instructions, CacheMisses, BranchMisses, COUNTER_COUNT };
+
+    struct Totals {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0; // Thread CPU time
+        uint64_t value[COUNTER_COUNT] = {};
+
+        void add(const Totals& other);
+        double ipc() const { return value[Cycles] ? (double)value[Instructions] / value[Cycles] : 0.0; }
+    };
+
+    PerfProfiler() = default;
+    ~PerfProfiler();
+    PerfProfiler(const PerfProfiler&) = delete;
+    PerfProfiler& operator=(const PerfProfiler&) = delete;
+
+    // False if no hardware counter could be opened; the profiler still records time
+    bool open();
+    bool isAvailable(Counter c) const { return slot[c] >= 0; }
+    bool hasCounters() const { return numOpen > 0; }
+    const std::string& getStatus() const { return status; }
+
+    // Stages ended from here on are filed under this many sounding voices
+    void setVoiceCount(int voices) { voiceCount = voices < 0 ? 0 : (voices > MAX_VOICE_COUNT ? MAX_VOICE_COUNT : voices); }
+    void begin();
+    void end(PerfStage stage); // Also begins the next stage, so back-to-back stages need one read each
+
+    const Totals& get(PerfStage stage, int voices) const { return totals[(int)stage][voices]; }
+    Totals total(PerfStage stage) const; // Over all voice counts
+    void clear();
+
+    static const char* stageName(PerfStage stage);
+    static const char* counterName(Counter c);
+    // Table per stage, then cost per call by voice count
+    void print(std::ostream& out) const;
+
+private:
+    int fds[COUNTER_COUNT] = { -1, -1, -1, -1 };
+    int slot[COUNTER_COUNT] = { -1, -1, -1, -1 }; // Position in the group read, -1 if unavailable
+    int numOpen = 0;
+    std::string status = "not opened";
+    int voiceCount = 0;
+
+    uint64_t lastNanoseconds = 0;
+    uint64_t lastValue[COUNTER_COUNT] = {};
+    Totals totals[STAGE_COUNT][MAX_VOICE_COUNT + 1];
+
+    void snapshot(uint64_t& nanoseconds, uint64_t* values) const;
+};
+
+// Brackets one stage; does nothing without a profiler
+class PerfScope {
+public:
+    PerfScope(PerfProfiler* p, PerfStage s) : profiler(p), stage(s) { if (profiler) profiler->begin(); }
+    ~PerfScope() { if (profiler) profiler->end(stage); }
+
+private:
+    PerfProfiler* profiler;
+    PerfStage stage;
+};
@@ -1,4 +1,6 @@
 #include "PresetManager.hpp"
+#include "Trace.hpp"
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 
@@ -14,6 +16,38 @@ void PresetManager::savePreset(const std::string& filename, const Preset& preset
         file << "sustain=" << preset.sustain << "\n";
         file << "release=" << preset.release << "\n";
         file << "waveform=" << preset.waveform << "\n";
+        file << "unisonVoices=" << preset.unisonVoices << "\n";
+        file << "unisonDetune=" << preset.unisonDetune << "\n";
+        file << "unisonSpread=" << preset.unisonSpread << "\n";
+        const ModSettings& mod = preset.modulation;
+        for (int i = 0; i < 2; ++i) {
+            file << "lfo" << i + 1 << "Rate=" << mod.lfoRate[i] << "\n";
+            file << "lfo" << i + 1 << "Shape=" << (int)mod.lfoShape[i] << "\n";
+        }
+        file << "env2=" << mod.env2Attack << "," << mod.env2Decay << "," << mod.env2Sustain << "," << mod.env2Release << "\n";
+        file << "controlInterval=" << mod.controlInterval << "\n";
+        for (int i = 0; i < mod.numRoutes; ++i) {
+            // source,destination,amount
+            file << "modRoute=" << (int)mod.routes[i].source << "," << (int)mod.routes[i].destination << ","
+                 << mod.routes[i].amount << "\n";
+        }
+        for (int i = 0; i < Voice::MAX_SENDS; ++i) {
+            // level,delayMs,depthMs,rateHz,feedback,stereoPhase
+            const DelaySettings& fx = preset.sendEffect[i];
+            file << "send" << i + 1 << "=" << preset.sendLevel[i] << "," << fx.delayMs << "," << fx.depthMs << ","
+                 << fx.rateHz << "," << fx.feedback << "," << fx.stereoPhase << "\n";
+        }
+        file << "glide=" << preset.glideTime << "\n";
+        file << "bendRange=" << preset.bendRange << "\n";
+        file << "vibrato=" << preset.vibratoRate << "," << preset.vibratoDepth << "\n"; // rateHz,depthSemitones
+        file << "model=" << preset.synthesisModel << "\n";
+        file << "fm=" << preset.fm.algorithm << "," << preset.fm.feedback << "\n"; // algorithm,feedback
+        for (int i = 0; i < Fm::OPERATORS; ++i) {
+            // ratio,detuneHz,level,attack,decay,sustain,release
+            const FmOperator& op = preset.fm.ops[i];
+            file << "fmOp" << i + 1 << "=" << op.ratio << "," << op.detune << "," << op.level << "," << op.attack << ","
+                 << op.decay << "," << op.sustain << "," << op.release << "\n";
+        }
         file.close();
         std::cout << "Saved preset to " << filename << std::endl;
     }
@@ -24,6 +58,8 @@ bool PresetManager::loadPreset(const std::string& filename, Preset& outPreset) {
     if (!file.is_open()) return false;
     
     std::string line;
+    ModSettings& mod = outPreset.modulation;
+    mod.numRoutes = 0; // Routes are listed in full by the file
     while (std::getline(file, line)) {
         size_t delimiterPos = line.find('=');
         if (delimiterPos == std::string::npos) continue;
@@ -39,15 +75,134 @@ bool PresetManager::loadPreset(const std::string& filename, Preset& outPreset) {
         else if (key == "sustain") outPreset.sustain = std::stof(value);
         else if (key == "release") outPreset.release = std::stof(value);
         else if (key == "waveform") outPreset.waveform = std::stoi(value);
+        else if (key == "unisonVoices") outPreset.unisonVoices = std::stoi(value);
+        else if (key == "unisonDetune") outPreset.unisonDetune = std::stof(value);
+        else if (key == "unisonSpread") outPreset.unisonSpread = std::stof(value);
+        else if (key == "lfo1Rate") mod.lfoRate[0] = std::stof(value);
+        else if (key == "lfo2Rate") mod.lfoRate[1] = std::stof(value);
+        else if (key == "lfo1Shape") mod.lfoShape[0] = (LfoShape)(std::stoi(value) & 3);
+        else if (key == "lfo2Shape") mod.lfoShape[1] = (LfoShape)(std::stoi(value) & 3);
+        else if (key == "env2") {
+            std::sscanf(value.c_str(), "%f,%f,%f,%f", &mod.env2Attack, &mod.env2Decay, &mod.env2Sustain, &mod.env2Release);
+        }
+        else if (key == "controlInterval") mod.controlInterval = std::stoi(value);
+        else if (key == "modRoute") {
+            int source, destination;
+            float amount;
+            if (std::sscanf(value.c_str(), "%d,%d,%f", &source, &destination, &amount) == 3 &&
+                source >= 0 && source <= (int)ModSource::ModWheel &&
+                destination >= 0 && destination <= (int)ModDestination::Amp) {
+                mod.addRoute((ModSource)source, (ModDestination)destination, amount);
+            }
+        }
+        else if (key == "send1" || key == "send2") {
+            int bus = key[4] - '1';
+            DelaySettings& fx = outPreset.sendEffect[bus];
+            std::sscanf(value.c_str(), "%f,%f,%f,%f,%f,%f", &outPreset.sendLevel[bus], &fx.delayMs, &fx.depthMs,
+                        &fx.rateHz, &fx.feedback, &fx.stereoPhase);
+        }
+        else if (key == "glide") outPreset.glideTime = std::stof(value);
+        else if (key == "bendRange") outPreset.bendRange = std::stof(value);
+        else if (key == "vibrato") std::sscanf(value.c_str(), "%f,%f", &outPreset.vibratoRate, &outPreset.vibratoDepth);
+        else if (key == "model") outPreset.synthesisModel = std::stoi(value);
+        else if (key == "fm") std::sscanf(value.c_str(), "%d,%f", &outPreset.fm.algorithm, &outPreset.fm.feedback);
+        else if (key.size() == 5 && key.compare(0, 4, "fmOp") == 0 && key[4] >= '1' && key[4] <= '0' + Fm::OPERATORS) {
+            FmOperator& op = outPreset.fm.ops[key[4] - '1'];
+            std::sscanf(value.c_str(), "%f,%f,%f,%f,%f,%f,%f", &op.ratio, &op.detune, &op.level, &op.attack, &op.decay,
+                        &op.sustain, &op.release);
+        }
     }
     return true;
 }
 
-static const int PRESET_COUNT = 3;
+void PresetManager::applyPreset(const Preset& preset, SynthEngine& synth) {
+    RX_TRACE_SCOPE("PresetManager::applyPreset");
+    synth.setFilterCutoff(preset.cutoff);
+    synth.setFilterResonance(preset.resonance);
+    synth.setEnvelopeParams(preset.attack, preset.decay, preset.sustain, preset.release);
+    synth.setWaveform(preset.waveform);
+    synth.setUnison(preset.unisonVoices, preset.unisonDetune, preset.unisonSpread);
+    synth.setModulation(preset.modulation);
+    synth.setPortamento(preset.glideTime);
+    synth.setPitchBendRange(preset.bendRange);
+    synth.setVibrato(preset.vibratoRate, preset.vibratoDepth);
+    synth.setFmPatch(preset.fm);
+    synth.setSynthesisModel(preset.synthesisModel);
+    for (int i = 0; i < Voice::MAX_SENDS; ++i) {
+        // Unused buses keep their rings unallocated
+        if (preset.sendLevel[i] > 0.0f) synth.setSendEffect(i, preset.sendEffect[i]);
+        synth.setSendLevel(i, preset.sendLevel[i]);
+    }
+}
+
+// Filter sweeps from an LFO and a second envelope, key-tracked, opened further by the mod wheel
+static Preset makeWobbleBass() {
+    Preset p = { "Wobble Bass", 300.0f, 0.7f, 0.005f, 0.2f, 0.8f, 0.15f, 2 };
+    p.modulation.lfoRate[0] = 3.0f;
+    p.modulation.env2Decay = 0.25f;
+    p.modulation.addRoute(ModSource::Lfo1, ModDestination::Cutoff, 2.0f);
+    p.modulation.addRoute(ModSource::Envelope2, ModDestination::Cutoff, 2.5f);
+    p.modulation.addRoute(ModSource::KeyTrack, ModDestination::Cutoff, 0.5f);
+    p.modulation.addRoute(ModSource::ModWheel, ModDestination::Cutoff, 2.0f);
+    p.modulation.addRoute(ModSource::Velocity, ModDestination::Amp, 0.5f);
+    return p;
+}
+
+// Chorus on the first bus, a dotted-eighth echo at 120 bpm on the second
+static Preset makeChorusKeys() {
+    Preset p = { "Chorus Keys", 3500.0f, 0.2f, 0.005f, 0.6f, 0.3f, 0.4f, 3 };
+    p.sendLevel[0] = 0.8f;
+    p.sendLevel[1] = 0.35f;
+    return p;
+}
+
+// Lead that glides between notes with a light vibrato
+static Preset makeGlideLead() {
+    Preset p = { "Glide Lead", 2500.0f, 0.35f, 0.01f, 0.3f, 0.7f, 0.3f, 2 };
+    p.glideTime = 0.12f;
+    p.vibratoRate = 5.5f;
+    p.vibratoDepth = 0.15f;
+    return p;
+}
+
+// Two FM pairs: a bright tine over a soft body, both decaying like a struck key
+static Preset makeFmPiano() {
+    Preset p = { "FM E.Piano", 2000.0f, 0.3f, 0.01f, 0.1f, 0.7f, 0.5f, 2 };
+    p.synthesisModel = 1;
+    p.fm.algorithm = 4;
+    p.fm.feedback = 0.3f;
+    p.fm.ops[0] = { 1.0f, 0.0f, 0.5f, 0.002f, 2.5f, 0.0f, 0.4f };
+    p.fm.ops[1] = { 14.0f, 0.0f, 0.6f, 0.002f, 0.4f, 0.0f, 0.3f };
+    p.fm.ops[2] = { 1.0f, 0.7f, 0.5f, 0.002f, 3.0f, 0.1f, 0.5f };
+    p.fm.ops[3] = { 1.0f, 0.0f, 1.2f, 0.002f, 1.2f, 0.2f, 0.5f };
+    p.sendLevel[0] = 0.5f;
+    return p;
+}
+
+// Inharmonic ratios and long decays on a single stack
+static Preset makeFmBell() {
+    Preset p = { "FM Bell", 2000.0f, 0.3f, 0.01f, 0.1f, 0.7f, 0.5f, 2 };
+    p.synthesisModel = 1;
+    p.fm.algorithm = 2;
+    p.fm.ops[0] = { 1.0f, 0.0f, 0.7f, 0.001f, 4.0f, 0.0f, 1.5f };
+    p.fm.ops[1] = { 3.5f, 0.0f, 2.5f, 0.001f, 2.0f, 0.0f, 1.0f };
+    p.fm.ops[2] = { 1.41f, 0.0f, 1.0f, 0.001f, 3.0f, 0.0f, 1.0f };
+    p.fm.ops[3] = { 2.0f, 1.5f, 1.5f, 0.001f, 1.5f, 0.0f, 1.0f };
+    p.sendLevel[1] = 0.25f;
+    return p;
+}
+
+static const int PRESET_COUNT = 9;
 static Preset factoryPresets[PRESET_COUNT] = {
     { "Default Saw", 2000.0f, 0.3f, 0.01f, 0.1f, 0.7f, 0.5f, 2 },
     { "Soft Pad", 800.0f, 0.1f, 0.5f, 0.5f, 0.8f, 1.0f, 1 }, // Triangle
-    { "Square Bass", 300.0f, 0.6f, 0.01f, 0.2f, 0.4f, 0.2f, 3 } // Square
+    { "Square Bass", 300.0f, 0.6f, 0.01f, 0.2f, 0.4f, 0.2f, 3 }, // Square
+    { "Super Saw", 6000.0f, 0.2f, 0.02f, 0.3f, 0.8f, 0.6f, 2, 7, 0.35f, 0.8f },
+    makeWobbleBass(),
+    makeChorusKeys(),
+    makeGlideLead(),
+    makeFmPiano(),
+    makeFmBell()
 };
 
 Preset PresetManager::getFactoryPreset(int index) {
@@ -11,12 +11,25 @@ struct Preset {
     float sustain;
     float release;
     int waveform;
+    int unisonVoices = 1;
+    float unisonDetune = 0.0f;
+    float unisonSpread = 0.0f;
+    ModSettings modulation; // No routes by default
+    float sendLevel[Voice::MAX_SENDS] = { 0.0f, 0.0f }; // Off by default
+    DelaySettings sendEffect[Voice::MAX_SENDS] = { DelaySettings::chorus(), DelaySettings::echo() };
+    float glideTime = 0.0f;    // Seconds; 0 = no portamento
+    float bendRange = 2.0f;    // Semitones
+    float vibratoRate = 5.0f;  // Hz
+    float vibratoDepth = 0.0f; // Semitones; 0 = off
+    int synthesisModel = 0;    // 0 = subtractive (the fields above), 1 = FM (fm below)
+    FmPatch fm;
 };
 
 class PresetManager {
 public:
     static void savePreset(const std::string& filename, const Preset& preset);
     static bool loadPreset(const std::string& filename, Preset& outPreset);
+    static void applyPreset(const Preset& preset, SynthEngine& synth);
     
     // Hardcoded factory presets for now to avoid external dependencies
     static Preset getFactoryPreset(int index);
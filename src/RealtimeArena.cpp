@@ -0,0 +1,70 @@
+#include "RealtimeArena.hpp"
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static size_t pageSize() {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : 4096;
+}
+
+RealtimeArena::RealtimeArena(size_t bytes) {
+    size_t page = pageSize();
+    capacity = (bytes + page - 1) / page * page;
+    // Anonymous pages: zeroed, page aligned, and not backed until touched
+    void* region = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (region == MAP_FAILED) {
+        error = std::string("cannot map arena: ") + std::strerror(errno);
+        capacity = 0;
+        return;
+    }
+    base = (char*)region;
+}
+
+RealtimeArena::~RealtimeArena() {
+    for (Destructor* d = destructors; d; d = d->next) d->destroy(d->object);
+    if (!base) return;
+    if (locked) munlock(base, capacity);
+    munmap(base, capacity);
+}
+
+void* RealtimeArena::allocate(size_t bytes, size_t alignment) {
+    size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (!base || start + bytes > capacity) {
+        error = "arena full";
+        return nullptr;
+    }
+    used = start + bytes;
+    allocations++;
+    return base + start;
+}
+
+bool RealtimeArena::lock() {
+    if (locked || !base) return locked;
+    if (mlock(base, capacity) != 0) {
+        error = std::string("cannot lock arena: ") + std::strerror(errno);
+        return false;
+    }
+    locked = true;
+    return true;
+}
+
+void RealtimeArena::prefault() {
+    if (!base) return;
+    // A write per page maps it; reading would only map the shared zero page
+    size_t page = pageSize();
+    for (size_t offset = 0; offset < capacity; offset += page) {
+        volatile char* p = base + offset;
+        *p = *p;
+    }
+    prefaulted = true;
+}
+
+void RealtimeArena::printFootprint(std::ostream& out) const {
+    out << "real-time arena: " << used << " of " << capacity << " bytes in " << allocations << " allocations ("
+        << capacity / pageSize() << " pages" << (locked ? ", locked" : ", not locked")
+        << (prefaulted ? ", prefaulted" : "") << ")";
+    if (!error.empty()) out << " - " << error;
+    out << "\n";
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <string>
+#include <utility>
+
+// One contiguous region for real-time state, carved up with a bump pointer.
+//
+// Allocations are cache-line aligned and never freed individually; objects made with
+// create() are destroyed in reverse order with the arena. lock() pins the region in RAM
+// and prefault() touches every page, so once both have run nothing allocated here can
+// page-fault on the audio thread. Not thread-safe: set up before rendering starts.
+class RealtimeArena {
+public:
+    static const size_t ALIGNMENT = 64; // Cache line
+
+    explicit RealtimeArena(size_t capacity);
+    ~RealtimeArena();
+    RealtimeArena(const RealtimeArena&) = delete;
+    RealtimeArena& operator=(const RealtimeArena&) = delete;
+
+    // nullptr when the arena is full
+    void* allocate(size_t bytes, size_t alignment = ALIGNMENT);
+    template <typename T>
+    T* allocateArray(size_t count) { return static_cast<T*>(allocate(count * sizeof(T), alignof(T) > ALIGNMENT ? alignof(T) : ALIGNMENT)); }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        Destructor* d = static_cast<Destructor*>(allocate(sizeof(Destructor), alignof(Destructor)));
+        void* memory = allocate(sizeof(T), alignof(T) > ALIGNMENT ? alignof(T) : ALIGNMENT);
+        if (!d || !memory) return nullptr;
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        d->destroy = [](void* p) { static_cast<T*>(p)->~T(); };
+        d->object = object;
+        d->next = destructors;
+        destructors = d;
+        return object;
+    }
+
+    bool lock(); // mlock; false (see getError) if the memlock limit is too low
+    void prefault();
+
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return used; }
+    int getAllocations() const { return allocations; }
+    bool isLocked() const { return locked; }
+    bool isPrefaulted() const { return prefaulted; }
+    const std::string& getError() const { return error; }
+    void printFootprint(std::ostream& out) const;
+
+private:
+    struct Destructor {
+        void (*destroy)(void*);
+        void* object;
+        Destructor* next;
+    };
+
+    char* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    int allocations = 0;
+    bool locked = false;
+    bool prefaulted = false;
+    std::string error;
+    Destructor* destructors = nullptr;
+};
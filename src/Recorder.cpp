@@ -0,0 +1,235 @@
+#include "Recorder.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+static void putLE16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void putLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+// Float WAV header padded with a JUNK chunk to exactly one block, so samples start aligned
+static void makeHeader(uint8_t* h, int channels, int sampleRate, uint64_t dataBytes) {
+    const int junk = Recorder::BLOCK_BYTES - 12 - 24 - 8 - 8;
+    std::memset(h, 0, Recorder::BLOCK_BYTES);
+    std::memcpy(h, "RIFF", 4);
+    putLE32(h + 4, (uint32_t)(Recorder::BLOCK_BYTES - 8 + dataBytes));
+    std::memcpy(h + 8, "WAVE", 4);
+    std::memcpy(h + 12, "fmt ", 4);
+    putLE32(h + 16, 16);
+    putLE16(h + 20, 3); // IEEE float
+    putLE16(h + 22, (uint16_t)channels);
+    putLE32(h + 24, (uint32_t)sampleRate);
+    putLE32(h + 28, (uint32_t)(sampleRate * channels * 4));
+    putLE16(h + 32, (uint16_t)(channels * 4));
+    putLE16(h + 34, 32);
+    std::memcpy(h + 36, "JUNK", 4);
+    putLE32(h + 40, junk);
+    std::memcpy(h + 44 + junk, "data", 4);
+    putLE32(h + 48 + junk, (uint32_t)dataBytes);
+}
+
+static bool setDirectIo(int fd, bool enable) {
+#if defined(O_DIRECT)
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0) return false;
+    return fcntl(fd, F_SETFL, enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT)) == 0;
+#elif defined(F_NOCACHE)
+    return fcntl(fd, F_NOCACHE, enable ? 1 : 0) == 0;
+#else
+    (void)fd;
+    (void)enable;
+    return false;
+#endif
+}
+
+Recorder::Recorder(int channels, int frames) : numChannels(std::max(1, channels)) {
+    ringFrames = 1;
+    while (ringFrames < (uint32_t)frames) ringFrames <<= 1;
+    // Sized and touched up front so push() never faults in new pages
+    ring.assign(numChannels, std::vector<float>(ringFrames, 0.0f));
+
+    void* memory = nullptr;
+    if (posix_memalign(&memory, BLOCK_BYTES, (size_t)CHUNK_FRAMES * numChannels * sizeof(float)) == 0) {
+        chunk = std::unique_ptr<float, void (*)(void*)>((float*)memory, std::free);
+    }
+}
+
+Recorder::~Recorder() {
+    stop();
+}
+
+void Recorder::push(const float* const* channels, int frames) {
+    if (!recording.load(std::memory_order_relaxed)) return;
+    uint64_t write = writeIndex.load(std::memory_order_relaxed);
+    uint64_t read = readIndex.load(std::memory_order_acquire);
+    if (ringFrames - (write - read) < (uint64_t)frames) {
+        overflows.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames.fetch_add((uint64_t)frames, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t offset = (uint32_t)(write & (ringFrames - 1));
+    uint32_t first = std::min<uint32_t>((uint32_t)frames, ringFrames - offset);
+    for (int c = 0; c < numChannels; ++c) {
+        float* dst = ring[c].data();
+        std::memcpy(dst + offset, channels[c], first * sizeof(float));
+        std::memcpy(dst, channels[c] + first, (frames - first) * sizeof(float));
+    }
+    writeIndex.store(write + frames, std::memory_order_release);
+}
+
+bool Recorder::start(const std::string& path, int rate, RecordFormat fmt, double rotateSeconds) {
+    stop();
+    error.clear();
+    if (!chunk) {
+        error = "cannot allocate the write buffer";
+        return false;
+    }
+    basePath = path;
+    sampleRate = rate;
+    format = fmt;
+    fileIndex = 0;
+
+    // Rotation points fall on whole chunks so direct writes stay block-sized
+    uint64_t limit = UINT64_MAX;
+    if (format == RecordFormat::Wav) limit = (0xFFFFFFFFull - BLOCK_BYTES) / (numChannels * sizeof(float));
+    if (rotateSeconds > 0.0) {
+        uint64_t requested = (uint64_t)std::ceil(rotateSeconds * sampleRate / CHUNK_FRAMES) * CHUNK_FRAMES;
+        limit = std::min(limit, std::max<uint64_t>(requested, CHUNK_FRAMES));
+    }
+    framesPerFile = limit == UINT64_MAX ? limit : std::max<uint64_t>(CHUNK_FRAMES, limit / CHUNK_FRAMES * CHUNK_FRAMES);
+    numbered = rotateSeconds > 0.0;
+
+    if (!openFile()) return false;
+    overflows.store(0, std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+    framesWritten.store(0, std::memory_order_relaxed);
+    filesWritten.store(0, std::memory_order_relaxed);
+    readIndex.store(writeIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    stopping.store(false, std::memory_order_relaxed);
+    writer = std::thread(&Recorder::writerLoop, this);
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void Recorder::stop() {
+    if (!writer.joinable()) return;
+    // Blocks pushed concurrently with this call may be left out
+    recording.store(false, std::memory_order_release);
+    stopping.store(true, std::memory_order_release);
+    wake.notify_one();
+    writer.join();
+    closeFile();
+}
+
+std::string Recorder::nextFileName() {
+    fileIndex++;
+    if (!numbered && fileIndex == 1) return basePath;
+    size_t dot = basePath.find_last_of('.');
+    size_t slash = basePath.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = basePath.size();
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "-%04d", fileIndex);
+    return basePath.substr(0, dot) + suffix + basePath.substr(dot);
+}
+
+bool Recorder::openFile() {
+    std::string name = nextFileName();
+    fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = "cannot create " + name;
+        return false;
+    }
+    if (format == RecordFormat::Wav) {
+        uint8_t header[BLOCK_BYTES];
+        makeHeader(header, numChannels, sampleRate, 0);
+        if (::write(fd, header, BLOCK_BYTES) != BLOCK_BYTES) {
+            error = "cannot write " + name;
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+    }
+    directIo = setDirectIo(fd, true); // Falls back to the page cache where unsupported (tmpfs, ...)
+    fileFrames = 0;
+    return true;
+}
+
+void Recorder::closeFile() {
+    if (fd < 0) return;
+    if (directIo) setDirectIo(fd, false);
+    if (format == RecordFormat::Wav) {
+        uint8_t header[BLOCK_BYTES];
+        makeHeader(header, numChannels, sampleRate, fileFrames * numChannels * sizeof(float));
+        if (pwrite(fd, header, BLOCK_BYTES, 0) != BLOCK_BYTES && error.empty()) error = "cannot finish WAV header";
+    }
+    ::close(fd);
+    fd = -1;
+    filesWritten.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Recorder::writeFrames(int frames) {
+    RX_TRACE_SCOPE("Recorder::write");
+    uint64_t read = readIndex.load(std::memory_order_relaxed);
+    float* out = chunk.get();
+    for (int i = 0; i < frames; ++i) {
+        uint32_t index = (uint32_t)((read + i) & (ringFrames - 1));
+        for (int c = 0; c < numChannels; ++c) *out++ = ring[c][index];
+    }
+    readIndex.store(read + frames, std::memory_order_release); // The ring space is free again
+
+    size_t bytes = (size_t)frames * numChannels * sizeof(float);
+    if (directIo && bytes % BLOCK_BYTES) directIo = !setDirectIo(fd, false); // Short final chunk
+    const char* p = (const char*)chunk.get();
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EINVAL && directIo) {
+            // Accepted the flag but not the write; carry on through the page cache
+            setDirectIo(fd, false);
+            directIo = false;
+            continue;
+        }
+        if (n <= 0) {
+            error = std::string("write failed: ") + std::strerror(errno);
+            return false;
+        }
+        p += n;
+        bytes -= (size_t)n;
+    }
+    fileFrames += frames;
+    framesWritten.fetch_add((uint64_t)frames, std::memory_order_relaxed);
+    return true;
+}
+
+void Recorder::writerLoop() {
+    RX_TRACE_THREAD("recorder");
+    while (true) {
+        uint64_t available = writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_relaxed);
+        bool finishing = stopping.load(std::memory_order_acquire);
+        if (available >= (uint64_t)CHUNK_FRAMES || (finishing && available > 0)) {
+            if (fileFrames >= framesPerFile) {
+                closeFile();
+                if (!openFile()) break;
+            }
+            int frames = (int)std::min<uint64_t>({ available, (uint64_t)CHUNK_FRAMES, framesPerFile - fileFrames });
+            if (!writeFrames(frames)) break;
+            continue;
+        }
+        if (finishing) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, std::chrono::milliseconds(5));
+    }
+    recording.store(false, std::memory_order_release); // I/O error: stop taking blocks
+}
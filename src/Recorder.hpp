@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class RecordFormat { Wav, RawFloat }; // Both 32-bit float; raw is interleaved with no header
+
+// Records an output stream to disk without putting I/O on the audio thread.
+//
+// The audio thread copies each block into a preallocated planar ring (memcpy only,
+// no locks, no allocation); a block that does not fit is dropped whole and counted.
+// A writer thread drains the ring in CHUNK_FRAMES pieces, interleaves them into an
+// aligned buffer and writes them with O_DIRECT (F_NOCACHE on macOS) when the file
+// system allows it, buffered I/O otherwise. WAV headers are padded to one 4 KiB block
+// so every data write stays aligned. Files rotate after a set length, and always
+// before the 4 GiB RIFF limit.
+class Recorder {
+public:
+    static const int CHUNK_FRAMES = 16384;
+    static const int BLOCK_BYTES = 4096; // Alignment for direct I/O
+
+    // ringFrames is rounded up to a power of two; the default holds ~24 s at 44.1 kHz
+    explicit Recorder(int channels = 2, int ringFrames = 1 << 20);
+    ~Recorder();
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Control thread. With rotateSeconds > 0, files are numbered: take.wav -> take-0001.wav, ...
+    bool start(const std::string& path, int sampleRate, RecordFormat format = RecordFormat::Wav,
+               double rotateSeconds = 0.0);
+    void stop(); // Writes out everything pushed so far and closes the file
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+
+    // Audio thread. Planar input; wait-free
+    void push(const float* const* channels, int frames);
+
+    uint64_t getOverflows() const { return overflows.load(std::memory_order_relaxed); }        // Blocks dropped
+    uint64_t getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+    uint64_t getFramesWritten() const { return framesWritten.load(std::memory_order_relaxed); }
+    int getFilesWritten() const { return filesWritten.load(std::memory_order_relaxed); }
+    bool isDirectIo() const { return directIo; } // Of the last file opened
+    const std::string& getError() const { return error; } // Valid after stop()
+
+private:
+    int numChannels;
+    uint32_t ringFrames;
+    std::vector<std::vector<float>> ring;
+    std::atomic<uint64_t> writeIndex{0}; // Audio thread
+    std::atomic<uint64_t> readIndex{0};  // Writer thread
+    std::atomic<bool> recording{false};
+    std::atomic<uint64_t> overflows{0};
+    std::atomic<uint64_t> droppedFrames{0};
+    std::atomic<uint64_t> framesWritten{0};
+    std::atomic<int> filesWritten{0};
+
+    // Writer thread state
+    std::string basePath;
+    int sampleRate = 44100;
+    RecordFormat format = RecordFormat::Wav;
+    uint64_t framesPerFile = 0;
+    bool numbered = false;
+    int fd = -1;
+    int fileIndex = 0;
+    uint64_t fileFrames = 0;
+    bool directIo = false;
+    std::string error;
+    std::unique_ptr<float, void (*)(void*)> chunk{ nullptr, nullptr }; // Aligned, interleaved
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+
+    std::string nextFileName();
+    bool openFile();
+    void closeFile();
+    bool writeFrames(int frames);
+    void writerLoop();
+};
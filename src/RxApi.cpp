@@ -0,0 +1,284 @@
+#include "rx.h"
+#include "Automation.hpp"
+#include "EventLog.hpp"
+#include "PresetManager.hpp"
+#include "RealtimeArena.hpp"
+#include "SynthEngine.hpp"
+#include "Trace.hpp"
+#include "dsp/VectorOps.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <new>
+
+struct rx_engine {
+    static const size_t ARENA_BYTES = 1 << 18; // The engine needs ~45 KB today
+
+    // The synth and every buffer it renders into live here
+    RealtimeArena arena{ARENA_BYTES};
+    SynthEngine* synth = nullptr;
+    std::unique_ptr<SynthEngine> heapSynth; // Only if the arena could not be mapped
+    DspBuffer hostView;                     // The caller's planar channels, re-wrapped per piece
+    DspBuffer scratch{RX_CHANNELS, SynthEngine::MAX_BLOCK}; // Only for interleaved output
+    float params[RX_PARAM_COUNT] = {};
+    Automation automation;
+    uint64_t position = 0; // Automation timeline
+    bool recording = false;
+    rx_tap tap = nullptr;
+    void* tapUser = nullptr;
+    std::unique_ptr<EventLog> eventLog; // Only from rx_create_logged
+};
+
+static const char* paramNames[RX_PARAM_COUNT] = {
+    "master volume", "cutoff", "resonance", "attack", "decay", "sustain", "release", "waveform",
+    "mod wheel", "pitch bend", "bend range", "portamento", "vibrato rate", "vibrato depth"
+};
+
+static void applyPresetParams(rx_engine* e, const Preset& preset) {
+    PresetManager::applyPreset(preset, *e->synth);
+    float* p = e->params;
+    p[RX_PARAM_CUTOFF] = preset.cutoff;
+    p[RX_PARAM_RESONANCE] = preset.resonance;
+    p[RX_PARAM_ATTACK] = preset.attack;
+    p[RX_PARAM_DECAY] = preset.decay;
+    p[RX_PARAM_SUSTAIN] = preset.sustain;
+    p[RX_PARAM_RELEASE] = preset.release;
+    p[RX_PARAM_WAVEFORM] = (float)preset.waveform;
+    p[RX_PARAM_BEND_RANGE] = preset.bendRange;
+    p[RX_PARAM_PORTAMENTO] = preset.glideTime;
+    p[RX_PARAM_VIBRATO_RATE] = preset.vibratoRate;
+    p[RX_PARAM_VIBRATO_DEPTH] = preset.vibratoDepth;
+}
+
+// Keeps rx_get_param in step with controllers that arrive as MIDI
+static void handleEvent(rx_engine* e, const rx_event& event) {
+    MidiEvent midi;
+    midi.status = event.status;
+    midi.data1 = event.data1 & 0x7F;
+    midi.data2 = event.data2 & 0x7F;
+    if (midi.type() == 0xB0 && midi.data1 == 1) e->params[RX_PARAM_MOD_WHEEL] = midi.data2 / 127.0f;
+    else if (midi.type() == 0xE0) e->params[RX_PARAM_PITCH_BEND] = (((midi.data2 << 7) | midi.data1) - 8192) / 8192.0f;
+    e->synth->handleMidiEvent(midi);
+}
+
+// Splits the block at event offsets and at MAX_BLOCK, the size the arena buffers were made for.
+// `render` fills frames [offset, offset + n) of the host's output
+template <typename Render>
+static void processEvents(rx_engine* e, int frames, const rx_event* events, int numEvents, Render&& render) {
+    RX_TRACE_SCOPE("rx_process");
+    EventLog* log = e->eventLog.get();
+    std::chrono::steady_clock::time_point start;
+    if (log) {
+        EventRecord callback = {};
+        callback.frame = e->synth->getPosition();
+        callback.kind = EventKind::Callback;
+        callback.data = (uint32_t)frames;
+        log->write(&callback, 1);
+        start = std::chrono::steady_clock::now();
+    }
+    int next = 0;
+    for (int done = 0; done < frames;) {
+        while (next < numEvents && (int)events[next].frame <= done) handleEvent(e, events[next++]);
+        int end = std::min(frames, done + SynthEngine::MAX_BLOCK);
+        if (next < numEvents) end = std::min(end, (int)events[next].frame);
+        render(done, end - done);
+        done = end;
+    }
+    while (next < numEvents) handleEvent(e, events[next++]); // Offsets past the block land at its end
+    if (log) {
+        EventRecord end = {};
+        end.frame = e->synth->getPosition();
+        end.kind = EventKind::CallbackEnd;
+        end.data = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        log->write(&end, 1);
+    }
+}
+
+// Automation lane for an rx parameter, or nullptr
+static AutomationLane* laneFor(rx_engine* e, rx_param param) {
+    switch (param) {
+        case RX_PARAM_MASTER_VOLUME: return &e->automation.lane(AutomationTarget::Volume);
+        case RX_PARAM_CUTOFF: return &e->automation.lane(AutomationTarget::Cutoff);
+        case RX_PARAM_RESONANCE: return &e->automation.lane(AutomationTarget::Resonance);
+        case RX_PARAM_ATTACK: return &e->automation.lane(AutomationTarget::Attack);
+        case RX_PARAM_DECAY: return &e->automation.lane(AutomationTarget::Decay);
+        case RX_PARAM_SUSTAIN: return &e->automation.lane(AutomationTarget::Sustain);
+        case RX_PARAM_RELEASE: return &e->automation.lane(AutomationTarget::Release);
+        default: return nullptr;
+    }
+}
+
+static void renderPiece(rx_engine* e, DspBuffer& buffer) {
+    if (!e->recording && !e->automation.isEmpty()) e->automation.render(*e->synth, buffer, e->position);
+    else e->synth->render(buffer);
+    e->position += buffer.getNumFrames();
+}
+
+static void callTap(rx_engine* e, DspBuffer& buffer, int frames) {
+    if (!e->tap) return;
+    const float* channels[RX_CHANNELS] = { buffer.getChannel(0), buffer.getChannel(1) };
+    e->tap(channels, frames, e->tapUser);
+}
+
+extern "C" {
+
+int rx_api_version(void) { return RX_API_VERSION; }
+
+rx_engine* rx_create(double sampleRate) {
+    return rx_create_logged(sampleRate, nullptr);
+}
+
+rx_engine* rx_create_logged(double sampleRate, const char* eventLogPath) {
+    rx_engine* e = new (std::nothrow) rx_engine();
+    if (!e) return nullptr;
+    e->synth = e->arena.create<SynthEngine>();
+    if (e->synth) {
+        e->synth->allocateFrom(e->arena);
+        e->scratch.allocateFrom(e->arena, SynthEngine::MAX_BLOCK);
+    } else {
+        std::cerr << "Real-time arena unavailable (" << e->arena.getError() << "), using the heap." << std::endl;
+        e->heapSynth.reset(new (std::nothrow) SynthEngine());
+        e->synth = e->heapSynth.get();
+        if (!e->synth) {
+            delete e;
+            return nullptr;
+        }
+    }
+    if (eventLogPath) {
+        // Before the engine is configured, so a replay starts from the same state
+        e->eventLog.reset(new EventLog());
+        if (!e->eventLog->open(eventLogPath)) {
+            std::cerr << "Event log: " << e->eventLog->getError() << std::endl;
+            delete e;
+            return nullptr;
+        }
+        e->synth->setEventLog(e->eventLog.get());
+    }
+    e->synth->setSampleRate(sampleRate);
+    applyPresetParams(e, PresetManager::getFactoryPreset(0));
+    rx_set_param(e, RX_PARAM_MASTER_VOLUME, 0.2f);
+    return e;
+}
+
+void rx_destroy(rx_engine* engine) {
+    delete engine;
+}
+
+int rx_prepare_realtime(rx_engine* engine) {
+    // Locking can fail under a low memlock limit; prefaulting still helps then
+    if (!engine->arena.isPrefaulted()) {
+        engine->arena.lock();
+        engine->arena.prefault();
+    }
+    return engine->arena.isLocked() ? 1 : 0;
+}
+
+void rx_process(rx_engine* engine, float** outs, int frames, const rx_event* events, int numEvents) {
+    processEvents(engine, frames, events, numEvents, [&](int offset, int n) {
+        float* channels[RX_CHANNELS] = { outs[0] + offset, outs[1] + offset };
+        engine->hostView.wrap(channels, RX_CHANNELS, n);
+        renderPiece(engine, engine->hostView); // Straight into the host's memory
+        callTap(engine, engine->hostView, n);
+    });
+}
+
+void rx_process_interleaved(rx_engine* engine, float* out, int frames, const rx_event* events, int numEvents) {
+    processEvents(engine, frames, events, numEvents, [&](int offset, int n) {
+        DspBuffer& buffer = engine->scratch;
+        buffer.resize(RX_CHANNELS, n);
+        renderPiece(engine, buffer);
+        VectorOps::interleave(out + 2 * offset, buffer.getChannel(0), buffer.getChannel(1), n);
+        callTap(engine, buffer, n);
+    });
+}
+
+void rx_set_param(rx_engine* engine, rx_param param, float value) {
+    if (param < 0 || param >= RX_PARAM_COUNT) return;
+    float* p = engine->params;
+    p[param] = value;
+    AutomationLane* lane = engine->recording ? laneFor(engine, param) : nullptr;
+    if (lane) lane->record(engine->position, value);
+    SynthEngine& synth = *engine->synth;
+    switch (param) {
+        case RX_PARAM_MASTER_VOLUME: synth.setMasterVolume(value); break;
+        case RX_PARAM_CUTOFF: synth.setFilterCutoff(value); break;
+        case RX_PARAM_RESONANCE: synth.setFilterResonance(value); break;
+        case RX_PARAM_ATTACK:
+        case RX_PARAM_DECAY:
+        case RX_PARAM_SUSTAIN:
+        case RX_PARAM_RELEASE:
+            synth.setEnvelopeParams(p[RX_PARAM_ATTACK], p[RX_PARAM_DECAY], p[RX_PARAM_SUSTAIN], p[RX_PARAM_RELEASE]);
+            break;
+        case RX_PARAM_WAVEFORM: synth.setWaveform((int)value); break;
+        case RX_PARAM_MOD_WHEEL: synth.setModWheel(value); break;
+        case RX_PARAM_PITCH_BEND: synth.setPitchBend(value); break;
+        case RX_PARAM_BEND_RANGE: synth.setPitchBendRange(value); break;
+        case RX_PARAM_PORTAMENTO: synth.setPortamento(value); break;
+        case RX_PARAM_VIBRATO_RATE:
+        case RX_PARAM_VIBRATO_DEPTH:
+            synth.setVibrato(p[RX_PARAM_VIBRATO_RATE], p[RX_PARAM_VIBRATO_DEPTH]);
+            break;
+        default: break;
+    }
+}
+
+float rx_get_param(const rx_engine* engine, rx_param param) {
+    if (param < 0 || param >= RX_PARAM_COUNT) return 0.0f;
+    return engine->params[param];
+}
+
+const char* rx_param_name(rx_param param) {
+    if (param < 0 || param >= RX_PARAM_COUNT) return "";
+    return paramNames[param];
+}
+
+int rx_preset_count(void) { return PresetManager::getFactoryPresetCount(); }
+
+const char* rx_preset_name(int index) { return PresetManager::getFactoryPresetName(index); }
+
+int rx_load_preset(rx_engine* engine, int index) {
+    if (index < 0 || index >= PresetManager::getFactoryPresetCount()) return 0;
+    applyPresetParams(engine, PresetManager::getFactoryPreset(index));
+    return 1;
+}
+
+void rx_reset(rx_engine* engine) {
+    engine->synth->reset();
+}
+
+void rx_set_tap(rx_engine* engine, rx_tap tap, void* user) {
+    engine->tap = tap;
+    engine->tapUser = user;
+}
+
+int rx_automation_add(rx_engine* engine, rx_param param, uint64_t frame, float value) {
+    AutomationLane* lane = laneFor(engine, param);
+    if (!lane) return 0;
+    lane->add(frame, value);
+    return 1;
+}
+
+void rx_automation_clear(rx_engine* engine) {
+    engine->automation.clear();
+}
+
+void rx_automation_record(rx_engine* engine, int enabled) {
+    engine->recording = enabled != 0;
+    if (!engine->recording) engine->automation.seek(engine->position);
+}
+
+void rx_set_position(rx_engine* engine, uint64_t frame) {
+    engine->position = frame;
+    engine->automation.seek(frame);
+}
+
+uint64_t rx_get_position(const rx_engine* engine) {
+    return engine->position;
+}
+
+} // extern "C"
+
+SynthEngine* rx_get_synth(rx_engine* engine) { return engine->synth; }
+
+const RealtimeArena* rx_get_arena(const rx_engine* engine) { return &engine->arena; }
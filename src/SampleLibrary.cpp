@@ -0,0 +1,160 @@
+#include "SampleLibrary.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const std::string& path, std::string& error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        error = "cannot map empty file " + path;
+        return false;
+    }
+    void* mapping = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        error = "cannot map " + path;
+        return false;
+    }
+    data = (const uint8_t*)mapping;
+    size = (size_t)st.st_size;
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data) munmap((void*)data, size);
+    data = nullptr;
+    size = 0;
+}
+
+void MappedFile::willNeed(size_t offset, size_t length) const {
+    if (!data || offset >= size) return;
+    // madvise wants a page-aligned start
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset & ~(page - 1);
+    size_t end = std::min(size, offset + length);
+    madvise((void*)(data + begin), end - begin, MADV_WILLNEED);
+}
+
+void Sample::read(size_t first, int count, float* stereo) const {
+    const uint8_t* bytes = file.getData();
+    int right = layout.numChannels > 1 ? 1 : 0;
+    for (int i = 0; i < count; ++i) {
+        stereo[2 * i] = layout.decode(bytes, first + i, 0);
+        stereo[2 * i + 1] = layout.decode(bytes, first + i, right);
+    }
+}
+
+void Sample::willNeed(size_t first, size_t count) const {
+    file.willNeed(layout.dataOffset + first * layout.getBytesPerFrame(), count * layout.getBytesPerFrame());
+}
+
+bool SampleLibrary::addSample(const std::string& path, const SampleZone& zone) {
+    std::unique_ptr<Sample> sample(new Sample());
+    sample->path = path;
+    sample->zone = zone;
+    if (!sample->file.open(path, error)) return false;
+    std::string reason;
+    if (!sample->layout.parse(sample->file.getData(), sample->file.getSize(), reason)) {
+        error = path + ": " + reason;
+        return false;
+    }
+
+    // Decode the head now; these pages are never needed again from the mapping
+    size_t frames = std::min(sample->layout.numFrames, (size_t)(preloadMs * 0.001 * sample->layout.sampleRate));
+    sample->preloadFrames = frames;
+    std::vector<float> stereo(2 * frames);
+    sample->read(0, (int)frames, stereo.data());
+    for (int c = 0; c < 2; ++c) {
+        sample->preload[c].resize(frames);
+        for (size_t i = 0; i < frames; ++i) sample->preload[c][i] = stereo[2 * i + c];
+    }
+    samples.push_back(std::move(sample));
+    return true;
+}
+
+const Sample* SampleLibrary::find(int note, int velocity) const {
+    for (const auto& sample : samples) {
+        const SampleZone& z = sample->zone;
+        if (note >= z.lowKey && note <= z.highKey && velocity >= z.lowVelocity && velocity <= z.highVelocity) {
+            return sample.get();
+        }
+    }
+    return nullptr;
+}
+
+size_t SampleLibrary::getResidentBytes() const {
+    size_t bytes = 0;
+    for (const auto& sample : samples) bytes += 2 * sample->preloadFrames * sizeof(float);
+    return bytes;
+}
+
+size_t SampleLibrary::getMappedBytes() const {
+    size_t bytes = 0;
+    for (const auto& sample : samples) bytes += sample->file.getSize();
+    return bytes;
+}
+
+std::shared_ptr<const SampleLibrary> SampleLibrary::load(const std::string& mapPath) {
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::weak_ptr<const SampleLibrary>> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (auto cached = cache[mapPath].lock()) return cached;
+
+    std::ifstream file(mapPath);
+    if (!file.is_open()) {
+        std::cerr << "Sample map " << mapPath << ": cannot open" << std::endl;
+        return nullptr;
+    }
+    size_t slash = mapPath.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "" : mapPath.substr(0, slash + 1);
+
+    std::shared_ptr<SampleLibrary> library;
+    double preloadMs = DEFAULT_PRELOAD_MS;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t delimiterPos = line.find('=');
+        if (line.empty() || line[0] == '#' || delimiterPos == std::string::npos) continue;
+        std::string key = line.substr(0, delimiterPos);
+        std::string value = line.substr(delimiterPos + 1);
+
+        if (key == "preload" && !library) {
+            preloadMs = std::stod(value); // Only before the first sample
+        } else if (key == "sample") {
+            if (!library) library.reset(new SampleLibrary(preloadMs));
+            size_t comma = value.find(',');
+            std::string path = value.substr(0, comma);
+            if (!path.empty() && path[0] != '/') path = dir + path;
+            SampleZone zone;
+            if (comma != std::string::npos) {
+                std::sscanf(value.c_str() + comma + 1, "%d,%d,%d,%d,%d", &zone.rootNote, &zone.lowKey, &zone.highKey,
+                            &zone.lowVelocity, &zone.highVelocity);
+            }
+            if (!library->addSample(path, zone)) {
+                std::cerr << "Sample map " << mapPath << ": " << library->getError() << std::endl;
+                return nullptr;
+            }
+        }
+    }
+    if (!library) {
+        std::cerr << "Sample map " << mapPath << ": no samples" << std::endl;
+        return nullptr;
+    }
+    cache[mapPath] = library;
+    return library;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "WavFile.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first touch,
+// so only the streaming thread should read past a sample's resident head.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const uint8_t* getData() const { return data; }
+    size_t getSize() const { return size; }
+    // Asks the OS to start reading [offset, offset + length) in the background
+    void willNeed(size_t offset, size_t length) const;
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Keys and velocities a sample answers to, and the note it was recorded at
+struct SampleZone {
+    int rootNote = 60;
+    int lowKey = 0, highKey = 127;
+    int lowVelocity = 1, highVelocity = 127;
+};
+
+// One mapped WAV file. The first preload frames are decoded to float at load time
+// and stay resident, so a note can start before any of the file has been streamed.
+class Sample {
+public:
+    const SampleZone& getZone() const { return zone; }
+    const std::string& getPath() const { return path; }
+    size_t getNumFrames() const { return layout.numFrames; }
+    int getSampleRate() const { return layout.sampleRate; }
+    size_t getPreloadFrames() const { return preloadFrames; }
+    const float* getPreload(int channel) const { return preload[channel].data(); } // Stereo, planar
+
+    // Decodes frames [first, first + count) to interleaved stereo; mono is duplicated.
+    // Touches the mapping, so this may page-fault: streaming thread only.
+    void read(size_t first, int count, float* stereo) const;
+    void willNeed(size_t first, size_t count) const;
+
+private:
+    friend class SampleLibrary;
+
+    std::string path;
+    SampleZone zone;
+    MappedFile file;
+    WavLayout layout;
+    size_t preloadFrames = 0;
+    std::vector<float> preload[2];
+};
+
+// Zone-mapped set of samples making up one instrument. Immutable once loaded,
+// so engines, voices and the streaming thread can share it without locking.
+class SampleLibrary {
+public:
+    static constexpr double DEFAULT_PRELOAD_MS = 250.0;
+
+    explicit SampleLibrary(double preloadMs = DEFAULT_PRELOAD_MS) : preloadMs(preloadMs) {}
+
+    // Instrument from a text map, cached per path so batch workers share the mappings.
+    // Map lines (key=value, # comments; sample paths relative to the map):
+    //   preload=<ms>
+    //   sample=<wav>,<root>[,<lowKey>,<highKey>[,<lowVel>,<highVel>]]
+    // Returns nullptr (and prints why) if the map or any sample cannot be used.
+    static std::shared_ptr<const SampleLibrary> load(const std::string& mapPath);
+
+    bool addSample(const std::string& path, const SampleZone& zone);
+    const std::string& getError() const { return error; }
+
+    // First sample whose zone covers the note and velocity, or nullptr
+    const Sample* find(int note, int velocity) const;
+    int getNumSamples() const { return (int)samples.size(); }
+    const Sample& getSample(int index) const { return *samples[index]; }
+    size_t getResidentBytes() const;
+    size_t getMappedBytes() const;
+
+private:
+    double preloadMs;
+    std::vector<std::unique_ptr<Sample>> samples;
+    std::string error;
+};
@@ -0,0 +1,92 @@
+#include "SampleStreamer.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+
+uint32_t SampleStreamer::Slot::request(const Sample* s, uint64_t frame) {
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    requestSample.store(s, std::memory_order_relaxed);
+    requestFrame.store(frame, std::memory_order_relaxed);
+    sequence.store(seq + 2, std::memory_order_release);
+    return seq + 2;
+}
+
+bool SampleStreamer::Slot::isServing(uint32_t id, uint64_t& startIndex) const {
+    if (served.load(std::memory_order_acquire) != id) return false;
+    startIndex = streamStart.load(std::memory_order_relaxed);
+    return true;
+}
+
+SampleStreamer::SampleStreamer(std::shared_ptr<const SampleLibrary> lib, int numSlots) : library(std::move(lib)) {
+    for (int i = 0; i < numSlots; ++i) {
+        slots.emplace_back(new Slot());
+        slots.back()->ring.assign(2 * RING_FRAMES, 0.0f); // Touched here, never faults later
+    }
+    worker = std::thread(&SampleStreamer::workerLoop, this);
+}
+
+SampleStreamer::~SampleStreamer() {
+    quit.store(true, std::memory_order_release);
+    wake.notify_one();
+    worker.join();
+}
+
+// Picks up a new request if the voice wrote one; true if the slot changed
+bool SampleStreamer::adoptRequest(Slot& slot) {
+    uint32_t seq = slot.sequence.load(std::memory_order_acquire);
+    if ((seq & 1) || seq == slot.served.load(std::memory_order_relaxed)) return false;
+    const Sample* s = slot.requestSample.load(std::memory_order_relaxed);
+    uint64_t frame = slot.requestFrame.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != seq) return false; // Torn; next pass
+
+    // The new stream starts wherever the ring is. Older frames are abandoned and released
+    // here: the voice only releases again once it sees this request served.
+    uint64_t start = slot.writeIndex.load(std::memory_order_relaxed);
+    slot.sample = s;
+    slot.sourceFrame = frame;
+    slot.streamStart.store(start, std::memory_order_relaxed);
+    slot.readIndex.store(start, std::memory_order_relaxed);
+    slot.served.store(seq, std::memory_order_release);
+    return true;
+}
+
+// Decodes one chunk into the ring if there is room; true if anything was written
+bool SampleStreamer::fill(Slot& slot) {
+    if (!slot.sample || slot.sourceFrame >= slot.sample->getNumFrames()) return false;
+    uint64_t write = slot.writeIndex.load(std::memory_order_relaxed);
+    uint64_t space = RING_FRAMES - (write - slot.readIndex.load(std::memory_order_acquire));
+    uint64_t remaining = slot.sample->getNumFrames() - slot.sourceFrame;
+    int count = (int)std::min<uint64_t>({ space, (uint64_t)CHUNK_FRAMES, remaining });
+    if (count <= 0) return false;
+    RX_TRACE_SCOPE("SampleStreamer::fill");
+
+    // Split at the ring end
+    int offset = (int)(write & (RING_FRAMES - 1));
+    int first = std::min(count, RING_FRAMES - offset);
+    slot.sample->read(slot.sourceFrame, first, &slot.ring[2 * offset]);
+    if (count > first) slot.sample->read(slot.sourceFrame + first, count - first, &slot.ring[0]);
+    slot.sourceFrame += count;
+    slot.writeIndex.store(write + count, std::memory_order_release);
+
+    // Have the kernel read ahead of the next chunks
+    slot.sample->willNeed(slot.sourceFrame, 4 * CHUNK_FRAMES);
+    return true;
+}
+
+void SampleStreamer::workerLoop() {
+    RX_TRACE_THREAD("streamer");
+    while (!quit.load(std::memory_order_acquire)) {
+        // Round robin, one chunk per slot per pass, so every voice makes progress
+        bool busy = false;
+        for (auto& slot : slots) {
+            busy |= adoptRequest(*slot);
+            busy |= fill(*slot);
+        }
+        if (busy) continue;
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "SampleLibrary.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Background thread that streams sample bodies from their mappings into per-voice rings.
+//
+// Each voice owns one Slot: a single-producer/single-consumer ring of decoded stereo
+// frames plus a request the voice rewrites at note-on. Ring positions are monotonic
+// 64-bit counters, so neither side ever resets an index the other is reading. Only
+// this thread touches mapped pages; the audio thread reads resident heads and rings.
+class SampleStreamer {
+public:
+    static const int RING_FRAMES = 16384; // Power of two
+    static const int CHUNK_FRAMES = 1024; // Frames decoded per slot per pass
+
+    class Slot {
+    public:
+        // Audio thread. Stream `sample` from `frame` on (nullptr stops); returns the request id
+        uint32_t request(const Sample* sample, uint64_t frame);
+        // Ring index of the requested frame once the streamer has picked up request `id`
+        bool isServing(uint32_t id, uint64_t& startIndex) const;
+        uint64_t getWriteIndex() const { return writeIndex.load(std::memory_order_acquire); }
+        // Ring positions below `index` may be overwritten
+        void release(uint64_t index) { readIndex.store(index, std::memory_order_release); }
+        const float* frameAt(uint64_t index) const { return &ring[2 * (index & (RING_FRAMES - 1))]; }
+
+    private:
+        friend class SampleStreamer;
+
+        // Request, written by the voice. Seqlock: odd while being written
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<const Sample*> requestSample{nullptr};
+        std::atomic<uint64_t> requestFrame{0};
+
+        // Published by the streamer
+        std::atomic<uint32_t> served{0};
+        std::atomic<uint64_t> streamStart{0};
+        std::atomic<uint64_t> writeIndex{0};
+
+        // Published by the voice, and moved to streamStart by the streamer when it adopts a request
+        std::atomic<uint64_t> readIndex{0};
+
+        std::vector<float> ring; // Interleaved stereo
+
+        // Streamer-private
+        const Sample* sample = nullptr;
+        uint64_t sourceFrame = 0;
+    };
+
+    SampleStreamer(std::shared_ptr<const SampleLibrary> library, int numSlots);
+    ~SampleStreamer();
+    SampleStreamer(const SampleStreamer&) = delete;
+    SampleStreamer& operator=(const SampleStreamer&) = delete;
+
+    Slot* getSlot(int index) { return slots[index].get(); }
+    const SampleLibrary& getLibrary() const { return *library; }
+
+    // Offline renders wait for late frames so output is deterministic
+    void setWaitForData(bool wait) { waitForData = wait; }
+    bool getWaitForData() const { return waitForData; }
+
+    // Called by voices that needed frames the ring did not have yet
+    void countMiss(int frames) {
+        prefetchMisses.fetch_add(1, std::memory_order_relaxed);
+        missedFrames.fetch_add((uint64_t)frames, std::memory_order_relaxed);
+    }
+    uint64_t getPrefetchMisses() const { return prefetchMisses.load(std::memory_order_relaxed); } // Blocks with a gap
+    uint64_t getMissedFrames() const { return missedFrames.load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<const SampleLibrary> library;
+    std::vector<std::unique_ptr<Slot>> slots;
+    bool waitForData = false;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::atomic<bool> quit{false};
+    std::atomic<uint64_t> prefetchMisses{0};
+    std::atomic<uint64_t> missedFrames{0};
+
+    bool adoptRequest(Slot& slot);
+    bool fill(Slot& slot);
+    void workerLoop();
+};
@@ -0,0 +1,133 @@
+#include "SamplerNode.hpp"
+#include <algorithm>
+#include <cmath>
+
+void SamplerNode::setStreamer(SampleStreamer* s, int slotIndex) {
+    stop();
+    streamer = s;
+    slot = s ? s->getSlot(slotIndex) : nullptr;
+}
+
+void SamplerNode::prepare(double sr, int bs) {
+    DspNode::prepare(sr, bs);
+    updateStep();
+}
+
+void SamplerNode::updateStep() {
+    if (!sample) return;
+    double transpose = std::pow(2.0, (noteNumber - sample->getZone().rootNote) / 12.0);
+    baseStep = transpose * sample->getSampleRate() / sampleRate;
+}
+
+void SamplerNode::noteOn(int note, int velocity) {
+    stop();
+    if (!streamer) return;
+    sample = streamer->getLibrary().find(note, velocity);
+    if (!sample) return;
+    noteNumber = note;
+    position = 0.0;
+    updateStep();
+    startStream(sample->getPreloadFrames());
+}
+
+void SamplerNode::stop() {
+    if (sample && slot) requestId = slot->request(nullptr, 0);
+    sample = nullptr;
+    streamReady = false;
+}
+
+void SamplerNode::startStream(uint64_t frame) {
+    streamFirst = std::max<uint64_t>(frame, sample->getPreloadFrames());
+    streamReady = false;
+    if (streamFirst < sample->getNumFrames()) requestId = slot->request(sample, streamFirst);
+}
+
+void SamplerNode::advance(int frames) {
+    if (!sample) return;
+    position += baseStep * pitchRatio * frames;
+    if (position + 1.0 >= (double)sample->getNumFrames()) {
+        stop();
+        return;
+    }
+    if (position >= (double)sample->getPreloadFrames()) startStream((uint64_t)position);
+}
+
+// Ring frames before `frame` are no longer needed
+void SamplerNode::releaseBefore(size_t frame) {
+    if (streamReady && frame > streamFirst) slot->release(streamStart + (frame - streamFirst));
+}
+
+bool SamplerNode::fetch(size_t frame, uint64_t written, float& left, float& right) const {
+    if (frame < sample->getPreloadFrames()) {
+        left = sample->getPreload(0)[frame];
+        right = sample->getPreload(1)[frame];
+        return true;
+    }
+    if (!streamReady || frame < streamFirst) return false;
+    uint64_t index = streamStart + (frame - streamFirst);
+    if (index >= written) return false;
+    const float* f = slot->frameAt(index);
+    left = f[0];
+    right = f[1];
+    return true;
+}
+
+// Offline only: spins until the streamer has decoded `frame`
+bool SamplerNode::waitFor(size_t frame, uint64_t& written) {
+    while (true) {
+        if (!streamReady) streamReady = slot->isServing(requestId, streamStart);
+        if (streamReady) {
+            releaseBefore(frame > 0 ? frame - 1 : 0); // Make room for it
+            written = slot->getWriteIndex();
+            if (frame < streamFirst || streamStart + (frame - streamFirst) < written) return true;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void SamplerNode::process(DspBuffer& buffer) {
+    int frames = buffer.getNumFrames();
+    float* outL = buffer.getChannel(0);
+    float* outR = buffer.getNumChannels() > 1 ? buffer.getChannel(1) : outL;
+    if (!sample) {
+        std::fill(outL, outL + frames, 0.0f);
+        std::fill(outR, outR + frames, 0.0f);
+        return;
+    }
+
+    if (!streamReady) streamReady = slot->isServing(requestId, streamStart);
+    uint64_t written = streamReady ? slot->getWriteIndex() : 0;
+    size_t total = sample->getNumFrames();
+    double step = baseStep * pitchRatio;
+    int missed = 0;
+
+    int i = 0;
+    for (; i < frames; ++i) {
+        size_t i0 = (size_t)position;
+        if (i0 + 1 >= total) break;
+        float t = (float)(position - (double)i0);
+        float l0, r0, l1, r1;
+        bool ok = fetch(i0, written, l0, r0) && fetch(i0 + 1, written, l1, r1);
+        if (!ok && streamer->getWaitForData() && waitFor(i0 + 1, written)) {
+            ok = fetch(i0, written, l0, r0) && fetch(i0 + 1, written, l1, r1);
+        }
+        if (ok) {
+            outL[i] = l0 + t * (l1 - l0);
+            outR[i] = r0 + t * (r1 - r0);
+        } else {
+            outL[i] = outR[i] = 0.0f; // Never wait for disk on the audio thread
+            missed++;
+        }
+        position += step;
+    }
+    if (missed) streamer->countMiss(missed);
+
+    if (i < frames) {
+        // Ran off the end of the sample
+        std::fill(outL + i, outL + frames, 0.0f);
+        std::fill(outR + i, outR + frames, 0.0f);
+        stop();
+        return;
+    }
+    releaseBefore((size_t)position);
+}
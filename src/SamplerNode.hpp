@@ -0,0 +1,50 @@
+#pragma once
+#include "dsp/DspNode.hpp"
+#include "SampleStreamer.hpp"
+
+// Sample playback source for a voice, in place of the oscillator.
+//
+// Reads the sample's resident head straight away at note-on while the streamer
+// fills the voice's ring with the rest, so starting a note never waits for disk.
+// Frames are pitched by linear interpolation. If playback catches up with the
+// stream the missing frames play as silence and are counted on the streamer,
+// unless the streamer is set to wait (offline renders).
+class SamplerNode : public DspNode {
+public:
+    // nullptr detaches; the slot belongs to this node until detached
+    void setStreamer(SampleStreamer* s, int slotIndex);
+
+    void noteOn(int note, int velocity); // Silent if no zone covers the note
+    void stop();
+    bool isPlaying() const { return sample != nullptr; }
+
+    // Control-rate pitch modulation on top of the note's own transposition
+    void setPitchRatio(float ratio) { pitchRatio = ratio; }
+    // Skips ahead without rendering; restarts the stream at the new position
+    void advance(int frames);
+
+    void prepare(double sr, int bs) override;
+    void reset() override { stop(); }
+    void process(DspBuffer& buffer) override;
+    const char* getName() const override { return "SamplerNode"; }
+
+private:
+    SampleStreamer* streamer = nullptr;
+    SampleStreamer::Slot* slot = nullptr;
+    const Sample* sample = nullptr;
+    int noteNumber = 60;
+    double position = 0.0; // Source frames
+    double baseStep = 1.0; // Source frames per output frame before modulation
+    float pitchRatio = 1.0f;
+
+    uint32_t requestId = 0;
+    bool streamReady = false;
+    uint64_t streamStart = 0; // Ring index holding source frame streamFirst
+    uint64_t streamFirst = 0;
+
+    void updateStep();
+    void startStream(uint64_t frame);
+    void releaseBefore(size_t frame);
+    bool fetch(size_t frame, uint64_t written, float& left, float& right) const;
+    bool waitFor(size_t frame, uint64_t& written);
+};
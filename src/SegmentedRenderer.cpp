@@ -0,0 +1,273 @@
+#include "SegmentedRenderer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+SegmentedRenderer::SegmentedRenderer(double sampleRate, int numThreads)
+    : sampleRate(sampleRate), numThreads(numThreads) {
+    if (this->numThreads <= 0) this->numThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    preset = PresetManager::getFactoryPreset(0);
+}
+
+uint32_t SegmentedRenderer::effectTailFrames() const {
+    int tail = 0;
+    for (int b = 0; b < Voice::MAX_SENDS; ++b) {
+        if (preset.sendLevel[b] <= 0.0f) continue;
+        tail = std::max(tail, ModulatedDelay::tailFrames(preset.sendEffect[b], sampleRate));
+    }
+    return (uint32_t)tail;
+}
+
+// Skips leave the send buses empty, so the pre-roll is long enough for them to refill
+uint32_t SegmentedRenderer::prerollFrames() const {
+    return std::max((uint32_t)(prerollSeconds * sampleRate), effectTailFrames());
+}
+
+std::vector<RenderSegment> SegmentedRenderer::planSegments(const std::vector<MidiEvent>& events, uint32_t endSample) const {
+    // Find stretches where every voice is provably idle. A released voice is silent
+    // `release` seconds later, give or take the rounding of its envelope's float steps
+    // (a fraction of a percent on long releases); pad for that.
+    struct Interval { uint32_t from, to; };
+    std::vector<Interval> silent;
+    float release = preset.release;
+    uint32_t pad = 2;
+    if (preset.synthesisModel == 1) {
+        // FM voices last as long as their longest carrier release, stepped on the control
+        // grid and then ramped to zero over one more interval
+        int carriers = Fm::CARRIERS[std::max(0, std::min(preset.fm.algorithm, Fm::ALGORITHMS - 1))];
+        release = 0.0f;
+        for (int op = 0; op < Fm::OPERATORS; ++op) {
+            if ((carriers >> op) & 1) release = std::max(release, preset.fm.ops[op].release);
+        }
+        pad += 2 * FmVoiceBank::CONTROL_INTERVAL;
+    }
+    uint32_t releaseFrames = (uint32_t)std::ceil(release * sampleRate);
+    releaseFrames += releaseFrames / 128 + pad;
+    releaseFrames += effectTailFrames(); // Send effects keep ringing after the voices
+    int held[128] = {};
+    int heldTotal = 0;
+    uint32_t silentSince = 0;
+
+    for (const auto& e : events) {
+        bool isOn = e.type() == 0x90 && e.data2 > 0;
+        bool isOff = e.type() == 0x80 || (e.type() == 0x90 && e.data2 == 0);
+        if (e.type() == 0xB0 && (e.data1 == 120 || e.data1 == 123)) {
+            for (int& h : held) h = 0;
+            heldTotal = 0;
+            silentSince = std::max(silentSince, e.time + releaseFrames);
+            continue;
+        }
+        if (isOn) {
+            if (heldTotal == 0 && silentSince <= e.time) silent.push_back({ silentSince, e.time });
+            held[e.data1]++;
+            heldTotal++;
+        } else if (isOff) {
+            heldTotal -= held[e.data1];
+            held[e.data1] = 0;
+            // Note-offs retrigger the release of voices already fading out
+            if (heldTotal == 0) silentSince = std::max(silentSince, e.time + releaseFrames);
+        }
+    }
+    if (heldTotal == 0 && silentSince <= endSample) silent.push_back({ silentSince, endSample });
+
+    auto isSilentAt = [&](uint32_t p) {
+        for (const auto& s : silent) if (s.from <= p && p <= s.to) return true;
+        return false;
+    };
+
+    // Aim for a few segments per worker, capped at maxSegmentSeconds
+    uint32_t maxLength = (uint32_t)(maxSegmentSeconds * sampleRate);
+    uint32_t target = std::max<uint32_t>((uint32_t)sampleRate, endSample / (uint32_t)(numThreads * 2));
+    target = std::min(target, maxLength);
+
+    std::vector<uint32_t> mandatory = forcedSplits;
+    mandatory.push_back(endSample);
+    std::sort(mandatory.begin(), mandatory.end());
+
+    std::vector<uint32_t> splits;
+    uint32_t cursor = 0;
+    for (uint32_t boundary : mandatory) {
+        if (boundary <= cursor || boundary > endSample) continue;
+        while (boundary - cursor > target) {
+            // Prefer the latest silent point within reach, as long as it is not tiny
+            uint32_t limit = cursor + target;
+            uint32_t best = 0;
+            for (const auto& s : silent) {
+                if (s.to <= cursor || s.from > limit) continue;
+                best = std::max(best, std::min(s.to, limit));
+            }
+            uint32_t next = (best > cursor + target / 4) ? best : limit;
+            splits.push_back(next);
+            cursor = next;
+        }
+        if (boundary != endSample) splits.push_back(boundary);
+        cursor = boundary;
+    }
+
+    std::vector<RenderSegment> segments;
+    uint32_t preroll = prerollFrames();
+    uint32_t start = 0;
+    splits.push_back(endSample);
+    for (uint32_t end : splits) {
+        RenderSegment seg = { start, end, start };
+        if (!isSilentAt(start)) {
+            uint32_t warmStart = start > preroll ? start - preroll : 0;
+            seg.warmFrom = 0;
+            for (const auto& s : silent) {
+                if (s.from <= warmStart) seg.warmFrom = std::max(seg.warmFrom, std::min(s.to, warmStart));
+            }
+        }
+        segments.push_back(seg);
+        start = end;
+    }
+    return segments;
+}
+
+void SegmentedRenderer::renderSegment(SynthEngine& synth, DspBuffer& buffer, const std::vector<MidiEvent>& events,
+                                      const RenderSegment& segment, uint32_t endSample, SegmentOutput& out) const {
+    synth.reset();
+
+    uint32_t preroll = prerollFrames();
+    uint32_t warmStart = std::max(segment.warmFrom, segment.start > preroll ? segment.start - preroll : 0);
+    uint32_t stop = std::min<uint32_t>(segment.end + overlapFrames, endSample);
+
+    auto it = std::lower_bound(events.begin(), events.end(), segment.warmFrom,
+                               [](const MidiEvent& e, uint32_t t) { return e.time < t; });
+
+    // Controllers outlive silence (and reset()), so the latest of each before the silent
+    // point is carried in; the defaults cover the worker's previous segment
+    MidiEvent bend = { 0, 0xE0, 0x00, 0x40 }; // Centre
+    MidiEvent wheel = { 0, 0xB0, 1, 0 };
+    for (auto e = events.begin(); e != it; ++e) {
+        if (e->type() == 0xE0) bend = *e;
+        else if (e->type() == 0xB0 && e->data1 == 1) wheel = *e;
+    }
+    synth.handleMidiEvent(bend);
+    synth.handleMidiEvent(wheel);
+
+    // Step in the serial render's blocks (blockSize at a time from each event) so control
+    // intervals and effect LFOs land on the same frames. Blocks that end before the
+    // pre-roll are fast-forwarded (state only, no audio); the rest are rendered, and the
+    // pre-roll is discarded while the filters settle.
+    uint32_t pos = segment.warmFrom;
+    uint32_t anchor = it == events.begin() ? 0 : std::prev(it)->time;
+    out.left.reserve(stop - segment.start);
+    out.right.reserve(stop - segment.start);
+    while (pos < stop) {
+        for (; it != events.end() && it->time == pos; ++it) {
+            synth.handleMidiEvent(*it);
+            anchor = pos;
+        }
+
+        uint32_t next = std::min<uint32_t>(stop, anchor + ((pos - anchor) / blockSize + 1) * blockSize);
+        if (it != events.end()) next = std::min(next, it->time);
+        int frames = (int)(next - pos);
+        if (next <= warmStart) {
+            synth.skip(frames);
+            pos = next;
+            continue;
+        }
+
+        buffer.resize(2, frames);
+        synth.render(buffer);
+        if (next > segment.start) {
+            int from = (int)(std::max(pos, segment.start) - pos);
+            out.left.insert(out.left.end(), buffer.getChannel(0) + from, buffer.getChannel(0) + frames);
+            out.right.insert(out.right.end(), buffer.getChannel(1) + from, buffer.getChannel(1) + frames);
+        }
+        pos = next;
+    }
+}
+
+SegmentedStats SegmentedRenderer::render(const MidiFile& midi, WavWriter& writer) {
+    SegmentedStats stats;
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<MidiEvent> events;
+    MidiFileReader reader(midi, sampleRate);
+    MidiEvent event;
+    while (reader.next(event)) events.push_back(event);
+    uint32_t endSample = reader.getEndSample() + (uint32_t)(tailSeconds * sampleRate);
+
+    stats.segments = planSegments(events, endSample);
+    size_t count = stats.segments.size();
+    std::vector<SegmentOutput> outputs(count);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<size_t> nextSegment{0};
+    size_t written = 0;
+    // Bound memory: workers may run at most this many segments ahead of the writer
+    size_t window = (size_t)numThreads * 2;
+
+    auto worker = [&]() {
+        SynthEngine synth;
+        synth.setSampleRate(sampleRate);
+        PresetManager::applyPreset(preset, synth);
+        DspBuffer buffer(2, blockSize);
+
+        for (size_t i = nextSegment++; i < count; i = nextSegment++) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return i < written + window; });
+            }
+            renderSegment(synth, buffer, events, stats.segments[i], endSample, outputs[i]);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                outputs[i].done = true;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::min<int>(numThreads, (int)count); ++t) threads.emplace_back(worker);
+
+    // Write segments in order, checking each seam against the previous overlap
+    std::vector<float> prevLeft, prevRight;
+    for (size_t i = 0; i < count; ++i) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return outputs[i].done; });
+        }
+        const RenderSegment& seg = stats.segments[i];
+        SegmentOutput& out = outputs[i];
+        size_t body = seg.end - seg.start;
+
+        if (i > 0) {
+            SeamReport seam = { seg.start, seg.silentStart(), 0.0f };
+            size_t n = std::min(prevLeft.size(), out.left.size());
+            for (size_t k = 0; k < n; ++k) {
+                seam.maxError = std::max(seam.maxError, std::abs(prevLeft[k] - out.left[k]));
+                seam.maxError = std::max(seam.maxError, std::abs(prevRight[k] - out.right[k]));
+            }
+            if (seam.maxError > tolerance) stats.seamsOk = false;
+            stats.seams.push_back(seam);
+        }
+
+        float* channels[2] = { out.left.data(), out.right.data() };
+        writer.write(channels, (int)body);
+        prevLeft.assign(out.left.begin() + body, out.left.end());
+        prevRight.assign(out.right.begin() + body, out.right.end());
+        out = SegmentOutput();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            written = i + 1;
+        }
+        cv.notify_all();
+    }
+    for (auto& t : threads) t.join();
+    writer.close();
+
+    stats.ok = true;
+    stats.frames = endSample;
+    stats.audioSeconds = endSample / sampleRate;
+    stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
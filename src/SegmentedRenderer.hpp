@@ -0,0 +1,82 @@
+#pragma once
+#include "SynthEngine.hpp"
+#include "PresetManager.hpp"
+#include "MidiFile.hpp"
+#include "OfflineRenderer.hpp"
+#include "WavFile.hpp"
+#include <vector>
+
+struct RenderSegment {
+    uint32_t start;
+    uint32_t end;
+    uint32_t warmFrom; // Latest point before the pre-roll where the engine is provably silent
+
+    bool silentStart() const { return warmFrom == start; } // No warm-up needed
+};
+
+struct SeamReport {
+    uint32_t position;
+    bool silent;
+    float maxError; // Largest difference between the two renders of the overlap
+};
+
+struct SegmentedStats : RenderStats {
+    std::vector<RenderSegment> segments;
+    std::vector<SeamReport> seams;
+    // Every seam is within tolerance. This only compares each segment's overlap with the
+    // next segment's head: state that both sides get equally wrong (a controller or glide
+    // not carried over, a skip that misses some modulation) still passes. Only a serial
+    // render shows that.
+    bool seamsOk = true;
+};
+
+// Renders one long timeline as independent segments on worker threads.
+//
+// Segments start either where every voice is silent (a fresh engine reproduces
+// serial output exactly) or at forced points. Forced points are warmed up by
+// fast-forwarding voices from the last silent point with SynthEngine::skip and
+// then rendering a discarded pre-roll so the filters settle and the send effects
+// fill back up (the pre-roll is at least as long as their tails). Both step in the
+// serial render's blocks, so control-rate modulation lands on the same frames.
+// Each segment also renders `overlapFrames` past its end; the overlap is compared
+// against the next segment's head to check the seam.
+class SegmentedRenderer {
+public:
+    SegmentedRenderer(double sampleRate = 44100.0, int numThreads = 0); // 0 = all cores
+
+    void setPreset(const Preset& p) { preset = p; }
+    void setTailSeconds(double seconds) { tailSeconds = seconds; }
+    void setPrerollSeconds(double seconds) { prerollSeconds = seconds; } // At least the send effects' tails
+    void setOverlapFrames(int frames) { overlapFrames = frames; }
+    void setTolerance(float t) { tolerance = t; }
+    // Upper bound on segment length; longer stretches without silence get forced splits
+    void setMaxSegmentSeconds(double seconds) { maxSegmentSeconds = seconds; }
+    void setSplitPoints(const std::vector<uint32_t>& points) { forcedSplits = points; }
+
+    SegmentedStats render(const MidiFile& midi, WavWriter& writer);
+
+    // Split plan for an event list (exposed for tests and tooling)
+    std::vector<RenderSegment> planSegments(const std::vector<MidiEvent>& events, uint32_t endSample) const;
+
+private:
+    double sampleRate;
+    int numThreads;
+    int blockSize = 512;
+    double tailSeconds = 2.0;
+    double prerollSeconds = 0.25;
+    double maxSegmentSeconds = 30.0;
+    int overlapFrames = 256;
+    float tolerance = 1e-4f;
+    Preset preset;
+    std::vector<uint32_t> forcedSplits;
+
+    struct SegmentOutput {
+        std::vector<float> left, right; // Segment body followed by the overlap
+        bool done = false;
+    };
+
+    uint32_t effectTailFrames() const; // Longest send effect decay, 0 with no sends
+    uint32_t prerollFrames() const;
+    void renderSegment(SynthEngine& synth, DspBuffer& buffer, const std::vector<MidiEvent>& events,
+                       const RenderSegment& segment, uint32_t endSample, SegmentOutput& out) const;
+};
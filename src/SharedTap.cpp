@@ -0,0 +1,267 @@
+#include "SharedTap.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char MAGIC[8] = { 'R', 'X', 'T', 'A', 'P', 0, 0, 0 };
+
+static uint32_t powerOfTwo(int n) {
+    uint32_t size = 1;
+    while (size < (uint32_t)std::max(n, 2)) size <<= 1;
+    return size;
+}
+
+static size_t alignUp(size_t n) {
+    return (n + 63) & ~(size_t)63;
+}
+
+// Byte offsets of the block ring and the sample rings, and the whole size
+static size_t blocksOffset() {
+    return alignUp(sizeof(SharedTapHeader));
+}
+
+static size_t ringsOffset(uint32_t blockCapacity) {
+    return alignUp(blocksOffset() + blockCapacity * sizeof(SharedTapBlock));
+}
+
+static size_t regionSize(uint32_t channels, uint32_t capacity, uint32_t blockCapacity) {
+    return ringsOffset(blockCapacity) + (size_t)channels * capacity * sizeof(float);
+}
+
+bool SharedTap::open(const std::string& tapName, int channels, double sampleRate, int capacityFrames, int blockCount) {
+    close();
+    if (channels < 1 || channels > SharedTapBlock::MAX_CHANNELS) {
+        error = "unsupported channel count";
+        return false;
+    }
+    uint32_t capacity = powerOfTwo(capacityFrames);
+    uint32_t blockCapacity = powerOfTwo(blockCount);
+    size_t bytes = regionSize((uint32_t)channels, capacity, blockCapacity);
+
+    // Always a new object, so readers of a previous one notice it is gone
+    shm_unlink(tapName.c_str());
+    int fd = shm_open(tapName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        error = "cannot create shared memory " + tapName + ": " + std::strerror(errno);
+        return false;
+    }
+    void* region = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0) region = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (region == MAP_FAILED) {
+        error = "cannot map shared memory " + tapName + ": " + std::strerror(errno);
+        shm_unlink(tapName.c_str());
+        return false;
+    }
+    std::memset(region, 0, bytes); // Touches every page, so the audio thread never faults one in
+
+    header = new (region) SharedTapHeader();
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+    header->version = VERSION;
+    header->channels = (uint32_t)channels;
+    header->capacity = capacity;
+    header->blockCapacity = blockCapacity;
+    header->sampleRate = sampleRate;
+    blocks = (SharedTapBlock*)((char*)region + blocksOffset());
+    rings = (float*)((char*)region + ringsOffset(blockCapacity));
+    size = bytes;
+    name = tapName;
+    pending = {};
+    std::fill(sumSquares, sumSquares + SharedTapBlock::MAX_CHANNELS, 0.0);
+    error.clear();
+    header->live.store(1, std::memory_order_release);
+    return true;
+}
+
+void SharedTap::close() {
+    if (!header) return;
+    header->live.store(0, std::memory_order_release);
+    munmap(header, size);
+    shm_unlink(name.c_str());
+    header = nullptr;
+    blocks = nullptr;
+    rings = nullptr;
+}
+
+void SharedTap::write(const float* const* channels, int frames) {
+    if (!header || frames <= 0) return;
+    uint32_t capacity = header->capacity;
+    int numChannels = (int)header->channels;
+    // Only the newest lap of a longer write survives
+    int skipped = std::max(0, frames - (int)capacity);
+    uint64_t w = header->writeFrame.load(std::memory_order_relaxed) + skipped;
+    int count = frames - skipped;
+
+    header->reserveFrame.store(w + count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // Announced before any sample changes
+    uint32_t start = (uint32_t)(w & (capacity - 1));
+    int first = std::min(count, (int)(capacity - start));
+    for (int c = 0; c < numChannels; ++c) {
+        const float* in = channels[c] + skipped;
+        float* ring = rings + (size_t)c * capacity;
+        std::memcpy(ring + start, in, first * sizeof(float));
+        std::memcpy(ring, in + first, (count - first) * sizeof(float));
+
+        float peak = pending.peak[c];
+        double sum = 0.0;
+        for (int i = 0; i < frames; ++i) {
+            float v = channels[c][i];
+            peak = std::max(peak, std::abs(v));
+            sum += (double)v * v;
+        }
+        pending.peak[c] = peak;
+        sumSquares[c] += sum;
+    }
+    header->writeFrame.store(w + count, std::memory_order_release);
+    pending.frames += frames;
+}
+
+void SharedTap::endBlock(float load, uint64_t lateCallbacks) {
+    if (!header) return;
+    uint64_t frame = header->writeFrame.load(std::memory_order_relaxed);
+    pending.frame = frame - pending.frames;
+    pending.load = load;
+    pending.lateCallbacks = lateCallbacks;
+    for (int c = 0; c < (int)header->channels; ++c) {
+        pending.rms[c] = pending.frames > 0 ? (float)std::sqrt(sumSquares[c] / pending.frames) : 0.0f;
+    }
+
+    uint64_t b = header->writeBlock.load(std::memory_order_relaxed);
+    header->reserveBlock.store(b + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    blocks[b & (header->blockCapacity - 1)] = pending;
+    header->writeBlock.store(b + 1, std::memory_order_release);
+
+    pending = {};
+    std::fill(sumSquares, sumSquares + SharedTapBlock::MAX_CHANNELS, 0.0);
+}
+
+bool SharedTapReader::open(const std::string& tapName) {
+    close();
+    int fd = shm_open(tapName.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        error = "no shared tap " + tapName + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    void* region = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SharedTapHeader)) {
+        region = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (region == MAP_FAILED) {
+        error = "cannot map shared tap " + tapName;
+        return false;
+    }
+    const SharedTapHeader* h = (const SharedTapHeader*)region;
+    bool ready = h->live.load(std::memory_order_acquire) == 1;
+    if (!ready || std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) || h->version != SharedTap::VERSION ||
+        h->channels < 1 || h->channels > (uint32_t)SharedTapBlock::MAX_CHANNELS ||
+        regionSize(h->channels, h->capacity, h->blockCapacity) > (size_t)st.st_size) {
+        error = ready ? tapName + " is not a compatible shared tap" : tapName + " is not live";
+        munmap(region, (size_t)st.st_size);
+        return false;
+    }
+    header = h;
+    blocks = (const SharedTapBlock*)((const char*)region + blocksOffset());
+    rings = (const float*)((const char*)region + ringsOffset(h->blockCapacity));
+    size = (size_t)st.st_size;
+    inode = (uint64_t)st.st_ino;
+    name = tapName;
+    lostFrames = 0;
+    lostBlocks = 0;
+    error.clear();
+    return true;
+}
+
+void SharedTapReader::close() {
+    if (!header) return;
+    munmap((void*)header, size);
+    header = nullptr;
+    blocks = nullptr;
+    rings = nullptr;
+}
+
+bool SharedTapReader::isLive() const {
+    if (!header || header->live.load(std::memory_order_acquire) != 1) return false;
+    // The publisher may have closed and a new one taken the name
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    bool same = fstat(fd, &st) == 0 && (uint64_t)st.st_ino == inode;
+    ::close(fd);
+    return same;
+}
+
+uint64_t SharedTapReader::firstValid() const {
+    std::atomic_thread_fence(std::memory_order_acquire); // After the reads it vouches for
+    uint64_t reserved = header->reserveFrame.load(std::memory_order_relaxed);
+    return reserved > header->capacity ? reserved - header->capacity : 0;
+}
+
+int SharedTapReader::read(uint64_t& cursor, float* const* out, int maxFrames) {
+    if (!header) return 0;
+    uint64_t end = getWriteFrame();
+    uint64_t oldest = firstValid();
+    if (cursor < oldest) {
+        lostFrames += oldest - cursor;
+        cursor = oldest;
+    }
+    if (cursor > end) cursor = end; // A cursor from another session
+    int count = (int)std::min<uint64_t>(end - cursor, (uint64_t)std::max(0, maxFrames));
+    uint32_t capacity = header->capacity;
+    uint32_t start = (uint32_t)(cursor & (capacity - 1));
+    int first = std::min(count, (int)(capacity - start));
+    for (int c = 0; c < getChannels(); ++c) {
+        std::memcpy(out[c], channel(c) + start, first * sizeof(float));
+        std::memcpy(out[c] + first, channel(c), (count - first) * sizeof(float));
+    }
+
+    // Drop whatever the publisher started overwriting while we copied
+    oldest = firstValid();
+    if (cursor < oldest) {
+        int torn = (int)std::min<uint64_t>(oldest - cursor, (uint64_t)count);
+        for (int c = 0; c < getChannels(); ++c) std::memmove(out[c], out[c] + torn, (count - torn) * sizeof(float));
+        lostFrames += torn;
+        cursor += torn;
+        count -= torn;
+    }
+    cursor += count;
+    return count;
+}
+
+int SharedTapReader::readBlocks(uint64_t& cursor, SharedTapBlock* out, int maxBlocks) {
+    if (!header) return 0;
+    uint32_t capacity = header->blockCapacity;
+    auto firstBlock = [&] {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t reserved = header->reserveBlock.load(std::memory_order_relaxed);
+        return reserved > capacity ? reserved - capacity : 0;
+    };
+    uint64_t end = getBlockCount();
+    uint64_t oldest = firstBlock();
+    if (cursor < oldest) {
+        lostBlocks += oldest - cursor;
+        cursor = oldest;
+    }
+    if (cursor > end) cursor = end;
+    int count = (int)std::min<uint64_t>(end - cursor, (uint64_t)std::max(0, maxBlocks));
+    for (int i = 0; i < count; ++i) out[i] = blocks[(cursor + i) & (capacity - 1)];
+
+    oldest = firstBlock();
+    if (cursor < oldest) {
+        int torn = (int)std::min<uint64_t>(oldest - cursor, (uint64_t)count);
+        std::copy(out + torn, out + count, out);
+        lostBlocks += torn;
+        cursor += torn;
+        count -= torn;
+    }
+    cursor += count;
+    return count;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Master output published to other processes through POSIX shared memory: level meters,
+// loudness loggers, spectrum dashboards. One publisher (the audio thread) writes a planar
+// sample ring and a ring of per-block stats; any number of readers map the region
+// read-only and follow along at their own pace. The publisher never waits on or even
+// sees its readers: a reader that falls a lap behind loses the overwritten frames, and
+// can tell exactly which ones.
+//
+// Both rings are seqlocks: the publisher announces how far it is about to write, writes,
+// then publishes. A reader checks the announcement after copying to know what it copied
+// was not being overwritten. This file and SharedTap.cpp are all a reader needs.
+
+struct SharedTapBlock {
+    static const int MAX_CHANNELS = 8;
+    uint64_t frame;          // First frame of the block on the tap's timeline
+    uint32_t frames;
+    float load;              // Time the block took over its deadline
+    uint64_t lateCallbacks;  // Blocks that overran, so far
+    float peak[MAX_CHANNELS];
+    float rms[MAX_CHANNELS];
+};
+
+// At the start of the region; the block ring and then one ring per channel follow
+struct SharedTapHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t capacity;      // Frames per channel, a power of two
+    uint32_t blockCapacity; // Also a power of two
+    double sampleRate;
+    std::atomic<uint32_t> live;          // Set once the header is filled in; cleared on close
+    std::atomic<uint64_t> reserveFrame;  // Frames below this may be being written
+    std::atomic<uint64_t> writeFrame;    // Frames below this are published
+    std::atomic<uint64_t> reserveBlock;
+    std::atomic<uint64_t> writeBlock;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the counters are shared between processes");
+
+class SharedTap {
+public:
+    static const uint32_t VERSION = 1;
+    static constexpr const char* DEFAULT_NAME = "/rx-master";
+
+    SharedTap() = default;
+    ~SharedTap() { close(); }
+    SharedTap(const SharedTap&) = delete;
+    SharedTap& operator=(const SharedTap&) = delete;
+
+    // Control thread: creates (or takes over) the region and touches every page of it.
+    // capacityFrames and blocks are rounded up to powers of two
+    bool open(const std::string& name, int channels, double sampleRate, int capacityFrames = 1 << 16, int blocks = 1024);
+    void close(); // Readers see the tap go dead; the name is removed
+    bool isOpen() const { return header != nullptr; }
+    const std::string& getError() const { return error; }
+
+    // Audio thread, wait-free. Planar input; levels add up until endBlock()
+    void write(const float* const* channels, int frames);
+    void endBlock(float load, uint64_t lateCallbacks);
+
+private:
+    SharedTapHeader* header = nullptr;
+    SharedTapBlock* blocks = nullptr;
+    float* rings = nullptr;
+    size_t size = 0;
+    std::string name;
+    std::string error;
+
+    SharedTapBlock pending = {}; // The block being accumulated
+    double sumSquares[SharedTapBlock::MAX_CHANNELS] = {};
+};
+
+// Follows a SharedTap from another process. Not thread-safe; one per reading thread.
+class SharedTapReader {
+public:
+    SharedTapReader() = default;
+    ~SharedTapReader() { close(); }
+    SharedTapReader(const SharedTapReader&) = delete;
+    SharedTapReader& operator=(const SharedTapReader&) = delete;
+
+    bool open(const std::string& name = SharedTap::DEFAULT_NAME);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+    bool isLive() const; // False once the publisher has closed or restarted elsewhere
+    const std::string& getError() const { return error; }
+
+    int getChannels() const { return (int)header->channels; }
+    double getSampleRate() const { return header->sampleRate; }
+    int getCapacity() const { return (int)header->capacity; }
+
+    // Zero-copy access to the ring itself: frame f of channel c is at
+    // channel(c)[f & (getCapacity() - 1)] for f from firstValid() up to getWriteFrame().
+    // Anything read that way is only known good if it is still >= firstValid() afterwards.
+    const float* channel(int c) const { return rings + (size_t)c * header->capacity; }
+    uint64_t getWriteFrame() const { return header->writeFrame.load(std::memory_order_acquire); }
+    uint64_t firstValid() const;
+
+    // Copies frames from `cursor` on and advances it; returns the number copied. A cursor
+    // the publisher has lapped jumps to the oldest frame still there, counting the loss.
+    int read(uint64_t& cursor, float* const* out, int maxFrames);
+    // Same for block stats; the cursor counts blocks
+    int readBlocks(uint64_t& cursor, SharedTapBlock* out, int maxBlocks);
+    uint64_t getBlockCount() const { return header->writeBlock.load(std::memory_order_acquire); }
+
+    uint64_t getLostFrames() const { return lostFrames; }
+    uint64_t getLostBlocks() const { return lostBlocks; }
+
+private:
+    const SharedTapHeader* header = nullptr;
+    const SharedTapBlock* blocks = nullptr;
+    const float* rings = nullptr;
+    size_t size = 0;
+    uint64_t inode = 0; // To notice a publisher that recreated the region
+    std::string name;
+    std::string error;
+    uint64_t lostFrames = 0;
+    uint64_t lostBlocks = 0;
+};
@@ -1,25 +1,93 @@
 #include "SynthEngine.hpp"
+#include "Trace.hpp"
+#include "dsp/VectorOps.hpp"
+#include <algorithm>
 
 SynthEngine::SynthEngine() {
 }
 
+void SynthEngine::setEventLog(EventLog* log) {
+    eventLog = log;
+    if (!log) return;
+    EventRecord begin = {};
+    begin.frame = getPosition();
+    begin.kind = EventKind::Begin;
+    begin.value = (float)sampleRate;
+    log->write(&begin, 1);
+}
+
+void SynthEngine::logFrames(EventKind kind, int frames, int channels) {
+    if (!eventLog) return;
+    EventRecord record = {};
+    record.frame = getPosition();
+    record.kind = kind;
+    record.index = (uint8_t)channels;
+    record.data = (uint32_t)frames;
+    eventLog->write(&record, 1);
+}
+
 void SynthEngine::setSampleRate(double sr) {
+    log(EventCall::SampleRate, { (float)sr });
     for (int i = 0; i < MAX_VOICES; ++i) {
         voices[i].setSampleRate(sr);
     }
+    fm.setSampleRate(sr);
+    sampleRate = sr;
+    for (auto& bus : sends) {
+        bus.effect.prepare(sr, 1024);
+        bus.tailRemaining = 0;
+    }
+}
+
+void SynthEngine::reset() {
+    log(EventCall::Reset);
+    resetImpl();
+}
+
+void SynthEngine::resetImpl() {
+    lastNote = -1;
+    appliedVolume = masterVolume; // Nothing to fade from
+    for (int i = 0; i < MAX_VOICES; ++i) {
+        voices[i].reset();
+    }
+    fm.reset();
+    for (auto& bus : sends) {
+        bus.effect.reset();
+        bus.tailRemaining = 0;
+    }
+    if (reverb) reverb->reset();
 }
 
 void SynthEngine::noteOn(int note, int velocity) {
+    log(EventCall::NoteOn, { (float)note, (float)velocity });
+    noteOnImpl(note, velocity);
+}
+
+void SynthEngine::noteOnImpl(int note, int velocity) {
+    // Glides only follow a note that is still sounding, so a note after silence plays
+    // the same whatever came before it
+    int from = voicesActive() ? lastNote : -1;
+    lastNote = note;
+    if (synthesisModel == 1) {
+        fm.noteOn(note, velocity);
+        return;
+    }
     for (int i = 0; i < MAX_VOICES; ++i) {
         if (!voices[i].isActive()) {
-            voices[i].noteOn(note, velocity);
+            voices[i].noteOn(note, velocity, from);
             return;
         }
     }
-    voices[0].noteOn(note, velocity);
+    voices[0].noteOn(note, velocity, from);
 }
 
 void SynthEngine::noteOff(int note) {
+    log(EventCall::NoteOff, { (float)note });
+    noteOffImpl(note);
+}
+
+void SynthEngine::noteOffImpl(int note) {
+    fm.noteOff(note);
     for (int i = 0; i < MAX_VOICES; ++i) {
         if (voices[i].isActive() && voices[i].getNoteNumber() == note) {
             voices[i].noteOff();
@@ -27,44 +95,214 @@ void SynthEngine::noteOff(int note) {
     }
 }
 
+void SynthEngine::handleMidiEvent(const MidiEvent& event) {
+    if (eventLog) {
+        EventRecord record = {};
+        record.frame = getPosition();
+        record.kind = EventKind::Midi;
+        record.data = event.status | (uint32_t)event.data1 << 8 | (uint32_t)event.data2 << 16;
+        eventLog->write(&record, 1);
+    }
+    uint8_t type = event.type();
+    if (type == 0x90 && event.data2 > 0) {
+        noteOnImpl(event.data1, event.data2);
+    } else if (type == 0x80 || type == 0x90) {
+        noteOffImpl(event.data1); // Velocity 0 is often Note Off
+    } else if (type == 0xB0) {
+        if (event.data1 == 1) setModWheelImpl(event.data2 / 127.0f);
+        else if (event.data1 == 120) resetImpl();       // All Sound Off
+        else if (event.data1 == 123) allNotesOffImpl(); // All Notes Off
+    } else if (type == 0xE0) {
+        // 14-bit, centre 8192
+        setPitchBendImpl((((event.data2 << 7) | event.data1) - 8192) / 8192.0f);
+    }
+}
+
+void SynthEngine::allNotesOff() {
+    log(EventCall::AllNotesOff);
+    allNotesOffImpl();
+}
+
+void SynthEngine::allNotesOffImpl() {
+    fm.allNotesOff();
+    for (int i = 0; i < MAX_VOICES; ++i) {
+        if (voices[i].isActive()) voices[i].noteOff();
+    }
+}
+
 void SynthEngine::render(DspBuffer& outputBuffer) {
+    RX_TRACE_SCOPE("SynthEngine::render");
     outputBuffer.clear();
     int numFrames = outputBuffer.getNumFrames();
+    logFrames(EventKind::Render, numFrames, outputBuffer.getNumChannels());
+    applyUnison();
     
     // We'll use a temporary buffer for each voice to mix into the main one
-    static DspBuffer voiceBuffer(2, 1024);
     voiceBuffer.resize(2, numFrames);
+
+    bool busFed[Voice::MAX_SENDS] = {};
+    for (int b = 0; b < Voice::MAX_SENDS; ++b) {
+        if (sends[b].effect.isConfigured()) {
+            sends[b].buffer.resize(2, numFrames);
+            sends[b].buffer.clear();
+        }
+    }
     
+    if (profiler) {
+        int sounding = 0;
+        for (int v = 0; v < MAX_VOICES; ++v) sounding += voices[v].isActive() ? 1 : 0;
+        profiler->setVoiceCount(sounding);
+    }
+
+    // Every FM voice in one pass
+    if (fm.isActive()) {
+        {
+            PerfScope oscillators(profiler, PerfStage::Oscillator);
+            fm.render(voiceBuffer);
+        }
+        PerfScope mix(profiler, PerfStage::Mix);
+        outputBuffer.add(voiceBuffer);
+        for (int b = 0; b < Voice::MAX_SENDS; ++b) {
+            if (fmSendLevel[b] > 0.0f && sends[b].effect.isConfigured()) {
+                sends[b].buffer.add(voiceBuffer, fmSendLevel[b]);
+                busFed[b] = true;
+            }
+        }
+    }
+
     for (int v = 0; v < MAX_VOICES; ++v) {
         if (voices[v].isActive()) {
             voiceBuffer.clear();
-            voices[v].render(voiceBuffer);
+            {
+                RX_TRACE_SCOPE_ARG("Voice::render", v);
+                voices[v].render(voiceBuffer);
+            }
+            PerfScope mix(profiler, PerfStage::Mix);
             outputBuffer.add(voiceBuffer);
+            for (int b = 0; b < Voice::MAX_SENDS; ++b) {
+                float level = voices[v].getSendLevel(b);
+                if (level > 0.0f && sends[b].effect.isConfigured()) {
+                    sends[b].buffer.add(voiceBuffer, level);
+                    busFed[b] = true;
+                }
+            }
         }
     }
+
+    // Send effects, master gain and reverb
+    PerfScope output(profiler, PerfStage::Output);
+
+    // One effect pass per bus, however many voices feed it
+    for (int b = 0; b < Voice::MAX_SENDS; ++b) {
+        SendBus& bus = sends[b];
+        if (busFed[b]) bus.tailRemaining = bus.effect.getTailFrames() + numFrames;
+        if (bus.tailRemaining <= 0) continue;
+        RX_TRACE_SCOPE_ARG(bus.effect.getName(), b);
+        bus.effect.process(bus.buffer);
+        outputBuffer.add(bus.buffer);
+        bus.tailRemaining -= numFrames;
+        if (bus.tailRemaining <= 0) bus.effect.reset(); // Drop what is left of the decay
+    }
     
-    // Global Volume / Limiting
+    // Global volume, ramped across the block when it changed
     float* outL = outputBuffer.getChannel(0);
     float* outR = outputBuffer.getChannel(1);
-    for (int i = 0; i < numFrames; ++i) {
-        outL[i] *= masterVolume;
-        outR[i] *= masterVolume;
+    if (appliedVolume == masterVolume) {
+        VectorOps::scale(outL, masterVolume, numFrames);
+        VectorOps::scale(outR, masterVolume, numFrames);
+    } else {
+        float step = (masterVolume - appliedVolume) / numFrames;
+        VectorOps::scaleRamp(outL, appliedVolume, step, numFrames);
+        VectorOps::scaleRamp(outR, appliedVolume, step, numFrames);
+        appliedVolume = masterVolume;
     }
+    
+    if (reverb) {
+        RX_TRACE_SCOPE("ConvolutionReverb::process");
+        reverb->process(outputBuffer);
+    }
+    position.fetch_add(numFrames, std::memory_order_relaxed);
+}
+
+// The send buses keep their LFO phase and tail countdown but not their audio;
+// a pre-roll as long as their tails refills them
+void SynthEngine::skip(int frames) {
+    logFrames(EventKind::Skip, frames);
+    applyUnison();
+    position.fetch_add(frames, std::memory_order_relaxed);
+
+    bool busFed[Voice::MAX_SENDS] = {};
+    for (int b = 0; b < Voice::MAX_SENDS; ++b) {
+        if (!sends[b].effect.isConfigured()) continue;
+        busFed[b] = fm.isActive() && fmSendLevel[b] > 0.0f;
+        for (int v = 0; v < MAX_VOICES && !busFed[b]; ++v) {
+            busFed[b] = voices[v].isActive() && voices[v].getSendLevel(b) > 0.0f;
+        }
+    }
+
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        if (voices[v].isActive()) voices[v].skip(frames);
+    }
+    if (fm.isActive()) fm.skip(frames);
+
+    for (int b = 0; b < Voice::MAX_SENDS; ++b) {
+        SendBus& bus = sends[b];
+        if (busFed[b]) bus.tailRemaining = bus.effect.getTailFrames() + frames;
+        if (bus.tailRemaining <= 0) continue;
+        bus.effect.advance(frames);
+        bus.tailRemaining -= frames;
+        if (bus.tailRemaining <= 0) bus.effect.reset();
+    }
+}
+
+bool SynthEngine::voicesActive() const {
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        if (voices[v].isActive()) return true;
+    }
+    return fm.isActive();
+}
+
+bool SynthEngine::isSilent() const {
+    if (voicesActive()) return false;
+    for (const auto& bus : sends) {
+        if (bus.tailRemaining > 0) return false;
+    }
+    return true;
+}
+
+void SynthEngine::setProfiler(PerfProfiler* p) {
+    profiler = p;
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setProfiler(p);
+}
+
+bool SynthEngine::allocateFrom(RealtimeArena& arena) {
+    bool ok = voiceBuffer.allocateFrom(arena, MAX_BLOCK);
+    for (auto& bus : sends) ok = bus.buffer.allocateFrom(arena, MAX_BLOCK) && ok;
+    for (int i = 0; i < MAX_VOICES; ++i) ok = voices[i].allocateFrom(arena) && ok;
+    return ok;
 }
 
 void SynthEngine::setFilterCutoff(float cutoff) {
+    log(EventCall::Cutoff, { cutoff });
     for (int i = 0; i < MAX_VOICES; ++i) voices[i].setFilterCutoff(cutoff);
 }
 
 void SynthEngine::setFilterResonance(float res) {
+    log(EventCall::Resonance, { res });
     for (int i = 0; i < MAX_VOICES; ++i) voices[i].setFilterResonance(res);
 }
 
 void SynthEngine::setEnvelopeParams(float a, float d, float s, float r) {
+    log(EventCall::Envelope, { a, d, s, r });
+    envelope[0] = a;
+    envelope[1] = d;
+    envelope[2] = s;
+    envelope[3] = r;
     for (int i = 0; i < MAX_VOICES; ++i) voices[i].setEnvelopeParams(a, d, s, r);
 }
 
 void SynthEngine::setWaveform(int waveformIndex) {
+    log(EventCall::Waveform, { (float)waveformIndex });
     Waveform w = Waveform::Saw;
     if (waveformIndex == 0) w = Waveform::Sine;
     else if (waveformIndex == 1) w = Waveform::Triangle;
@@ -73,3 +311,134 @@ void SynthEngine::setWaveform(int waveformIndex) {
     
     for (int i = 0; i < MAX_VOICES; ++i) voices[i].setWaveform(w);
 }
+
+void SynthEngine::setFilterType(int typeIndex) {
+    log(EventCall::FilterType, { (float)typeIndex });
+    FilterType t = FilterType::LowPass;
+    if (typeIndex == 1) t = FilterType::HighPass;
+    else if (typeIndex == 2) t = FilterType::BandPass;
+    
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setFilterType(t);
+}
+
+void SynthEngine::setUnison(int count, float detune, float spread) {
+    log(EventCall::Unison, { (float)count, detune, spread });
+    uint32_t seq = unisonRequest.sequence.load(std::memory_order_relaxed);
+    unisonRequest.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    unisonRequest.count.store(count, std::memory_order_relaxed);
+    unisonRequest.detune.store(detune, std::memory_order_relaxed);
+    unisonRequest.spread.store(spread, std::memory_order_relaxed);
+    unisonRequest.sequence.store(seq + 2, std::memory_order_release);
+}
+
+// Rendering thread: swaps the voices' graph nodes while nothing is processing them
+void SynthEngine::applyUnison() {
+    uint32_t seq = unisonRequest.sequence.load(std::memory_order_acquire);
+    if ((seq & 1) || seq == unisonApplied) return;
+    int count = unisonRequest.count.load(std::memory_order_relaxed);
+    float detune = unisonRequest.detune.load(std::memory_order_relaxed);
+    float spread = unisonRequest.spread.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (unisonRequest.sequence.load(std::memory_order_relaxed) != seq) return; // Torn; next block
+    unisonApplied = seq;
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setUnison(count, detune, spread);
+}
+
+void SynthEngine::setModulation(const ModSettings& settings) {
+    if (eventLog) {
+        float args[EventLog::MAX_ARGS];
+        eventLog->call(getPosition(), EventCall::Modulation, args, EventLog::packModulation(settings, args));
+    }
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setModulation(settings);
+}
+
+void SynthEngine::setModWheel(float value) {
+    log(EventCall::ModWheel, { value });
+    setModWheelImpl(value);
+}
+
+void SynthEngine::setModWheelImpl(float value) {
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setModWheel(value);
+}
+
+void SynthEngine::setPitchBend(float value) {
+    log(EventCall::PitchBend, { value });
+    setPitchBendImpl(value);
+}
+
+void SynthEngine::setPitchBendImpl(float value) {
+    pitchBend = std::max(-1.0f, std::min(1.0f, value));
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setPitchBend(pitchBend * bendRange);
+    fm.setPitchBend(pitchBend * bendRange);
+}
+
+void SynthEngine::setPitchBendRange(float semitones) {
+    log(EventCall::BendRange, { semitones });
+    bendRange = std::max(0.0f, semitones);
+    setPitchBendImpl(pitchBend);
+}
+
+void SynthEngine::setPortamento(float seconds) {
+    log(EventCall::Portamento, { seconds });
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setPortamento(seconds);
+}
+
+void SynthEngine::setVibrato(float rateHz, float depthSemitones) {
+    log(EventCall::Vibrato, { rateHz, depthSemitones });
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setVibrato(rateHz, depthSemitones);
+}
+
+void SynthEngine::setMasterVolume(float vol) {
+    log(EventCall::Volume, { vol });
+    masterVolume = vol;
+}
+
+void SynthEngine::setSynthesisModel(int model) {
+    log(EventCall::SynthesisModel, { (float)model });
+    synthesisModel = model == 1 ? 1 : 0;
+}
+
+void SynthEngine::setFmPatch(const FmPatch& patch) {
+    if (eventLog) {
+        float args[EventLog::MAX_ARGS];
+        eventLog->call(getPosition(), EventCall::FmPatch, args, EventLog::packFmPatch(patch, args));
+    }
+    fm.setPatch(patch);
+}
+
+void SynthEngine::setSendEffect(int bus, const DelaySettings& settings) {
+    if (eventLog) {
+        float args[EventLog::MAX_ARGS];
+        eventLog->call(getPosition(), EventCall::SendEffect, args, EventLog::packDelay(bus, settings, args));
+    }
+    if (bus < 0 || bus >= Voice::MAX_SENDS) return;
+    sends[bus].effect.prepare(sampleRate, 1024);
+    sends[bus].effect.setSettings(settings);
+}
+
+void SynthEngine::setSendLevel(int bus, float level) {
+    log(EventCall::SendLevel, { (float)bus, level });
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setSendLevel(bus, level);
+    if (bus >= 0 && bus < Voice::MAX_SENDS) fmSendLevel[bus] = level;
+}
+
+void SynthEngine::setSampleLibrary(std::shared_ptr<const SampleLibrary> library) {
+    log(EventCall::SampleLibrary); // The samples themselves are not in the log
+    // Voices let go of their slots before the old streamer goes away
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setSampler(nullptr, 0);
+    streamer.reset(library ? new SampleStreamer(library, MAX_VOICES) : nullptr);
+    if (!streamer) return;
+    for (int i = 0; i < MAX_VOICES; ++i) voices[i].setSampler(streamer.get(), i);
+}
+
+void SynthEngine::setReverb(std::shared_ptr<const ImpulseResponse> ir, float wet) {
+    log(EventCall::Reverb); // Nor is the impulse response
+    if (!ir) {
+        reverb.reset();
+        return;
+    }
+    if (!reverb) reverb.reset(new ConvolutionReverb());
+    reverb->setImpulseResponse(ir);
+    reverb->setMix(1.0f, wet);
+}
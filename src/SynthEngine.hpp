@@ -1,30 +1,135 @@
 #pragma once
 #include "Voice.hpp"
+#include "FmVoiceBank.hpp"
+#include "MidiEventSink.hpp"
+#include "ConvolutionReverb.hpp"
+#include "EventLog.hpp"
+#include <atomic>
+#include <initializer_list>
+#include <memory>
 #include <vector>
 
 #include "dsp/DspBuffer.hpp"
+#include "dsp/ModulatedDelay.hpp"
 
-class SynthEngine {
+class SynthEngine : public MidiEventSink {
 public:
+    static const int MAX_BLOCK = 1024; // Larger blocks render correctly but may allocate
+
     SynthEngine();
     void setSampleRate(double sr);
+    void reset(); // Silences all voices and clears their DSP state
     
     // MIDI handling
     void noteOn(int noteNumber, int velocity);
     void noteOff(int noteNumber);
+    void handleMidiEvent(const MidiEvent& event) override;
+    void allNotesOff();
     
     // Audio processing
     void render(DspBuffer& outputBuffer);
+    // Advance voice and send-effect state by `frames` without rendering (used to fast-forward offline renders)
+    void skip(int frames);
+    bool isSilent() const;
     
     // Parameters
     void setFilterCutoff(float cutoff);
     void setFilterResonance(float res);
     void setEnvelopeParams(float a, float d, float s, float r);
+    void getEnvelopeParams(float& a, float& d, float& s, float& r) const { a = envelope[0]; d = envelope[1]; s = envelope[2]; r = envelope[3]; }
     void setWaveform(int waveformIndex); // 0=Sine, 1=Tri, 2=Saw, 3=Square
-    void setMasterVolume(float vol) { masterVolume = vol; }
+    void setFilterType(int typeIndex); // 0=LowPass, 1=HighPass, 2=BandPass
+    // count 1 = single oscillator. Safe from one other thread while rendering: the voices
+    // switch sources at the start of the next render or skip.
+    void setUnison(int count, float detune, float spread);
+    void setModulation(const ModSettings& settings);
+    void setModWheel(float value); // 0..1, also driven by CC 1
+    void setPitchBend(float value); // -1..1 of the bend range, also driven by pitch bend messages
+    void setPitchBendRange(float semitones);
+    void setPortamento(float seconds); // Glide from the previous note while any voice sounds; 0 turns it off
+    void setVibrato(float rateHz, float depthSemitones);
+    void setMasterVolume(float vol); // Ramped over the next block
+    // Which voices new notes go to: 0 = subtractive, 1 = FM. Sounding notes finish on the
+    // voices they started on. FM voices follow pitch bend and the send levels; the filter,
+    // mod matrix, glide and vibrato are part of the subtractive voice.
+    void setSynthesisModel(int model);
+    int getSynthesisModel() const { return synthesisModel; }
+    void setFmPatch(const FmPatch& patch);
+    const FmPatch& getFmPatch() const { return fm.getPatch(); }
+    // Send buses: every voice's output is scaled by its send level and summed into
+    // the bus, and the bus effect runs once per block on the sum.
+    // setSendEffect allocates the delay ring, so not for the audio thread.
+    void setSendEffect(int bus, const DelaySettings& settings);
+    void setSendLevel(int bus, float level); // Every voice; Voice::setSendLevel for one voice
+    // Multisampled playback instead of the oscillators; nullptr switches back.
+    // Starts a streaming thread, so not for the audio thread.
+    void setSampleLibrary(std::shared_ptr<const SampleLibrary> library);
+    SampleStreamer* getSampleStreamer() { return streamer.get(); }
+    // Convolution stage after the master gain; nullptr removes it. Allocates, so not for the audio thread.
+    void setReverb(std::shared_ptr<const ImpulseResponse> ir, float wet = 0.3f);
+    ConvolutionReverb* getReverb() { return reverb.get(); }
+    // Per-stage counters for render(); the profiler must be opened on the rendering thread. nullptr turns it off.
+    void setProfiler(PerfProfiler* p);
+    // Records every call above, MIDI event and render into `log` from now on, for replay.
+    // Attach to a freshly made engine, before configuring it, so a replay starts from the
+    // same state. nullptr stops logging.
+    void setEventLog(EventLog* log);
+    EventLog* getEventLog() const { return eventLog; }
+    uint64_t getPosition() const { return position.load(std::memory_order_relaxed); } // Frames rendered or skipped
+    // Moves every block buffer (engine, buses, voices) into `arena`. With the engine itself
+    // created in the arena, all render state is one region. Not for the audio thread.
+    bool allocateFrom(RealtimeArena& arena);
 
 private:
     static const int MAX_VOICES = 8;
     Voice voices[MAX_VOICES];
+    FmVoiceBank fm;
+    int synthesisModel = 0;
+    float fmSendLevel[Voice::MAX_SENDS] = {};
+    DspBuffer voiceBuffer{2, MAX_BLOCK}; // Per-instance so engines can render on separate threads
     float masterVolume = 0.2f;
+    float appliedVolume = 0.2f; // Where the last block's gain ramp ended
+    float envelope[4] = { 0.01f, 0.1f, 0.7f, 0.5f }; // ADSR as last set, starting at the Envelope defaults
+    float pitchBend = 0.0f; // -1..1
+    float bendRange = 2.0f; // Semitones
+    int lastNote = -1;      // Where the next note glides from while voices are sounding
+
+    struct SendBus {
+        ModulatedDelay effect;
+        DspBuffer buffer{2, MAX_BLOCK};
+        int tailRemaining = 0; // Frames the effect keeps ringing after its last input
+    };
+    SendBus sends[Voice::MAX_SENDS];
+    double sampleRate = 44100.0;
+    PerfProfiler* profiler = nullptr;
+    EventLog* eventLog = nullptr;
+    std::atomic<uint64_t> position{0};
+
+    // Latest setUnison, picked up by the rendering thread between blocks.
+    // Seqlock: odd while being written
+    struct UnisonRequest {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<int> count{1};
+        std::atomic<float> detune{0.0f};
+        std::atomic<float> spread{0.0f};
+    };
+    UnisonRequest unisonRequest;
+    uint32_t unisonApplied = 0;
+
+    std::unique_ptr<SampleStreamer> streamer;  // One ring per voice
+    std::unique_ptr<ConvolutionReverb> reverb; // Created on first use: it owns a thread
+
+    void log(EventCall call, std::initializer_list<float> args = {}) {
+        if (eventLog) eventLog->call(getPosition(), call, args.begin(), (int)args.size());
+    }
+    void logFrames(EventKind kind, int frames, int channels = 0);
+    // Unlogged bodies of the calls above, for MIDI messages and other calls already logged
+    void noteOnImpl(int note, int velocity);
+    void noteOffImpl(int note);
+    void resetImpl();
+    void allNotesOffImpl();
+    void setModWheelImpl(float value);
+    void setPitchBendImpl(float value);
+    bool voicesActive() const; // Any voice of either model, not counting effect tails
+    void applyUnison();
 };
@@ -0,0 +1,178 @@
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct ThreadRing {
+    std::unique_ptr<TraceEvent[]> events;
+    uint64_t mask = 0;
+    std::atomic<uint64_t> written{0}; // Events ever recorded; the ring keeps the last mask + 1
+    std::atomic<const char*> name{nullptr};
+    std::atomic<bool> owned{false};
+};
+
+ThreadRing rings[Trace::MAX_THREADS];
+std::atomic<uint64_t> droppedEvents{0};
+int eventsPerThread = 0;
+const auto epoch = std::chrono::steady_clock::now();
+
+ThreadRing* overflowRing() {
+    static ThreadRing none;
+    return &none;
+}
+
+// Hands the ring back when its thread exits; its events stay readable until it is claimed again
+struct RingHandle {
+    ThreadRing* ring = nullptr;
+    const char* name = nullptr; // From setThreadName, applied when a ring is claimed
+    ~RingHandle() {
+        if (ring && ring != overflowRing()) ring->owned.store(false, std::memory_order_release);
+    }
+};
+
+RingHandle& threadHandle() {
+    thread_local RingHandle handle;
+    return handle;
+}
+
+// The first event recorded on a thread claims a free ring; no locks, no allocation.
+// Threads that never record while tracing is on never take one.
+ThreadRing* threadRing() {
+    RingHandle& handle = threadHandle();
+    if (!handle.ring) {
+        for (auto& ring : rings) {
+            bool expected = false;
+            if (ring.owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                ring.name.store(handle.name, std::memory_order_release);
+                ring.written.store(0, std::memory_order_release);
+                handle.ring = &ring;
+                break;
+            }
+        }
+        if (!handle.ring) handle.ring = overflowRing(); // Events from this thread are dropped
+    }
+    return handle.ring;
+}
+
+} // namespace
+
+std::atomic<bool> Trace::enabled{false};
+
+void Trace::configure(int events) {
+    if (isEnabled()) return;
+    uint64_t size = 1;
+    while (size < (uint64_t)std::max(events, 1)) size <<= 1;
+    for (auto& ring : rings) {
+        ring.events.reset(new TraceEvent[size]());
+        ring.mask = size - 1;
+        ring.written.store(0, std::memory_order_relaxed);
+    }
+    eventsPerThread = (int)size;
+}
+
+void Trace::setEnabled(bool on) {
+    if (on && eventsPerThread == 0) configure();
+    enabled.store(on, std::memory_order_release);
+}
+
+void Trace::clear() {
+    if (isEnabled()) return;
+    for (auto& ring : rings) ring.written.store(0, std::memory_order_relaxed);
+    droppedEvents.store(0, std::memory_order_relaxed);
+}
+
+void Trace::setThreadName(const char* name) {
+    RingHandle& handle = threadHandle();
+    handle.name = name;
+    if (handle.ring) handle.ring->name.store(name, std::memory_order_release);
+}
+
+uint64_t Trace::now() {
+    // Offset by one so 0 can mean "not started"
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count() + 1;
+}
+
+void Trace::record(const char* name, uint64_t start, uint64_t end, int32_t arg) {
+    ThreadRing* ring = threadRing();
+    if (!ring->events) {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    uint64_t index = ring->written.load(std::memory_order_relaxed);
+    TraceEvent& e = ring->events[index & ring->mask];
+    e.start = start;
+    e.duration = (uint32_t)std::min<uint64_t>(end - start, UINT32_MAX);
+    e.arg = arg;
+    e.name = name;
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+void Trace::instant(const char* name, int32_t arg) {
+    if (!isEnabled()) return;
+    uint64_t t = now();
+    record(name, t, t, arg);
+}
+
+uint64_t Trace::getDroppedEvents() {
+    return droppedEvents.load(std::memory_order_relaxed);
+}
+
+void Trace::writeChromeJson(std::ostream& out) {
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    char line[256];
+    std::vector<TraceEvent> copy;
+    for (int t = 0; t < MAX_THREADS; ++t) {
+        ThreadRing& ring = rings[t];
+        int tid = t + 1;
+        const char* name = ring.name.load(std::memory_order_acquire);
+        if (name) {
+            std::snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                          first ? "" : ",\n", tid, name);
+            out << line;
+            first = false;
+        }
+        if (!ring.events || ring.written.load(std::memory_order_acquire) == 0) continue;
+
+        // Copy while the owner keeps writing, then keep only what cannot have been overwritten meanwhile.
+        // The owner may be filling slot `after` already, so the oldest slot is never trusted
+        uint64_t capacity = ring.mask + 1;
+        uint64_t before = ring.written.load(std::memory_order_acquire);
+        uint64_t begin = before > capacity ? before - capacity : 0;
+        copy.assign(before - begin, TraceEvent());
+        for (uint64_t i = begin; i < before; ++i) copy[i - begin] = ring.events[i & ring.mask];
+        uint64_t after = ring.written.load(std::memory_order_acquire);
+        uint64_t safe = after >= capacity ? after - capacity + 1 : 0;
+
+        for (uint64_t i = std::max(begin, safe); i < before; ++i) {
+            const TraceEvent& e = copy[i - begin];
+            if (!e.name) continue;
+            int n;
+            if (e.duration == 0) {
+                n = std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+                                  first ? "" : ",\n", e.name, e.start * 1e-3, tid);
+            } else {
+                n = std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+                                  first ? "" : ",\n", e.name, e.start * 1e-3, e.duration * 1e-3, tid);
+            }
+            if (e.arg >= 0 && n > 0 && n < (int)sizeof(line)) {
+                std::snprintf(line + n, sizeof(line) - n, ",\"args\":{\"value\":%d}", e.arg);
+            }
+            out << line << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool Trace::writeChromeJson(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) return false;
+    writeChromeJson(file);
+    return (bool)file;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Build with -DRX_TRACE=0 to compile every marker out
+#ifndef RX_TRACE
+#define RX_TRACE 1
+#endif
+
+struct TraceEvent {
+    uint64_t start;    // ns since the trace epoch
+    uint32_t duration; // ns; 0 for instants
+    int32_t arg;       // -1 if unused
+    const char* name;  // Static string
+};
+
+// Timeline tracing cheap enough to leave running on the audio thread.
+//
+// Each thread records into its own preallocated ring (claimed on its first event recorded
+// while tracing is on, lock-free, no allocation, released when the thread exits), keeping
+// the most recent events. A marker costs two clock reads and a
+// store when tracing is on and one relaxed load when it is off. writeChromeJson() snapshots
+// every ring without stopping the writers and emits Chrome trace-event JSON, which
+// chrome://tracing and ui.perfetto.dev both open.
+class Trace {
+public:
+    static const int MAX_THREADS = 16;
+    static const int DEFAULT_EVENTS = 8192; // Per thread
+
+    // Allocates the rings; only while tracing is off. setEnabled() configures the default on first use
+    static void configure(int eventsPerThread = DEFAULT_EVENTS);
+    static void setEnabled(bool on);
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void clear(); // Only while tracing is off
+
+    static void setThreadName(const char* name); // Static string, e.g. "audio"; does not claim a ring
+    static uint64_t now();
+    static void record(const char* name, uint64_t start, uint64_t end, int32_t arg = -1);
+    static void instant(const char* name, int32_t arg = -1);
+    static uint64_t getDroppedEvents(); // From threads beyond MAX_THREADS live at once
+
+    static void writeChromeJson(std::ostream& out);
+    static bool writeChromeJson(const std::string& path);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* n, int32_t a = -1) : name(n), arg(a), start(Trace::isEnabled() ? Trace::now() : 0) {}
+    ~TraceScope() { if (start) Trace::record(name, start, Trace::now(), arg); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    int32_t arg;
+    uint64_t start;
+};
+
+#define RX_TRACE_JOIN2(a, b) a##b
+#define RX_TRACE_JOIN(a, b) RX_TRACE_JOIN2(a, b)
+#if RX_TRACE
+#define RX_TRACE_SCOPE(name) TraceScope RX_TRACE_JOIN(traceScope, __LINE__)(name)
+#define RX_TRACE_SCOPE_ARG(name, arg) TraceScope RX_TRACE_JOIN(traceScope, __LINE__)(name, (int32_t)(arg))
+#define RX_TRACE_INSTANT(name) Trace::instant(name)
+#define RX_TRACE_THREAD(name) Trace::setThreadName(name)
+#else
+#define RX_TRACE_SCOPE(name) ((void)0)
+#define RX_TRACE_SCOPE_ARG(name, arg) ((void)0)
+#define RX_TRACE_INSTANT(name) ((void)0)
+#define RX_TRACE_THREAD(name) ((void)0)
+#endif
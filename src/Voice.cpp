@@ -1,4 +1,6 @@
 #include "Voice.hpp"
+#include "dsp/FastMath.hpp"
+#include <algorithm>
 #include <cmath>
 
 Voice::Voice() {
@@ -8,18 +10,104 @@ Voice::Voice() {
 }
 
 void Voice::setSampleRate(double sr) {
+    sampleRate = sr;
+    vibrato.setSampleRate(sr);
     graph.prepare(sr, 512); // Default block size
+    modMatrix.setSampleRate(sr);
+    // Sources out of the graph still need the rate
+    DspNode* current = source();
+    for (DspNode* node : { (DspNode*)&oscNode, (DspNode*)&unisonNode, (DspNode*)&samplerNode }) {
+        if (node != current) node->prepare(sr, 512);
+    }
+}
+
+DspNode* Voice::source() {
+    if (samplerActive) return &samplerNode;
+    if (unisonActive) return &unisonNode;
+    return &oscNode;
+}
+
+void Voice::setUnison(int count, float detune, float spread) {
+    unisonNode.setUnison(count, detune, spread);
+    DspNode* before = source();
+    unisonActive = count > 1;
+    graph.replaceNode(before, source());
+}
+
+void Voice::setSampler(SampleStreamer* streamer, int slot) {
+    samplerNode.setStreamer(streamer, slot);
+    DspNode* before = source();
+    samplerActive = streamer != nullptr;
+    graph.replaceNode(before, source());
+}
+
+void Voice::setModulation(const ModSettings& settings) {
+    modMatrix.setSettings(settings);
+    if (!modMatrix.hasRoutes()) restoreStaticPatch();
+}
+
+void Voice::setVibrato(float rateHz, float depthSemitones) {
+    vibrato.setRate(rateHz);
+    vibratoDepth = std::max(0.0f, depthSemitones);
+}
+
+void Voice::restoreStaticPatch() {
+    filterNode.setCutoff(baseCutoff);
+    filterNode.setResonance(baseResonance);
+    oscNode.setFrequency(baseFrequency);
+    unisonNode.setPitchRatio(1.0f);
+    samplerNode.setPitchRatio(1.0f);
+    ampGain = 1.0f;
+}
+
+// Portamento is linear in pitch, so the frequency glide is exponential
+void Voice::advancePitch(int frames) {
+    vibrato.advance(frames);
+    if (glideOffset > 0.0f) glideOffset = std::max(0.0f, glideOffset - glideRate * frames);
+    else if (glideOffset < 0.0f) glideOffset = std::min(0.0f, glideOffset + glideRate * frames);
+}
+
+void Voice::reset() {
+    graph.reset();
+    modMatrix.reset();
+    DspNode* current = source();
+    for (DspNode* node : { (DspNode*)&oscNode, (DspNode*)&unisonNode, (DspNode*)&samplerNode }) {
+        if (node != current) node->reset();
+    }
+    noteNumber = -1;
+    glideOffset = 0.0f;
 }
 
-void Voice::noteOn(int note, int vel) {
+void Voice::noteOn(int note, int vel, int glideFrom) {
+    bool wasActive = isActive();
+    if (!wasActive) {
+        // Start idle voices from a known state so output only depends on
+        // events since the voice last went silent
+        oscNode.reset();
+        unisonNode.reset();
+        filterNode.reset();
+        vibrato.reset();
+    }
+    glideOffset = 0.0f;
+    if (glideFrom >= 0 && glideTime > 0.0f && glideFrom != note) {
+        glideOffset = (float)(glideFrom - note);
+        glideRate = std::abs(glideOffset) / (float)(glideTime * sampleRate); // Same time for any interval
+    }
     noteNumber = note;
     velocity = vel / 127.0f;
-    oscNode.setFrequency(mtof(note));
+    baseFrequency = (float)mtof(note);
+    oscNode.setFrequency(baseFrequency);
+    unisonNode.setFrequency(baseFrequency);
+    if (samplerActive) samplerNode.noteOn(note, vel);
     envNode.enterStage(EnvelopeStage::Attack);
+    
+    modMatrix.noteOn(note, velocity, !wasActive);
+    if (modMatrix.hasRoutes() || isPitchModulated()) applyModulation(modMatrix.evaluate(), 0); // Start on the modulated values
 }
 
 void Voice::noteOff() {
     envNode.enterStage(EnvelopeStage::Release);
+    modMatrix.noteOff();
 }
 
 bool Voice::isActive() const {
@@ -31,7 +119,45 @@ int Voice::getNoteNumber() const {
 }
 
 void Voice::render(DspBuffer& buffer) {
-    graph.process(buffer);
+    bool modulated = modMatrix.hasRoutes() || isPitchModulated();
+    if (modulated) {
+        renderModulated(buffer);
+    } else {
+        if (wasModulated) restoreStaticPatch(); // Bend released or glide finished
+        renderStatic(buffer);
+    }
+    wasModulated = modulated;
+    
+    // Hand the stream back once the release has finished
+    if (samplerActive && !envNode.isActive()) samplerNode.stop();
+}
+
+// Same chain as the graph, one node at a time when profiling
+void Voice::processGraph(DspBuffer& buffer) {
+    if (!profiler) {
+        graph.process(buffer);
+        return;
+    }
+    profiler->begin();
+    {
+        RX_TRACE_SCOPE(source()->getName());
+        source()->process(buffer);
+    }
+    profiler->end(PerfStage::Oscillator);
+    {
+        RX_TRACE_SCOPE(filterNode.getName());
+        filterNode.process(buffer);
+    }
+    profiler->end(PerfStage::Filter);
+    {
+        RX_TRACE_SCOPE(envNode.getName());
+        envNode.process(buffer);
+    }
+    profiler->end(PerfStage::Envelope);
+}
+
+void Voice::renderStatic(DspBuffer& buffer) {
+    processGraph(buffer);
     
     // Apply velocity
     int frames = buffer.getNumFrames();
@@ -44,6 +170,85 @@ void Voice::render(DspBuffer& buffer) {
     }
 }
 
+void Voice::renderModulated(DspBuffer& buffer) {
+    int frames = buffer.getNumFrames();
+    int channels = buffer.getNumChannels();
+    int interval = modMatrix.getControlInterval();
+    
+    for (int start = 0; start < frames; start += interval) {
+        int n = std::min(interval, frames - start);
+        
+        // Evaluate the sources at the end of this interval and glide there from the current values
+        modMatrix.advance(n);
+        advancePitch(n);
+        float ampStart = ampGain;
+        applyModulation(modMatrix.evaluate(), n);
+        float ampStep = (ampGain - ampStart) / n;
+        
+        controlBuffer.resize(channels, n); // Within the initial capacity: no allocation
+        processGraph(controlBuffer);
+        
+        for (int c = 0; c < channels; ++c) {
+            const float* src = controlBuffer.getChannel(c);
+            float* dst = buffer.getChannel(c) + start;
+            float gain = ampStart;
+            for (int i = 0; i < n; ++i) {
+                gain += ampStep;
+                dst[i] = src[i] * gain * velocity;
+            }
+        }
+    }
+}
+
+void Voice::applyModulation(const ModTargets& targets, int frames) {
+    // Only control-rate work here: two exp2 calls and the filter coefficients.
+    // The guard keeps the cutoff below Nyquist; FilterNode caps it further to stay stable.
+    float nyquistGuard = (float)(0.45 * sampleRate);
+    float cutoff = std::max(20.0f, std::min(baseCutoff * FastMath::exp2(targets.cutoffOctaves), nyquistGuard));
+    float resonance = baseResonance + targets.resonance;
+    float semitones = targets.pitchSemitones + pitchBend + glideOffset + vibrato.getValue() * vibratoDepth;
+    float pitchRatio = FastMath::exp2(semitones * (1.0f / 12.0f));
+    
+    if (frames > 0) {
+        filterNode.rampTo(cutoff, resonance, frames);
+        oscNode.rampFrequency(baseFrequency * pitchRatio, frames);
+    } else {
+        filterNode.setCutoff(cutoff);
+        filterNode.setResonance(resonance);
+        oscNode.setFrequency(baseFrequency * pitchRatio);
+    }
+    unisonNode.setPitchRatio(pitchRatio);
+    samplerNode.setPitchRatio(pitchRatio);
+    ampGain = targets.amp;
+}
+
+// Mirrors render(): modulated voices step the same control intervals, so glides,
+// vibrato and bends move the oscillator phase as they would have
+void Voice::skip(int frames) {
+    bool modulated = modMatrix.hasRoutes() || isPitchModulated();
+    if (modulated) {
+        int interval = modMatrix.getControlInterval();
+        for (int start = 0; start < frames; start += interval) {
+            int n = std::min(interval, frames - start);
+            modMatrix.advance(n);
+            advancePitch(n);
+            applyModulation(modMatrix.evaluate(), n);
+            advanceSource(n);
+        }
+    } else {
+        if (wasModulated) restoreStaticPatch();
+        advanceSource(frames);
+    }
+    wasModulated = modulated;
+    envNode.advance(frames);
+}
+
+void Voice::advanceSource(int frames) {
+    if (samplerActive) samplerNode.advance(frames);
+    else if (unisonActive) unisonNode.advance(frames);
+    else oscNode.advance(frames);
+}
+
 double Voice::mtof(int note) {
-    return 440.0 * std::pow(2.0, (note - 69) / 12.0);
+    return FastMath::mtof((float)note);
 }
\ No newline at end of file
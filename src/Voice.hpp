@@ -1,36 +1,97 @@
 #pragma once
 #include "dsp/DspGraph.hpp"
 #include "dsp/OscillatorNode.hpp"
+#include "dsp/UnisonOscillatorNode.hpp"
 #include "dsp/FilterNode.hpp"
 #include "dsp/EnvelopeNode.hpp"
+#include "ModMatrix.hpp"
+#include "SamplerNode.hpp"
+#include "PerfCounters.hpp"
+#include <algorithm>
 
 class Voice {
 public:
+    static const int MAX_SENDS = 2;
+
     Voice();
     
     void setSampleRate(double sr);
-    void noteOn(int noteNumber, int velocity);
+    void reset();
+    // glideFrom: note to glide from when portamento is on, -1 for none
+    void noteOn(int noteNumber, int velocity, int glideFrom = -1);
     void noteOff();
     bool isActive() const;
     int getNoteNumber() const;
     
     // Process audio for this voice
     void render(DspBuffer& buffer);
+    // Advance modulation, oscillator and envelope state without rendering (filter state is left alone)
+    void skip(int frames);
 
     // Parameters
-    void setFilterCutoff(float cutoff) { filterNode.setCutoff(cutoff); }
-    void setFilterResonance(float res) { filterNode.setResonance(res); }
+    void setFilterCutoff(float cutoff) { baseCutoff = cutoff; filterNode.setCutoff(cutoff); }
+    void setFilterResonance(float res) { baseResonance = res; filterNode.setResonance(res); }
     void setEnvelopeParams(float a, float d, float s, float r) { envNode.setParameters(a, d, s, r); }
-    void setWaveform(Waveform w) { oscNode.setWaveform(w); }
+    void setWaveform(Waveform w) { oscNode.setWaveform(w); unisonNode.setWaveform(w); }
+    void setFilterType(FilterType t) { filterNode.setType(t); }
+    void setUnison(int count, float detune, float spread); // Swaps graph nodes: not while rendering
+    void setModulation(const ModSettings& settings);
+    void setModWheel(float value) { modMatrix.setModWheel(value); }
+    // Pitch modulation on top of the mod matrix. Any of these being active renders the
+    // voice at control rate, with exponential per-sample glides between control points.
+    void setPitchBend(float semitones) { pitchBend = semitones; }
+    void setPortamento(float seconds) { glideTime = std::max(0.0f, seconds); }
+    void setVibrato(float rateHz, float depthSemitones);
+    // Plays samples from `streamer` (using its slot `slot`) instead of the oscillators; nullptr switches back
+    void setSampler(SampleStreamer* streamer, int slot);
+    // Post-envelope level into the engine's send buses
+    void setSendLevel(int bus, float level) { if (bus >= 0 && bus < MAX_SENDS) sendLevel[bus] = level; }
+    float getSendLevel(int bus) const { return sendLevel[bus]; }
+    // Attributes each graph node's work to its stage; nullptr (the default) turns it off
+    void setProfiler(PerfProfiler* p) { profiler = p; }
+    // Moves the voice's sample storage into `arena` (the rest of its state is inline)
+    bool allocateFrom(RealtimeArena& arena) { return controlBuffer.allocateFrom(arena, ModSettings::MAX_CONTROL_INTERVAL); }
 
 private:
     DspGraph graph;
     OscillatorNode oscNode;
+    UnisonOscillatorNode unisonNode; // Replaces oscNode in the graph when unison is on
+    bool unisonActive = false;
+    SamplerNode samplerNode;         // Replaces either oscillator when a sample library is loaded
+    bool samplerActive = false;
     FilterNode filterNode;
     EnvelopeNode envNode;
     
+    // Modulation runs at control rate; the graph renders one control interval at a time
+    ModMatrix modMatrix;
+    DspBuffer controlBuffer{2, ModSettings::MAX_CONTROL_INTERVAL};
+    double sampleRate = 44100.0;
+    float baseCutoff = 2000.0f;
+    float baseResonance = 0.5f;
+    float baseFrequency = 440.0f;
+    float ampGain = 1.0f;
+    float sendLevel[MAX_SENDS] = {};
+
+    float pitchBend = 0.0f;   // Semitones
+    float glideTime = 0.0f;   // Seconds for any interval
+    float glideOffset = 0.0f; // Semitones still to go, decaying to 0
+    float glideRate = 0.0f;   // Semitones per sample
+    Lfo vibrato;
+    float vibratoDepth = 0.0f; // Semitones
+    bool wasModulated = false;
+    PerfProfiler* profiler = nullptr;
+    
     int noteNumber = -1;
     float velocity = 0.0f;
     
+    DspNode* source(); // Whichever of the sources is in the graph
+    bool isPitchModulated() const { return pitchBend != 0.0f || glideOffset != 0.0f || vibratoDepth > 0.0f; }
+    void advancePitch(int frames);
+    void advanceSource(int frames);
+    void restoreStaticPatch();
     double mtof(int note);
+    void processGraph(DspBuffer& buffer);
+    void renderStatic(DspBuffer& buffer);
+    void renderModulated(DspBuffer& buffer);
+    void applyModulation(const ModTargets& targets, int frames); // frames 0 = jump
 };
\ No newline at end of file
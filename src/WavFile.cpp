@@ -0,0 +1,165 @@
+#include "WavFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static void putLE16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void putLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint32_t getLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t getLE16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool WavWriter::open(const std::string& filename, int channels, int sampleRate, WavFormat fmt) {
+    close();
+    file = std::fopen(filename.c_str(), "wb");
+    if (!file) return false;
+
+    // Offline renders write lots of small blocks; give stdio a big buffer
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+    numChannels = channels;
+    format = fmt;
+    framesWritten = 0;
+
+    this->sampleRate = sampleRate;
+    writeHeader(0);
+    return true;
+}
+
+void WavWriter::writeHeader(uint32_t dataBytes) {
+    int bytesPerSample = format == WavFormat::Float32 ? 4 : 2;
+    uint8_t h[44] = {};
+    std::memcpy(h, "RIFF", 4);
+    putLE32(h + 4, 36 + dataBytes);
+    std::memcpy(h + 8, "WAVEfmt ", 8);
+    putLE32(h + 16, 16);
+    putLE16(h + 20, format == WavFormat::Float32 ? 3 : 1); // IEEE float or PCM
+    putLE16(h + 22, (uint16_t)numChannels);
+    putLE32(h + 24, (uint32_t)sampleRate);
+    putLE32(h + 28, (uint32_t)(sampleRate * numChannels * bytesPerSample));
+    putLE16(h + 32, (uint16_t)(numChannels * bytesPerSample));
+    putLE16(h + 34, (uint16_t)(bytesPerSample * 8));
+    std::memcpy(h + 36, "data", 4);
+    putLE32(h + 40, dataBytes);
+
+    std::fseek(file, 0, SEEK_SET);
+    std::fwrite(h, 1, sizeof(h), file);
+}
+
+void WavWriter::write(float* const* channelData, int frames) {
+    if (!file || frames <= 0) return;
+
+    if (format == WavFormat::Float32) {
+        scratch.resize((size_t)frames * numChannels * sizeof(float));
+        float* out = (float*)scratch.data();
+        for (int i = 0; i < frames; ++i) {
+            for (int c = 0; c < numChannels; ++c) out[i * numChannels + c] = channelData[c][i];
+        }
+    } else {
+        scratch.resize((size_t)frames * numChannels * sizeof(int16_t));
+        int16_t* out = (int16_t*)scratch.data();
+        for (int i = 0; i < frames; ++i) {
+            for (int c = 0; c < numChannels; ++c) {
+                float s = std::max(-1.0f, std::min(channelData[c][i], 1.0f));
+                out[i * numChannels + c] = (int16_t)(s * 32767.0f);
+            }
+        }
+    }
+    // WAV is little-endian, as are all the hosts we target
+    std::fwrite(scratch.data(), 1, scratch.size(), file);
+    framesWritten += frames;
+}
+
+void WavWriter::close() {
+    if (!file) return;
+    int bytesPerSample = format == WavFormat::Float32 ? 4 : 2;
+    writeHeader((uint32_t)(framesWritten * numChannels * bytesPerSample));
+    std::fclose(file);
+    file = nullptr;
+}
+
+bool WavLayout::parse(const uint8_t* bytes, size_t size, std::string& error) {
+    if (size < 12 || std::memcmp(bytes, "RIFF", 4) || std::memcmp(bytes + 8, "WAVE", 4)) {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    int formatTag = 0;
+    size_t dataSize = 0;
+    dataOffset = 0;
+
+    // Walk chunks; anything other than fmt and data is skipped
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        uint32_t chunkSize = getLE32(&bytes[pos + 4]);
+        size_t begin = pos + 8;
+        size_t available = std::min((size_t)chunkSize, size - begin); // Tolerate truncated files
+        if (!std::memcmp(&bytes[pos], "fmt ", 4) && available >= 16) {
+            formatTag = getLE16(&bytes[begin]);
+            numChannels = getLE16(&bytes[begin + 2]);
+            sampleRate = (int)getLE32(&bytes[begin + 4]);
+            bitsPerSample = getLE16(&bytes[begin + 14]);
+            if (formatTag == 0xFFFE && available >= 26) formatTag = getLE16(&bytes[begin + 24]); // WAVE_FORMAT_EXTENSIBLE
+        } else if (!std::memcmp(&bytes[pos], "data", 4)) {
+            dataOffset = begin;
+            dataSize = available;
+        }
+        pos = begin + chunkSize + (chunkSize & 1); // Chunks are word aligned
+    }
+
+    isFloat = formatTag == 3 && bitsPerSample == 32;
+    bool isPcm = formatTag == 1 && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+    if (!dataOffset || numChannels <= 0 || (!isFloat && !isPcm)) {
+        error = "unsupported WAV format";
+        return false;
+    }
+    numFrames = dataSize / getBytesPerFrame();
+    return true;
+}
+
+float WavLayout::decode(const uint8_t* bytes, size_t frame, int channel) const {
+    const uint8_t* p = bytes + dataOffset + frame * getBytesPerFrame() + channel * (bitsPerSample / 8);
+    if (isFloat) {
+        float v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+    if (bitsPerSample == 16) return (int16_t)getLE16(p) / 32768.0f;
+    if (bitsPerSample == 24) {
+        return (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24)) / 2147483648.0f;
+    }
+    return (int32_t)getLE32(p) / 2147483648.0f;
+}
+
+bool WavReader::load(const std::string& filename) {
+    channels.clear();
+    error.clear();
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        error = "cannot open " + filename;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    WavLayout layout;
+    if (!layout.parse(bytes.data(), bytes.size(), error)) return false;
+
+    sampleRate = layout.sampleRate;
+    channels.assign(layout.numChannels, std::vector<float>(layout.numFrames));
+    for (size_t i = 0; i < layout.numFrames; ++i) {
+        for (int c = 0; c < layout.numChannels; ++c) channels[c][i] = layout.decode(bytes.data(), i, c);
+    }
+    return true;
+}
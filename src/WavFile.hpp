@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+enum class WavFormat { Float32, Pcm16 };
+
+// Streaming WAV writer. Takes planar blocks, interleaves into a reusable
+// scratch buffer and patches the RIFF sizes on close().
+class WavWriter {
+public:
+    ~WavWriter() { close(); }
+
+    bool open(const std::string& filename, int channels, int sampleRate, WavFormat format = WavFormat::Float32);
+    void write(float* const* channelData, int frames);
+    void close();
+
+    bool isOpen() const { return file != nullptr; }
+    uint64_t getFramesWritten() const { return framesWritten; }
+
+private:
+    FILE* file = nullptr;
+    int numChannels = 2;
+    int sampleRate = 44100;
+    WavFormat format = WavFormat::Float32;
+    uint64_t framesWritten = 0;
+    std::vector<uint8_t> scratch;
+
+    void writeHeader(uint32_t dataBytes);
+};
+
+// Where the samples of a WAV image live and how they are encoded.
+// Parsed from bytes already in memory, so it works on a memory-mapped file too.
+struct WavLayout {
+    int numChannels = 0;
+    int sampleRate = 44100;
+    int bitsPerSample = 0;
+    bool isFloat = false;
+    size_t dataOffset = 0; // From the start of the file image
+    size_t numFrames = 0;
+
+    int getBytesPerFrame() const { return numChannels * bitsPerSample / 8; }
+
+    // False (with a reason in `error`) unless the image is PCM 16/24/32-bit or float32
+    bool parse(const uint8_t* bytes, size_t size, std::string& error);
+    // Frame `frame`, channel `channel` of the image as float
+    float decode(const uint8_t* bytes, size_t frame, int channel) const;
+};
+
+// Whole-file WAV reader for assets such as impulse responses.
+// Accepts PCM 16/24/32-bit and IEEE float, any channel count; samples come back planar.
+class WavReader {
+public:
+    bool load(const std::string& filename);
+
+    int getNumChannels() const { return (int)channels.size(); }
+    int getNumFrames() const { return channels.empty() ? 0 : (int)channels[0].size(); }
+    int getSampleRate() const { return sampleRate; }
+    const std::vector<float>& getChannel(int c) const { return channels[c]; }
+    const std::string& getError() const { return error; }
+
+private:
+    std::vector<std::vector<float>> channels;
+    int sampleRate = 44100;
+    std::string error;
+};
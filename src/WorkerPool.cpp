@@ -0,0 +1,80 @@
+#include "WorkerPool.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int numThreads) {
+    if (numThreads <= 0) numThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < numThreads; ++i) {
+        threads.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void WorkerPool::drain(TaskFn fn, void* context, int count) {
+    for (int i = nextTask++; i < count; i = nextTask++) {
+        fn(context, i);
+        remaining--;
+    }
+}
+
+void WorkerPool::run(int count, TaskFn fn, void* context) {
+    if (count <= 0) return;
+    if (threads.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) fn(context, i);
+        return;
+    }
+
+    {
+        // A late worker may still be leaving the previous job; never reset under it
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [&] { return activeWorkers == 0; });
+        taskFn = fn;
+        taskContext = context;
+        taskCount = count;
+        nextTask = 0;
+        remaining = count;
+        generation++;
+    }
+    wake.notify_all();
+
+    drain(fn, context, count);
+
+    // Jobs are block-sized; spinning is cheaper than another sleep/wake round trip
+    while (remaining.load(std::memory_order_acquire) > 0) std::this_thread::yield();
+}
+
+void WorkerPool::workerLoop() {
+    RX_TRACE_THREAD("worker");
+    uint64_t seen = 0;
+    for (;;) {
+        TaskFn fn;
+        void* context;
+        int count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+            fn = taskFn;
+            context = taskContext;
+            count = taskCount;
+            activeWorkers++;
+        }
+
+        drain(fn, context, count);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeWorkers--;
+        }
+        idle.notify_all();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork/join work inside a render call.
+// parallelFor() does not allocate: the task is passed by reference through a
+// plain function pointer, and the calling thread works alongside the pool.
+class WorkerPool {
+public:
+    explicit WorkerPool(int numThreads = 0); // Total threads including the caller; 0 = all cores
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs task(i) for every i in [0, count) and returns when all have finished
+    template <typename F>
+    void parallelFor(int count, F& task) {
+        run(count, &invoke<F>, &task);
+    }
+
+    int getNumThreads() const { return (int)threads.size() + 1; }
+
+private:
+    using TaskFn = void (*)(void*, int);
+
+    template <typename F>
+    static void invoke(void* context, int index) { (*static_cast<F*>(context))(index); }
+
+    void run(int count, TaskFn fn, void* context);
+    void drain(TaskFn fn, void* context, int count);
+    void workerLoop();
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+
+    // Current job, guarded by `mutex` when written
+    TaskFn taskFn = nullptr;
+    void* taskContext = nullptr;
+    int taskCount = 0;
+    uint64_t generation = 0;
+    bool quit = false;
+
+    std::atomic<int> nextTask{0};
+    std::atomic<int> remaining{0};
+    int activeWorkers = 0; // Workers inside drain(); guarded by `mutex`
+};
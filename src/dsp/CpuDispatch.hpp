@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Instruction sets the DSP kernels are built for. The binary targets the baseline
+// (SSE2 on x86-64, NEON on AArch64); the wider versions are compiled alongside with
+// function target attributes and picked at startup from CPUID, so one build runs
+// everywhere and still uses AVX2/AVX-512 where the machine has them.
+//
+// RX_ISA=sse2|neon|avx2|avx512 (or "baseline") in the environment overrides the choice,
+// e.g. to compare or test the versions; an ISA the CPU lacks falls back to the best one.
+//
+// The Makefile builds with -ffp-contract=off: no version fuses multiply-adds (AVX-512
+// would), so every version gives bit-identical output.
+enum class CpuIsa { Baseline, Avx2, Avx512 };
+
+namespace CpuDispatch {
+
+const int ISA_COUNT = 3;
+
+inline const char* isaName(CpuIsa isa) {
+    switch (isa) {
+        case CpuIsa::Avx2: return "avx2";
+        case CpuIsa::Avx512: return "avx512";
+        default: break;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    return "sse2";
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+inline bool isSupported(CpuIsa isa) {
+    if (isa == CpuIsa::Baseline) return true;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init(); // May run before libgcc's own constructor
+    if (isa == CpuIsa::Avx2) return __builtin_cpu_supports("avx2");
+    return __builtin_cpu_supports("avx512f");
+#else
+    return false;
+#endif
+}
+
+inline CpuIsa best() {
+    if (isSupported(CpuIsa::Avx512)) return CpuIsa::Avx512;
+    if (isSupported(CpuIsa::Avx2)) return CpuIsa::Avx2;
+    return CpuIsa::Baseline;
+}
+
+inline CpuIsa detect() {
+    const char* requested = std::getenv("RX_ISA");
+    if (!requested || !*requested) return best();
+    for (int i = 0; i < ISA_COUNT; ++i) {
+        CpuIsa isa = (CpuIsa)i;
+        bool named = !std::strcmp(requested, isaName(isa)) || (i == 0 && !std::strcmp(requested, "baseline"));
+        if (named && isSupported(isa)) return isa;
+    }
+    std::cerr << "RX_ISA=" << requested << " is not available here, using " << isaName(best()) << std::endl;
+    return best();
+}
+
+// Read by every dispatch; set once before main()
+inline CpuIsa active = detect();
+
+inline CpuIsa isa() { return active; }
+
+// For tests and benchmarks; not while audio is rendering. False if the CPU lacks it
+inline bool setIsa(CpuIsa isa) {
+    if (!isSupported(isa)) return false;
+    active = isa;
+    return true;
+}
+
+} // namespace CpuDispatch
+
+// Per-ISA instances of a kernel K with a static run() of type Fn. Each wrapper inlines the
+// whole of K::run (flatten) so the loop is compiled, and vectorized, for that ISA.
+template <CpuIsa I, typename K, typename Fn>
+struct IsaKernel;
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RX_ISA_KERNEL(ISA, ATTRIBUTES)                               \
+    template <typename K, typename R, typename... A>                 \
+    struct IsaKernel<ISA, K, R (*)(A...)> {                          \
+        ATTRIBUTES static R run(A... a) { return K::run(a...); }     \
+    };
+RX_ISA_KERNEL(CpuIsa::Baseline, __attribute__((flatten)))
+RX_ISA_KERNEL(CpuIsa::Avx2, __attribute__((target("avx2"), flatten)))
+RX_ISA_KERNEL(CpuIsa::Avx512, __attribute__((target("avx512f"), flatten)))
+#undef RX_ISA_KERNEL
+#else
+// One version elsewhere; the wider slots fall back to it
+template <CpuIsa I, typename K, typename R, typename... A>
+struct IsaKernel<I, K, R (*)(A...)> {
+    __attribute__((flatten)) static R run(A... a) { return K::run(a...); }
+};
+#endif
+
+// A kernel with no compile-time modes, dispatched on the active ISA
+template <typename K, typename Fn>
+struct IsaDispatch {
+    static constexpr Fn kernels[CpuDispatch::ISA_COUNT] = {
+        &IsaKernel<CpuIsa::Baseline, K, Fn>::run,
+        &IsaKernel<CpuIsa::Avx2, K, Fn>::run,
+        &IsaKernel<CpuIsa::Avx512, K, Fn>::run,
+    };
+    static Fn get() { return kernels[(int)CpuDispatch::isa()]; }
+};
@@ -2,28 +2,79 @@
 #include <vector>
 #include <cstring>
 #include <algorithm>
+#include "../RealtimeArena.hpp"
+#include "VectorOps.hpp"
 
 // Efficient Audio Buffer for DSP processing
 class DspBuffer {
 public:
+    static constexpr int MAX_CHANNELS = 8;
+
     DspBuffer(int channels, int frames) 
-        : numChannels(channels), numFrames(frames) {
-        data.resize(channels * frames, 0.0f);
-        pointers.resize(channels);
+        : numChannels(std::min(channels, MAX_CHANNELS)), numFrames(frames) {
+        owned.resize(numChannels * frames, 0.0f);
+        data = owned.data();
+        capacity = owned.size();
+        updatePointers();
+    }
+    // An empty view; wrap() points it at channels someone else owns
+    DspBuffer() : numChannels(0), numFrames(0), data(nullptr), capacity(0) {}
+    DspBuffer(const DspBuffer&) = delete;
+    DspBuffer& operator=(const DspBuffer&) = delete;
+
+    // Repoints a view at the caller's planar channels, e.g. a host's output, so rendering
+    // writes straight into them. Never allocates; only for buffers made as views.
+    void wrap(float* const* channels, int count, int frames) {
+        numChannels = std::min(count, MAX_CHANNELS);
+        numFrames = frames;
+        for (int i = 0; i < numChannels; ++i) pointers[i] = channels[i];
+    }
+    bool isView() const { return data == nullptr; }
+
+    // Moves the samples into `arena`, with room for maxChannels x maxFrames. Resizes within
+    // that never allocate; false (buffer unchanged) if the arena is full.
+    bool allocateFrom(RealtimeArena& arena, int maxFrames, int maxChannels = 2) {
+        size_t size = (size_t)std::max(numChannels, std::min(maxChannels, MAX_CHANNELS)) * std::max(numFrames, maxFrames);
+        float* memory = arena.allocateArray<float>(size);
+        if (!memory) return false;
+        std::fill(memory, memory + size, 0.0f);
+        if (data) std::copy(data, data + numChannels * numFrames, memory);
+        data = memory;
+        capacity = size;
+        std::vector<float>().swap(owned);
         updatePointers();
+        return true;
     }
     
+    // Allocates only when growing past the capacity. A view shrinks in place and
+    // detaches into owned (silent) storage if it has to grow.
     void resize(int channels, int frames) {
+        channels = std::min(channels, MAX_CHANNELS);
         if (numChannels == channels && numFrames == frames) return;
+        size_t needed = (size_t)channels * frames;
+        if (!data) {
+            if (channels <= numChannels && frames <= numFrames) {
+                numChannels = channels;
+                numFrames = frames;
+                return;
+            }
+            owned.assign(needed, 0.0f);
+            data = owned.data();
+            capacity = needed;
+        } else if (needed > capacity) {
+            std::vector<float> grown(needed, 0.0f);
+            std::copy(data, data + numChannels * numFrames, grown.begin());
+            owned.swap(grown);
+            data = owned.data();
+            capacity = needed;
+        }
         numChannels = channels;
         numFrames = frames;
-        data.resize(channels * frames, 0.0f);
-        pointers.resize(channels);
         updatePointers();
     }
     
     void clear() {
-        std::fill(data.begin(), data.end(), 0.0f);
+        for (int c = 0; c < numChannels; ++c) VectorOps::clear(pointers[c], numFrames);
     }
     
     float* getChannel(int channel) {
@@ -35,20 +86,22 @@ public:
         if (source.numChannels != numChannels || source.numFrames != numFrames) {
             resize(source.numChannels, source.numFrames);
         }
-        std::copy(source.data.begin(), source.data.end(), data.begin());
+        for (int c = 0; c < numChannels; ++c) std::copy(source.pointers[c], source.pointers[c] + numFrames, pointers[c]);
     }
 
     void add(const DspBuffer& source) {
         int frames = std::min(numFrames, source.numFrames);
         int channels = std::min(numChannels, source.numChannels);
         
-        for (int c = 0; c < channels; ++c) {
-            float* dst = getChannel(c);
-            float* src = ((DspBuffer&)source).getChannel(c);
-            for (int i = 0; i < frames; ++i) {
-                dst[i] += src[i];
-            }
-        }
+        for (int c = 0; c < channels; ++c) VectorOps::add(pointers[c], source.pointers[c], frames);
+    }
+    
+    // Mix in a scaled copy, e.g. a voice into a send bus
+    void add(const DspBuffer& source, float gain) {
+        int frames = std::min(numFrames, source.numFrames);
+        int channels = std::min(numChannels, source.numChannels);
+
+        for (int c = 0; c < channels; ++c) VectorOps::addScaled(pointers[c], source.pointers[c], gain, frames);
     }
     
     int getNumChannels() const { return numChannels; }
@@ -57,8 +110,10 @@ public:
 private:
     int numChannels;
     int numFrames;
-    std::vector<float> data; 
-    std::vector<float*> pointers; 
+    float* data;              // In `owned` or in an arena; nullptr for views
+    size_t capacity;          // Floats at data
+    std::vector<float> owned; // Empty once moved into an arena
+    float* pointers[MAX_CHANNELS] = {};
     
     void updatePointers() {
         for (int i = 0; i < numChannels; ++i) {
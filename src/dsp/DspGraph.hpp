@@ -1,27 +1,42 @@
 #pragma once
 #include "DspNode.hpp"
-#include <vector>
+#include "../Trace.hpp"
 
 // Simple graph that owns nodes and calls them in order
 class DspGraph : public DspNode {
 public:
+    static const int MAX_NODES = 8; // Fixed so the graph lives inside its owner
+
     void addNode(DspNode* node) {
-        nodes.push_back(node);
+        if (numNodes < MAX_NODES) nodes[numNodes++] = node;
+    }
+    
+    // Swap a node in place, keeping its position in the chain
+    void replaceNode(DspNode* oldNode, DspNode* newNode) {
+        for (int i = 0; i < numNodes; ++i) {
+            if (nodes[i] == oldNode) nodes[i] = newNode;
+        }
     }
     
     void prepare(double sr, int bs) override {
         DspNode::prepare(sr, bs);
-        for (auto* n : nodes) n->prepare(sr, bs);
+        for (int i = 0; i < numNodes; ++i) nodes[i]->prepare(sr, bs);
+    }
+    
+    void reset() override {
+        for (int i = 0; i < numNodes; ++i) nodes[i]->reset();
     }
     
     // In this simple graph, we assume nodes modify the buffer in sequence
     // (Oscillator writes to it, Filter modifies it)
     void process(DspBuffer& buffer) override {
-        for (auto* n : nodes) {
-            n->process(buffer);
+        for (int i = 0; i < numNodes; ++i) {
+            RX_TRACE_SCOPE(nodes[i]->getName());
+            nodes[i]->process(buffer);
         }
     }
     
 private:
-    std::vector<DspNode*> nodes;
+    DspNode* nodes[MAX_NODES] = {};
+    int numNodes = 0;
 };
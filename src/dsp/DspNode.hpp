@@ -15,6 +15,9 @@ public:
     virtual void process(DspBuffer& outputBuffer) = 0;
     
     virtual void reset() {}
+
+    // Static string for trace markers
+    virtual const char* getName() const { return "DspNode"; }
     
 protected:
     double sampleRate = 44100.0;
@@ -1,6 +1,7 @@
 #pragma once
 #include "DspNode.hpp"
 #include "../Envelope.hpp"
+#include <algorithm>
 
 class EnvelopeNode : public DspNode {
 public:
@@ -17,22 +18,34 @@ public:
         env.enterStage(stage);
     }
     
+    void reset() override {
+        env.enterStage(EnvelopeStage::Off);
+    }
+    
+    void advance(int frames) {
+        env.advance(frames);
+    }
+    
     bool isActive() const {
         return env.isActive();
     }
     
+    const char* getName() const override { return "EnvelopeNode"; }
+
     void process(DspBuffer& buffer) override {
         int frames = buffer.getNumFrames();
         int channels = buffer.getNumChannels();
         
-        for (int i = 0; i < frames; ++i) {
-            float level = env.getNextLevel();
-            for (int c = 0; c < channels; ++c) {
-                buffer.getChannel(c)[i] *= level;
-            }
+        // Levels first (a serial state machine), then one vector multiply per channel
+        float levels[LEVEL_CHUNK];
+        for (int done = 0; done < frames; done += LEVEL_CHUNK) {
+            int n = std::min(LEVEL_CHUNK, frames - done);
+            env.render(levels, n);
+            for (int c = 0; c < channels; ++c) VectorOps::multiply(buffer.getChannel(c) + done, levels, n);
         }
     }
     
 private:
+    static constexpr int LEVEL_CHUNK = 256;
     Envelope env;
 };
\ No newline at end of file
@@ -0,0 +1,157 @@
+#pragma once
+#include "Float4.hpp"
+#include <cstdint>
+#include <cstring>
+
+// Fast approximations of the libm functions used on audio paths.
+//
+// Every kernel is a template written only with arithmetic, comparisons and bit
+// operations, so the same code runs on a float or on four lanes of a Float4.
+// The batch overloads take whole arrays and run four values per iteration.
+// There are no branches and no table lookups, and no library calls.
+//
+// Max errors, measured against libm over the stated range (see EngineTests):
+//   sin2pi, cos2pi  turns, |x| < 2^20       abs   2e-7
+//   sin, cos        radians, |x| < 10       abs   1e-6 (grows ~7e-8 * |x| beyond)
+//   tan             |x| < 1.5 rad           rel   3e-6
+//   exp2            -126 <= x <= 127        rel   3e-7
+//   log2            0.01 < x < 100          abs   4e-7 (one ulp of the result beyond)
+//   tanh            any x                   abs   2e-7
+//   mtof            MIDI notes 0..127       rel   7e-7
+namespace FastMath {
+
+namespace detail {
+
+// Scalar and Float4 versions of the few operations that differ between the two
+inline int32_t bits(float x) { int32_t i; std::memcpy(&i, &x, 4); return i; }
+inline Int4 bits(Float4 x) { return (Int4)x; }
+inline float fromBits(int32_t i) { float x; std::memcpy(&x, &i, 4); return x; }
+inline Float4 fromBits(Int4 i) { return (Float4)i; }
+inline int32_t toInt(float x) { return (int32_t)x; }
+inline Int4 toInt(Float4 x) { return __builtin_convertvector(x, Int4); }
+inline float toFloat(int32_t i) { return (float)i; }
+inline Float4 toFloat(Int4 i) { return __builtin_convertvector(i, Float4); }
+inline float select(bool mask, float a, float b) { return mask ? a : b; }
+inline Float4 select(Int4 mask, Float4 a, Float4 b) { return select4(mask, a, b); }
+
+// Round to nearest with the 1.5 * 2^23 trick; exact for |x| < 2^22
+template <typename T> inline T roundNearest(T x) {
+    const float magic = 12582912.0f;
+    return (x + magic) - magic;
+}
+
+template <typename T> inline T abs(T x) { return fromBits(bits(x) & 0x7FFFFFFF); }
+
+template <typename T> inline T copySign(T magnitude, T sign) {
+    return fromBits((bits(magnitude) & 0x7FFFFFFF) | (bits(sign) & (int32_t)0x80000000));
+}
+
+template <typename T> inline T clamp(T x, float lo, float hi) {
+    x = select(x < lo, T{} + lo, x); // T{} + lo broadcasts lo to T
+    return select(x > hi, T{} + hi, x);
+}
+
+// sin(2 * pi * w) for |w| <= 0.25 turns
+template <typename T> inline T sinQuarter(T w) {
+    T z = w * 6.28318530718f; // Radians, |z| <= pi/2
+    T z2 = z * z;
+    // Taylor series to z^11; truncation error at pi/2 is below 6e-8
+    T p = z2 * -2.50521084e-8f + 2.75573192e-6f;
+    p = p * z2 - 1.98412698e-4f;
+    p = p * z2 + 8.33333333e-3f;
+    p = p * z2 - 1.66666667e-1f;
+    return z + z * z2 * p;
+}
+
+// Applies a kernel to an array four values at a time, scalar for the tail
+template <typename Kernel>
+inline void batch(const float* in, float* out, int count, Kernel kernel) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        Float4 v;
+        std::memcpy(&v, in + i, sizeof(v));
+        v = kernel(v);
+        std::memcpy(out + i, &v, sizeof(v));
+    }
+    for (; i < count; ++i) out[i] = kernel(in[i]);
+}
+
+} // namespace detail
+
+// sin(2 * pi * x) with x in turns. Oscillator phases are already in turns,
+// so this skips the radian round trip.
+template <typename T> inline T sin2pi(T x) {
+    T r = x - detail::roundNearest(x); // [-0.5, 0.5]
+    // Fold to [-0.25, 0.25]; 0.5 - |r| is exact there, so small arguments keep full precision
+    return detail::sinQuarter(detail::select(detail::abs(r) > 0.25f, detail::copySign(T{} + 0.5f, r) - r, r));
+}
+
+template <typename T> inline T cos2pi(T x) {
+    T r = x - detail::roundNearest(x);
+    // cos(2pi r) = sin(2pi (0.25 - |r|)); the subtraction only rounds where |r| < 0.125,
+    // where the slope of cos is small
+    return detail::sinQuarter(0.25f - detail::abs(r));
+}
+
+template <typename T> inline T sin(T radians) { return sin2pi(radians * 0.159154943092f); }
+template <typename T> inline T cos(T radians) { return cos2pi(radians * 0.159154943092f); }
+
+// Valid for |x| < pi/2; the filter prewarp tan(pi * fc / fs) stays well inside
+template <typename T> inline T tan(T radians) {
+    T turns = radians * 0.159154943092f;
+    return sin2pi(turns) / cos2pi(turns);
+}
+
+template <typename T> inline T exp2(T x) {
+    x = detail::clamp(x, -126.0f, 127.0f);
+    T n = detail::roundNearest(x);
+    T y = (x - n) * 0.693147180560f; // ln(2) * f, |y| <= 0.347
+    // e^y to y^6; truncation error below 1.3e-7
+    T p = y * 1.38888889e-3f + 8.33333333e-3f;
+    p = p * y + 4.16666667e-2f;
+    p = p * y + 1.66666667e-1f;
+    p = p * y + 0.5f;
+    p = p * y + 1.0f;
+    p = p * y + 1.0f;
+    return p * detail::fromBits((detail::toInt(n) + 127) << 23); // Scale by 2^n
+}
+
+// Inputs must be positive normal floats; zero, negatives and denormals are not handled
+template <typename T> inline T log2(T x) {
+    auto b = detail::bits(x);
+    T e = detail::toFloat((b >> 23) - 127);
+    T m = detail::fromBits((b & 0x007FFFFF) | 0x3F800000); // Mantissa in [1, 2)
+    auto high = m > 1.41421356f;                          // Re-centre on 1: [sqrt(0.5), sqrt(2))
+    m = detail::select(high, m * 0.5f, m);
+    e = detail::select(high, e + 1.0f, e);
+    // log2(m) = 2 / ln(2) * atanh(s), s = (m - 1) / (m + 1), |s| <= 0.172
+    T s = (m - 1.0f) / (m + 1.0f);
+    T s2 = s * s;
+    T p = s2 * (1.0f / 9.0f) + 1.0f / 7.0f;
+    p = p * s2 + 1.0f / 5.0f;
+    p = p * s2 + 1.0f / 3.0f;
+    p = p * s2 + 1.0f;
+    return e + s * p * 2.88539008178f;
+}
+
+// For saturation stages; accurate in absolute terms, flat at +/-1 beyond |x| = 9
+template <typename T> inline T tanh(T x) {
+    T e = exp2(detail::clamp(x, -9.0f, 9.0f) * 2.88539008178f); // e^(2x)
+    return (e - 1.0f) / (e + 1.0f);
+}
+
+// MIDI note (fractional allowed) to frequency in Hz
+template <typename T> inline T mtof(T note) { return exp2((note - 69.0f) * (1.0f / 12.0f)) * 440.0f; }
+
+// Batch versions: out[i] = f(in[i]); `in` and `out` may be the same array
+inline void sin2pi(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return sin2pi(v); }); }
+inline void cos2pi(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return cos2pi(v); }); }
+inline void sin(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return sin(v); }); }
+inline void cos(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return cos(v); }); }
+inline void tan(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return tan(v); }); }
+inline void exp2(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return exp2(v); }); }
+inline void log2(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return log2(v); }); }
+inline void tanh(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return tanh(v); }); }
+inline void mtof(const float* in, float* out, int count) { detail::batch(in, out, count, [](auto v) { return mtof(v); }); }
+
+} // namespace FastMath
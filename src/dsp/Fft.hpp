@@ -0,0 +1,108 @@
+#pragma once
+#include <cmath>
+#include <vector>
+
+// Real FFT of a power-of-two size N, built on an N/2-point complex radix-2 FFT.
+// Spectra are split into separate real and imaginary arrays of N/2 + 1 bins so
+// that spectral multiply-accumulate loops vectorize. Tables and scratch are
+// allocated in the constructor; forward() and inverse() never allocate.
+class Fft {
+public:
+    explicit Fft(int size) : n(size), m(size / 2) {
+        cosTable.resize(m / 2 + 1);
+        sinTable.resize(m / 2 + 1);
+        for (int k = 0; k <= m / 2; ++k) {
+            cosTable[k] = std::cos(2.0 * M_PI * k / m);
+            sinTable[k] = std::sin(2.0 * M_PI * k / m);
+        }
+        splitCos.resize(m + 1);
+        splitSin.resize(m + 1);
+        for (int k = 0; k <= m; ++k) {
+            splitCos[k] = std::cos(2.0 * M_PI * k / n);
+            splitSin[k] = std::sin(2.0 * M_PI * k / n);
+        }
+        bitReverse.resize(m);
+        int bits = 0;
+        while ((1 << bits) < m) ++bits;
+        for (int i = 0; i < m; ++i) {
+            int r = 0;
+            for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+            bitReverse[i] = r;
+        }
+        zr.resize(m);
+        zi.resize(m);
+    }
+
+    int getSize() const { return n; }
+    int getNumBins() const { return m + 1; }
+
+    // x: n real samples -> re/im: n/2 + 1 bins
+    void forward(const float* x, float* re, float* im) {
+        for (int k = 0; k < m; ++k) {
+            int r = bitReverse[k];
+            zr[r] = x[2 * k];
+            zi[r] = x[2 * k + 1];
+        }
+        transform(-1.0f);
+
+        // Split the packed even/odd transform into the real signal's spectrum
+        re[0] = zr[0] + zi[0];
+        im[0] = 0.0f;
+        re[m] = zr[0] - zi[0];
+        im[m] = 0.0f;
+        for (int k = 1; k < m; ++k) {
+            float ar = zr[k], ai = zi[k], br = zr[m - k], bi = -zi[m - k]; // b = conj(Z[m - k])
+            float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);             // Even samples
+            float dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+            float orr = di, oi = -dr;                                       // Odd samples: d / i
+            float wr = splitCos[k], wi = -splitSin[k];
+            re[k] = er + wr * orr - wi * oi;
+            im[k] = ei + wr * oi + wi * orr;
+        }
+    }
+
+    // re/im: n/2 + 1 bins -> x: n real samples (scaled so inverse(forward(x)) == x)
+    void inverse(const float* re, const float* im, float* x) {
+        for (int k = 0; k < m; ++k) {
+            float ar = re[k], ai = im[k], br = re[m - k], bi = -im[m - k]; // b = conj(X[m - k])
+            float er = ar + br, ei = ai + bi;                               // 2 * even spectrum
+            float dr = ar - br, di = ai - bi;                               // 2 * W^k * odd spectrum
+            float wr = splitCos[k], wi = splitSin[k];                       // Divide by W^k
+            float orr = dr * wr - di * wi, oi = dr * wi + di * wr;
+            int r = bitReverse[k];
+            zr[r] = er - oi; // even + i * odd
+            zi[r] = ei + orr;
+        }
+        transform(1.0f);
+        float scale = 0.5f / m;
+        for (int k = 0; k < m; ++k) {
+            x[2 * k] = zr[k] * scale;
+            x[2 * k + 1] = zi[k] * scale;
+        }
+    }
+
+private:
+    int n, m;
+    std::vector<float> cosTable, sinTable, splitCos, splitSin;
+    std::vector<int> bitReverse;
+    std::vector<float> zr, zi;
+
+    // In-place iterative radix-2 on zr/zi, input already in bit-reversed order
+    void transform(float sign) {
+        for (int len = 2; len <= m; len <<= 1) {
+            int half = len / 2, step = m / len;
+            for (int i = 0; i < m; i += len) {
+                for (int j = 0; j < half; ++j) {
+                    float wr = cosTable[j * step], wi = sign * sinTable[j * step]; // j * step < m / 2
+                    int a = i + j, b = a + half;
+                    float tr = zr[b] * wr - zi[b] * wi;
+                    float ti = zr[b] * wi + zi[b] * wr;
+                    zr[b] = zr[a] - tr;
+                    zi[b] = zi[a] - ti;
+                    zr[a] += tr;
+                    zi[a] += ti;
+                }
+            }
+        }
+    }
+};
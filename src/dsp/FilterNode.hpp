@@ -1,5 +1,7 @@
 #pragma once
 #include "DspNode.hpp"
+#include "FastMath.hpp"
+#include "KernelTable.hpp"
 #include <algorithm>
 
 enum class FilterType { LowPass, HighPass, BandPass };
@@ -8,44 +10,125 @@ class FilterNode : public DspNode {
 public:
     void setCutoff(float c) { cutoff = c; calculateCoefficients(); }
     void setResonance(float r) { resonance = std::max(0.0f, std::min(r, 0.99f)); calculateCoefficients(); }
+    float getCutoff() const { return cutoff; }
+    float getResonance() const { return resonance; }
+    void setType(FilterType t) { type = t; }
+    FilterType getType() const { return type; }
+
+    // Glide the coefficients linearly to a new cutoff/resonance over the next `frames`
+    // samples. Coefficients are computed once here, so modulation costs nothing per sample.
+    void rampTo(float c, float r, int frames) {
+        float fStart = f, qStart = q;
+        cutoff = c;
+        resonance = std::max(0.0f, std::min(r, 0.99f));
+        calculateCoefficients();
+        if (frames <= 0) return;
+        fStep = (f - fStart) / frames;
+        qStep = (q - qStart) / frames;
+        fTarget = f;
+        qTarget = q;
+        f = fStart;
+        q = qStart;
+        rampFrames = frames;
+    }
+
+    void prepare(double sr, int bs) override {
+        DspNode::prepare(sr, bs);
+        calculateCoefficients(); // Coefficients depend on the sample rate
+    }
+
+    void reset() override {
+        for (auto& s : state) s = FilterState();
+    }
     
-    // In a modular graph, a filter processes an input. 
-    // We could accept an input buffer or just process in-place.
-    // Let's assume in-place for this simple chain.
+    const char* getName() const override { return "FilterNode"; }
+
+    // In place. The output type and channel count are picked once per block, so each
+    // kernel runs every channel through one loop with no per-sample branches.
     void process(DspBuffer& buffer) override {
-        int frames = buffer.getNumFrames();
-        int channels = buffer.getNumChannels();
-        
-        for (int c = 0; c < channels; ++c) {
-            float* data = buffer.getChannel(c);
-            
-            // We need separate state per channel
-            if (state.size() < (size_t)channels) state.resize(channels);
-            
-            for (int i = 0; i < frames; ++i) {
-                float input = data[i];
-                float low = state[c].buf1 + f * state[c].buf0;
-                float high = input - low - q * state[c].buf0;
-                float band = f * high + state[c].buf0;
-                
-                state[c].buf0 = band;
-                state[c].buf1 = low;
-                
-                data[i] = low; // LowPass only for now
-            }
-        }
+        static constexpr auto kernels = KernelTable<Kernel, TYPES, DspBuffer::MAX_CHANNELS>::make<TypeKernel>();
+        kernels.select((int)type, buffer.getNumChannels())(*this, buffer);
     }
     
 private:
     float cutoff = 2000.0f;
     float resonance = 0.5f;
     float f = 0.0f, q = 0.0f;
+    float fStep = 0.0f, qStep = 0.0f, fTarget = 0.0f, qTarget = 0.0f;
+    int rampFrames = 0;
+    FilterType type = FilterType::LowPass;
     
     struct FilterState { float buf0 = 0; float buf1 = 0; };
-    std::vector<FilterState> state;
+    FilterState state[DspBuffer::MAX_CHANNELS]; // Per channel, inline so a voice's state is one block
+
+    static const int TYPES = 3;
+    using Kernel = void (*)(FilterNode&, DspBuffer&);
+
+    template <int T, int C>
+    struct TypeKernel {
+        static void run(FilterNode& filter, DspBuffer& buffer) { filter.render<(FilterType)T, C>(buffer); }
+    };
+
+    template <FilterType T, int C>
+    void render(DspBuffer& buffer) {
+        int frames = buffer.getNumFrames();
+        int ramp = std::min(rampFrames, frames);
+        
+        // Register copies of the state; channels share the coefficients and the loop
+        float* data[C];
+        float buf0[C], buf1[C];
+        for (int c = 0; c < C; ++c) {
+            data[c] = buffer.getChannel(c);
+            buf0[c] = state[c].buf0;
+            buf1[c] = state[c].buf1;
+        }
+        
+        float fc = f, qc = q; // Every channel sees the same coefficient ramp
+        int i = 0;
+        for (; i < ramp; ++i) {
+            fc += fStep;
+            qc += qStep;
+            tick<T, C>(data, buf0, buf1, i, fc, qc);
+        }
+        for (; i < frames; ++i) tick<T, C>(data, buf0, buf1, i, fc, qc);
+        
+        for (int c = 0; c < C; ++c) {
+            state[c].buf0 = buf0[c];
+            state[c].buf1 = buf1[c];
+        }
+        if (ramp > 0) {
+            rampFrames -= ramp;
+            f = rampFrames > 0 ? f + fStep * ramp : fTarget;
+            q = rampFrames > 0 ? q + qStep * ramp : qTarget;
+        }
+    }
+
+    template <FilterType T, int C>
+    static void tick(float* const* data, float* buf0, float* buf1, int i, float fc, float qc) {
+        for (int c = 0; c < C; ++c) {
+            float input = data[c][i];
+            float low = buf1[c] + fc * buf0[c];
+            float high = input - low - qc * buf0[c];
+            float band = fc * high + buf0[c];
+            
+            buf0[c] = band;
+            buf1[c] = low;
+            
+            if constexpr (T == FilterType::LowPass) data[c][i] = low;
+            else if constexpr (T == FilterType::HighPass) data[c][i] = high;
+            else data[c][i] = band;
+        }
+    }
+
+    // The SVF is stable while f^2 + 2fq < 4. f + q <= 2 - margin stays inside that and is a
+    // straight line, so the linear coefficient ramps between two clamped points are stable too.
+    // That caps the cutoff at about 0.3 fs for q = 0.3 and 0.15 fs for q = 1.
+    static constexpr float STABILITY_MARGIN = 0.1f;
 
     void calculateCoefficients() {
-        f = 2.0f * std::sin(M_PI * cutoff / sampleRate);
+        rampFrames = 0; // A direct set ends any glide
         q = 1.0f - resonance;
+        f = 2.0f * FastMath::sin2pi((float)(0.5 * cutoff / sampleRate));
+        f = std::min(f, 2.0f - STABILITY_MARGIN - q);
     }
 };
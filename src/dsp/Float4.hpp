@@ -0,0 +1,21 @@
+#pragma once
+
+// Four-lane float vector via the GCC/Clang vector extension.
+// Lowers to SSE on x86 and NEON on ARM without per-ISA intrinsics.
+typedef float Float4 __attribute__((vector_size(16)));
+typedef int Int4 __attribute__((vector_size(16)));
+typedef unsigned int UInt4 __attribute__((vector_size(16)));
+
+inline Float4 splat4(float v) { return Float4{ v, v, v, v }; }
+
+// Per-lane mask ? a : b, with masks as produced by vector comparisons (all ones / zero)
+inline Float4 select4(Int4 mask, Float4 a, Float4 b) {
+    return (Float4)((mask & (Int4)a) | (~mask & (Int4)b));
+}
+
+inline float sum4(Float4 v) { return (v[0] + v[1]) + (v[2] + v[3]); }
+
+// 32-bit fixed-point phase (wraps for free) to [0, 1) float; keeps the top 24 bits
+inline Float4 phaseToFloat4(UInt4 phase) {
+    return __builtin_convertvector((Int4)(phase >> 8), Float4) * splat4(1.0f / 16777216.0f);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "CpuDispatch.hpp"
+#include <algorithm>
+#include <utility>
+
+// Function-pointer table over every (mode, width) combination of a templated kernel.
+// A node writes its inner loop once as K<MODE, WIDTH>::run with both values known at
+// compile time (mode: waveform, filter type...; width: channels, SIMD groups...), and
+// picks the instance once per block instead of branching per sample:
+//
+//     template <int M, int W> struct Kernel { static void run(Node& n, DspBuffer& b) { ... } };
+//     static constexpr auto kernels = KernelTable<void (*)(Node&, DspBuffer&), MODES, WIDTHS>::make<Kernel>();
+//     kernels.select((int)mode, width)(*this, buffer);
+//
+// Widths run 1..WIDTHS; select() clamps to that range. Every instance is also built for
+// each ISA in CpuDispatch, and select() takes the active one. The table is built at compile time.
+template <typename Fn, int MODES, int WIDTHS>
+struct KernelTable {
+    struct Row { Fn kernels[MODES * WIDTHS]; };
+    Row isas[CpuDispatch::ISA_COUNT];
+
+    template <template <int, int> class K>
+    static constexpr KernelTable make() {
+        auto all = std::make_index_sequence<MODES * WIDTHS>();
+        return { { row<K, CpuIsa::Baseline>(all), row<K, CpuIsa::Avx2>(all), row<K, CpuIsa::Avx512>(all) } };
+    }
+
+    Fn select(int mode, int width) const {
+        return isas[(int)CpuDispatch::isa()].kernels[mode * WIDTHS + std::max(1, std::min(width, WIDTHS)) - 1];
+    }
+
+private:
+    template <template <int, int> class K, CpuIsa I, size_t... N>
+    static constexpr Row row(std::index_sequence<N...>) {
+        return { { &IsaKernel<I, K<(int)(N / WIDTHS), (int)(N % WIDTHS) + 1>, Fn>::run... } };
+    }
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include "DspNode.hpp"
+#include "FastMath.hpp"
+#include "Float4.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Delay time swept by a sine LFO. Small delays with no feedback give a chorus,
+// short delays with feedback a flanger, long unmodulated ones an echo.
+struct DelaySettings {
+    float delayMs = 15.0f;     // Centre delay
+    float depthMs = 3.0f;      // LFO swing either side of the centre, at most delayMs
+    float rateHz = 0.8f;
+    float feedback = 0.0f;     // -0.95..0.95
+    float stereoPhase = 0.25f; // Right channel LFO offset in turns
+
+    static DelaySettings chorus() { return { 15.0f, 3.0f, 0.8f, 0.0f, 0.25f }; }
+    static DelaySettings flanger() { return { 2.5f, 2.0f, 0.2f, 0.7f, 0.0f }; }
+    static DelaySettings echo() { return { 375.0f, 0.0f, 0.0f, 0.45f, 0.0f }; }
+};
+
+// Stereo fractional delay line, output fully wet.
+// Each channel has a power-of-two ring sized when the settings or sample rate change,
+// so processing never allocates and wraps with a mask. Samples are read four at a
+// time: the LFO, read positions and 4-point Hermite interpolation run in Float4 lanes,
+// and only the ring taps are gathered one by one. The delay never drops below
+// MIN_DELAY frames, so a group's taps were all written before the group starts and
+// feedback can be written back after the vector read.
+class ModulatedDelay : public DspNode {
+public:
+    static const int MIN_DELAY = 8;
+    static constexpr float MAX_DELAY_MS = 2000.0f;
+
+    // Allocates when the ring has to grow; call from the control thread
+    void setSettings(const DelaySettings& s) {
+        settings = s;
+        settings.delayMs = std::max(0.0f, std::min(settings.delayMs, MAX_DELAY_MS));
+        settings.depthMs = std::max(0.0f, std::min(settings.depthMs, settings.delayMs));
+        settings.rateHz = std::max(0.0f, settings.rateHz);
+        settings.feedback = std::max(-0.95f, std::min(settings.feedback, 0.95f));
+        configured = true;
+        updateRing();
+    }
+    const DelaySettings& getSettings() const { return settings; }
+    bool isConfigured() const { return configured; }
+
+    void prepare(double sr, int bs) override {
+        DspNode::prepare(sr, bs);
+        if (configured) updateRing();
+    }
+
+    void reset() override {
+        for (auto& line : lines) std::fill(line.begin(), line.end(), 0.0f);
+        writePos = 0;
+        lfoPhase = 0.0;
+    }
+
+    // Frames until the output falls 80 dB below the last input
+    static int tailFrames(const DelaySettings& s, double sr) {
+        float fb = std::min(std::abs(s.feedback), 0.95f);
+        int repeats = fb > 0.0f ? (int)std::ceil(std::log(1e-4) / std::log(fb)) : 1;
+        return (int)std::ceil((s.delayMs + s.depthMs) * 0.001 * sr) * repeats + MIN_DELAY;
+    }
+    int getTailFrames() const { return tailFrames(settings, sampleRate); }
+
+    const char* getName() const override { return "ModulatedDelay"; }
+
+    // Move the LFO and write position on as process() would, leaving the ring as it is
+    void advance(int frames) {
+        if (lines[0].empty()) return;
+        float increment = (float)(settings.rateHz / sampleRate);
+        writePos = (writePos + (uint32_t)frames) & mask;
+        lfoPhase += (double)increment * frames;
+        lfoPhase -= std::floor(lfoPhase);
+    }
+
+    void process(DspBuffer& buffer) override {
+        if (lines[0].empty()) return;
+        int frames = buffer.getNumFrames();
+        int channels = std::min(buffer.getNumChannels(), 2);
+
+        // The integer part of the centre delay is applied in the index domain so the
+        // float maths only sees the swing, and keeps its fractional precision
+        float centre = settings.delayMs * 0.001f * (float)sampleRate;
+        int centreFrames = (int)centre;
+        float centreFrac = centre - (float)centreFrames;
+        float depth = settings.depthMs * 0.001f * (float)sampleRate;
+        float shortest = (float)(MIN_DELAY - centreFrames);
+        float increment = (float)(settings.rateHz / sampleRate);
+        const Float4 lane = { 0.0f, 1.0f, 2.0f, 3.0f };
+
+        for (int c = 0; c < channels; ++c) {
+            float* x = buffer.getChannel(c);
+            float* ring = lines[c].data();
+            uint32_t w = writePos;
+            double phase = lfoPhase + (c == 1 ? settings.stereoPhase : 0.0f);
+            phase -= std::floor(phase);
+
+            for (int i = 0; i < frames; i += 4) {
+                int n = std::min(4, frames - i);
+
+                Float4 sweep = FastMath::sin2pi(splat4((float)phase) + lane * increment);
+                Float4 delay = splat4(centreFrac) + sweep * depth; // Minus centreFrames
+                delay = select4(delay < shortest, splat4(shortest), delay);
+
+                // Read position relative to w + centreFrames, floored
+                Float4 pos = lane - delay;
+                Int4 whole = __builtin_convertvector(pos, Int4);
+                whole += (Int4)(__builtin_convertvector(whole, Float4) > pos); // Truncation rounds negatives up
+                Float4 t = pos - __builtin_convertvector(whole, Float4);
+
+                Float4 y0, y1, y2, y3;
+                for (int k = 0; k < 4; ++k) {
+                    uint32_t base = w - (uint32_t)centreFrames + (uint32_t)whole[k];
+                    y0[k] = ring[(base - 1) & mask];
+                    y1[k] = ring[base & mask];
+                    y2[k] = ring[(base + 1) & mask];
+                    y3[k] = ring[(base + 2) & mask];
+                }
+
+                // 4-point, 3rd-order Hermite
+                Float4 c1 = 0.5f * (y2 - y0);
+                Float4 c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+                Float4 c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+                Float4 wet = ((c3 * t + c2) * t + c1) * t + y1;
+
+                for (int k = 0; k < n; ++k) {
+                    ring[(w + k) & mask] = x[i + k] + settings.feedback * wet[k];
+                    x[i + k] = wet[k];
+                }
+                w += n;
+                phase += increment * n;
+                if (phase >= 1.0) phase -= 1.0;
+            }
+        }
+
+        writePos = (writePos + (uint32_t)frames) & mask;
+        lfoPhase += (double)increment * frames;
+        lfoPhase -= std::floor(lfoPhase);
+    }
+
+private:
+    DelaySettings settings;
+    bool configured = false;
+    std::vector<float> lines[2];
+    uint32_t mask = 0;
+    uint32_t writePos = 0;
+    double lfoPhase = 0.0; // Turns
+
+    void updateRing() {
+        int needed = (int)std::ceil((settings.delayMs + settings.depthMs) * 0.001 * sampleRate) + MIN_DELAY + 4;
+        size_t size = 1;
+        while (size < (size_t)needed) size <<= 1;
+        if (lines[0].size() >= size) return;
+        for (auto& line : lines) line.assign(size, 0.0f);
+        mask = (uint32_t)size - 1;
+        writePos = 0;
+    }
+};
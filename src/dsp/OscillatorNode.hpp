@@ -1,67 +1,142 @@
 #pragma once
 #include "DspNode.hpp"
+#include "FastMath.hpp"
+#include "KernelTable.hpp"
+#include <algorithm>
 #include <cmath>
 
 enum class Waveform { Sine, Triangle, Saw, Square };
 
 class OscillatorNode : public DspNode {
 public:
-    void setFrequency(float freq) { frequency = freq; }
+    void setFrequency(float freq) { frequency = freq; rampFrames = 0; }
+    
+    // Glide to `freq` over the next `frames` samples, exponentially (linear in pitch).
+    // The increment is multiplied by a fixed ratio each sample: one exp2/log2 pair per
+    // glide and no division or pow in the sample loop, so per-sample pitch modulation is cheap.
+    void rampFrequency(float freq, int frames) {
+        double from = rampFrames > 0 ? phaseIncrement : frequency / sampleRate; // Continue from mid-glide
+        frequency = freq;
+        double to = frequency / sampleRate;
+        if (frames <= 0 || from <= 0.0 || to <= 0.0) {
+            rampFrames = 0;
+            return;
+        }
+        rampFrames = frames;
+        rampRatio = FastMath::exp2(FastMath::log2((float)(to / from)) / frames);
+        phaseIncrement = from;
+    }
     void setWaveform(Waveform w) { waveform = w; }
+    void reset() override { phase = 0.0; }
     
-    void process(DspBuffer& outputBuffer) override {
-        float* channel0 = outputBuffer.getChannel(0);
-        float* channel1 = outputBuffer.getNumChannels() > 1 ? outputBuffer.getChannel(1) : nullptr;
-        int frames = outputBuffer.getNumFrames();
-        
-        // Simple PolyBLEP implementation inline or calling a helper
-        for (int i = 0; i < frames; ++i) {
-            phaseIncrement = (2.0 * M_PI * frequency) / sampleRate;
-            
-            float sample = 0.0f;
-            double t = phase / (2.0 * M_PI);
-            
-            // Re-using the logic from the old Oscillator.cpp for simplicity but modularized
-            switch (waveform) {
-                case Waveform::Sine: sample = std::sin(phase); break;
-                case Waveform::Saw: 
-                    // Naive Saw for now to verify graph, restore PolyBLEP later if needed or copy it
-                    sample = -1.0 + 2.0 * t; 
-                    sample -= polyBLEP(t); // Anti-aliased
-                    sample *= -1.0;
-                    break;
-                case Waveform::Square:
-                {
-                    double naive = (t < 0.5) ? 1.0 : -1.0;
-                    double pb = polyBLEP(t);
-                    pb -= polyBLEP(fmod(t + 0.5, 1.0));
-                    sample = naive + pb;
-                    break;
-                }
-                case Waveform::Triangle:
-                     double value = phase / (2.0 * M_PI);
-                     if (value < 0.5) sample = -1.0 + 4.0 * value;
-                     else sample = 3.0 - 4.0 * value;
-                    break;
+    // Move the phase forward without producing output. A frequency ramp is followed
+    // sample by sample, as render() would, so glides leave the phase where they should.
+    void advance(int frames) {
+        int ramp = std::min(rampFrames, frames);
+        if (ramp > 0) {
+            double t = phase, dt = phaseIncrement;
+            for (int i = 0; i < ramp; ++i) {
+                dt *= rampRatio;
+                t += dt;
+                if (t >= 1.0) t -= 1.0;
             }
-            
-            phase += phaseIncrement;
-            if (phase >= 2.0 * M_PI) phase -= 2.0 * M_PI;
-            
-            // Write to all channels (mono source)
-            channel0[i] = sample * 0.5f; // Headroom
-            if (channel1) channel1[i] = sample * 0.5f;
+            phase = t;
+            phaseIncrement = dt;
+            rampFrames -= ramp;
+            frames -= ramp;
+            if (rampFrames > 0) return;
         }
+        phaseIncrement = frequency / sampleRate;
+        phase = std::fmod(phase + frames * phaseIncrement, 1.0);
+    }
+    
+    const char* getName() const override { return "OscillatorNode"; }
+
+    // The waveform and channel count are picked once per block; each kernel is a
+    // straight-line loop with no per-sample switch
+    void process(DspBuffer& outputBuffer) override {
+        static constexpr auto kernels = KernelTable<Kernel, WAVEFORMS, 2>::make<WaveKernel>();
+        kernels.select((int)waveform, outputBuffer.getNumChannels())(*this, outputBuffer);
     }
     
 private:
-    double phase = 0.0;
+    double phase = 0.0;          // Turns
     double frequency = 440.0;
-    double phaseIncrement = 0.0;
+    double phaseIncrement = 0.0; // Turns per sample
+    double rampRatio = 1.0;
+    int rampFrames = 0;
     Waveform waveform = Waveform::Saw;
     
-    double polyBLEP(double t) {
-        double dt = phaseIncrement / (2.0 * M_PI);
+    static const int WAVEFORMS = 4;
+    using Kernel = void (*)(OscillatorNode&, DspBuffer&);
+
+    template <int W, int C>
+    struct WaveKernel {
+        static void run(OscillatorNode& osc, DspBuffer& buffer) { osc.render<(Waveform)W, C>(buffer); }
+    };
+
+    template <Waveform W, int C>
+    void render(DspBuffer& outputBuffer) {
+        float* channel0 = outputBuffer.getChannel(0);
+        float* channel1 = C > 1 ? outputBuffer.getChannel(1) : nullptr;
+        int frames = outputBuffer.getNumFrames();
+        
+        int ramp = std::min(rampFrames, frames);
+        if (ramp == 0) phaseIncrement = frequency / sampleRate; // Static between blocks
+        
+        // Register copies; the output pointers could otherwise alias the state
+        double t = phase, dt = phaseIncrement;
+        const double ratio = rampRatio;
+        int i = 0;
+        for (; i < ramp; ++i) {
+            dt *= ratio;
+            write<C>(channel0, channel1, i, sample<W>(t, dt));
+            t += dt;
+            if (t >= 1.0) t -= 1.0;
+        }
+        for (; i < frames; ++i) {
+            write<C>(channel0, channel1, i, sample<W>(t, dt));
+            t += dt;
+            if (t >= 1.0) t -= 1.0;
+        }
+        phase = t;
+        phaseIncrement = dt;
+        rampFrames -= ramp;
+        if (ramp > 0 && rampFrames == 0) phaseIncrement = frequency / sampleRate; // Land exactly on the target
+    }
+
+    // Write to all channels (mono source)
+    template <int C>
+    static void write(float* channel0, float* channel1, int i, float sample) {
+        channel0[i] = sample * 0.5f; // Headroom
+        if constexpr (C > 1) channel1[i] = sample * 0.5f;
+    }
+
+    template <Waveform W>
+    static float sample(double t, double dt) {
+        float sample = 0.0f;
+        if constexpr (W == Waveform::Sine) {
+            sample = FastMath::sin2pi((float)t);
+        } else if constexpr (W == Waveform::Saw) {
+            sample = -1.0 + 2.0 * t;
+            sample -= polyBLEP(t, dt); // Anti-aliased
+            sample *= -1.0;
+        } else if constexpr (W == Waveform::Square) {
+            double naive = (t < 0.5) ? 1.0 : -1.0;
+            double pb = polyBLEP(t, dt);
+            double t2 = t + 0.5;
+            if (t2 >= 1.0) t2 -= 1.0;
+            pb -= polyBLEP(t2, dt);
+            sample = naive + pb;
+        } else {
+            if (t < 0.5) sample = -1.0 + 4.0 * t;
+            else sample = 3.0 - 4.0 * t;
+        }
+        return sample;
+    }
+    
+    // Divides only inside the two-sample transition around each discontinuity
+    static double polyBLEP(double t, double dt) {
         if (t < dt) {
             t /= dt;
             return t+t - t*t - 1.0;
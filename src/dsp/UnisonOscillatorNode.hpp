@@ -0,0 +1,183 @@
+#pragma once
+#include "DspNode.hpp"
+#include "OscillatorNode.hpp"
+#include "FastMath.hpp"
+#include "KernelTable.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Stack of up to 16 detuned copies of one waveform, summed to stereo with spread.
+// Copies live in four-wide SIMD lanes (Float4) and run through a branch-free
+// PolyBLEP, so a 16-copy stack is four vector iterations per sample. Phases are
+// 32-bit fixed point so wrapping costs nothing and never sits on the critical path.
+class UnisonOscillatorNode : public DspNode {
+public:
+    static constexpr int MAX_VOICES = 16;
+
+    UnisonOscillatorNode() { reset(); }
+
+    void setFrequency(float freq) { frequency = freq; updateLanes(); }
+    void setWaveform(Waveform w) { waveform = w; }
+
+    // count: copies (1..16), detune: 0..1 (max +/-50 cents), spread: 0..1 stereo width
+    void setUnison(int count, float detune, float spread) {
+        voices = std::max(1, std::min(count, MAX_VOICES));
+        detuneAmount = detune;
+        spreadAmount = spread;
+        updateLanes();
+    }
+    int getVoiceCount() const { return voices; }
+
+    // Control-rate pitch modulation: scales every lane without redoing the detune maths.
+    // Stepped, not ramped; phases stay continuous so a step every few samples is inaudible.
+    void setPitchRatio(float ratio) {
+        pitchRatio = ratio;
+        applyPitch();
+    }
+
+    void prepare(double sr, int bs) override {
+        DspNode::prepare(sr, bs);
+        updateLanes();
+    }
+
+    void reset() override {
+        // Fixed, decorrelated start phases keep renders reproducible
+        for (int k = 0; k < MAX_VOICES; ++k) {
+            phase[k / 4][k % 4] = (uint32_t)(std::fmod(k * 0.618034, 1.0) * 4294967296.0);
+        }
+    }
+
+    void advance(int frames) {
+        for (int g = 0; g < GROUPS; ++g) {
+            phase[g] += phaseStep[g] * (unsigned)frames; // Modular, like the per-sample accumulation
+        }
+    }
+
+    const char* getName() const override { return "UnisonOscillatorNode"; }
+
+    void process(DspBuffer& outputBuffer) override {
+        // Pick the waveform and group count once per block so the lane loop has no branches
+        static constexpr auto kernels = KernelTable<Kernel, 4, GROUPS>::make<LaneKernel>();
+        kernels.select((int)waveform, (voices + 3) / 4)(*this, outputBuffer);
+    }
+
+private:
+    static const int GROUPS = MAX_VOICES / 4;
+
+    // Lane state in groups of four; unused lanes have zero gain
+    UInt4 phase[GROUPS];
+    UInt4 phaseStep[GROUPS];
+    Float4 baseIncrement[GROUPS]; // Per-lane increment before pitch modulation
+    Float4 increment[GROUPS];
+    Float4 inverseIncrement[GROUPS];
+    Float4 gainL[GROUPS];
+    Float4 gainR[GROUPS];
+
+    double frequency = 440.0;
+    Waveform waveform = Waveform::Saw;
+    int voices = 1;
+    float detuneAmount = 0.0f;
+    float spreadAmount = 0.0f;
+    float pitchRatio = 1.0f;
+
+    using Kernel = void (*)(UnisonOscillatorNode&, DspBuffer&);
+
+    template <int W, int G>
+    struct LaneKernel {
+        static void run(UnisonOscillatorNode& node, DspBuffer& buffer) { node.processLanes<(Waveform)W, G>(buffer); }
+    };
+
+    template <Waveform W, int G>
+    void processLanes(DspBuffer& outputBuffer) {
+        float* outL = outputBuffer.getChannel(0);
+        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getChannel(1) : nullptr;
+        int frames = outputBuffer.getNumFrames();
+
+        // Work on register copies; the output pointers could otherwise alias the state
+        UInt4 ph[G], step[G];
+        Float4 inc[G], inv[G], gl[G], gr[G];
+        for (int g = 0; g < G; ++g) {
+            ph[g] = phase[g];
+            step[g] = phaseStep[g];
+            inc[g] = increment[g];
+            inv[g] = inverseIncrement[g];
+            gl[g] = gainL[g];
+            gr[g] = gainR[g];
+        }
+
+        for (int i = 0; i < frames; ++i) {
+            Float4 accL = splat4(0.0f), accR = splat4(0.0f);
+            // Fully unrolled so every group's state stays in registers
+#pragma GCC unroll 4
+            for (int g = 0; g < G; ++g) {
+                Float4 s = sampleLanes<W>(phaseToFloat4(ph[g]), inc[g], inv[g]);
+                accL += s * gl[g];
+                accR += s * gr[g];
+                ph[g] += step[g];
+            }
+            if (outR) {
+                outL[i] = sum4(accL);
+                outR[i] = sum4(accR);
+            } else {
+                outL[i] = 0.5f * (sum4(accL) + sum4(accR));
+            }
+        }
+
+        for (int g = 0; g < G; ++g) phase[g] = ph[g];
+    }
+
+    // Branch-free PolyBLEP: both polynomials are evaluated and selected per lane
+    static Float4 polyBLEP(Float4 t, Float4 dt, Float4 invDt) {
+        const Float4 one = splat4(1.0f), zero = splat4(0.0f);
+        Float4 a = t * invDt;
+        Float4 b = (t - one) * invDt;
+        Float4 head = a + a - a * a - one;
+        Float4 tail = b * b + b + b + one;
+        return select4(t > one - dt, tail, select4(t < dt, head, zero));
+    }
+
+    template <Waveform W>
+    static Float4 sampleLanes(Float4 t, Float4 dt, Float4 invDt) {
+        const Float4 one = splat4(1.0f), half = splat4(0.5f);
+        if constexpr (W == Waveform::Saw) {
+            return polyBLEP(t, dt, invDt) - (t + t - one);
+        } else if constexpr (W == Waveform::Square) {
+            Float4 t2 = t + half;
+            t2 = select4(t2 >= one, t2 - one, t2);
+            Float4 naive = select4(t < half, one, -one);
+            return naive + polyBLEP(t, dt, invDt) - polyBLEP(t2, dt, invDt);
+        } else if constexpr (W == Waveform::Triangle) {
+            Float4 four = splat4(4.0f);
+            return select4(t < half, four * t - one, splat4(3.0f) - four * t);
+        } else {
+            return FastMath::sin2pi(t);
+        }
+    }
+
+    // Control-rate work: runs on note-on and parameter changes, never per sample
+    void updateLanes() {
+        float level = 0.5f / std::sqrt((float)voices); // Same headroom as OscillatorNode, constant power
+        for (int k = 0; k < MAX_VOICES; ++k) {
+            // Spread copies evenly over [-1, 1]; a single copy sits in the centre
+            float pos = voices > 1 ? (2.0f * k / (voices - 1) - 1.0f) : 0.0f;
+            double cents = pos * detuneAmount * 50.0;
+            baseIncrement[k / 4][k % 4] = (float)(frequency * std::pow(2.0, cents / 1200.0) / sampleRate);
+
+            float angle = (pos * spreadAmount + 1.0f) * 0.25f * (float)M_PI; // Equal-power pan
+            bool used = k < voices;
+            gainL[k / 4][k % 4] = used ? level * std::cos(angle) * (float)M_SQRT2 : 0.0f;
+            gainR[k / 4][k % 4] = used ? level * std::sin(angle) * (float)M_SQRT2 : 0.0f;
+        }
+        applyPitch();
+    }
+
+    void applyPitch() {
+        for (int g = 0; g < GROUPS; ++g) {
+            Float4 dt = baseIncrement[g] * pitchRatio;
+            dt = select4(dt > 0.5f, splat4(0.5f), dt);
+            increment[g] = dt;
+            inverseIncrement[g] = select4(dt > 0.0f, 1.0f / dt, splat4(0.0f));
+            phaseStep[g] = __builtin_convertvector(dt * 4294967296.0f, UInt4);
+        }
+    }
+};
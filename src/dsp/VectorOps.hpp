@@ -0,0 +1,154 @@
+#pragma once
+#include "CpuDispatch.hpp"
+#include "Float4.hpp"
+#include <cstring>
+
+// Whole-array loops used for mixing, gain and output, built for every ISA in CpuDispatch.
+// The loops step through 16 floats at a time in a generic vector, which the compiler
+// splits into whatever the target has: four SSE/NEON registers, two AVX2 or one AVX-512.
+// That needs no auto-vectorizer and no per-ISA intrinsics. The wrappers below call the
+// active version.
+namespace VectorOps {
+
+namespace kernels {
+
+const int LANES = 16;
+typedef float FloatWide __attribute__((vector_size(LANES * 4)));
+
+// By reference only: a 64-byte vector passed or returned by value uses a different calling
+// convention with and without AVX-512, and these are called from every ISA's clone
+inline void load(FloatWide& v, const float* p) { std::memcpy(&v, p, sizeof(v)); }
+inline void store(float* p, const FloatWide& v) { std::memcpy(p, &v, sizeof(v)); }
+
+struct Clear {
+    static void run(float* dst, int n) {
+        int i = 0;
+        for (; i + LANES <= n; i += LANES) store(dst + i, FloatWide{});
+        for (; i < n; ++i) dst[i] = 0.0f;
+    }
+};
+
+struct Add {
+    static void run(float* dst, const float* src, int n) {
+        int i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            FloatWide a, b;
+            load(a, dst + i);
+            load(b, src + i);
+            store(dst + i, a + b);
+        }
+        for (; i < n; ++i) dst[i] += src[i];
+    }
+};
+
+struct AddScaled {
+    static void run(float* dst, const float* src, float gain, int n) {
+        int i = 0;
+        FloatWide g = FloatWide{} + gain;
+        for (; i + LANES <= n; i += LANES) {
+            FloatWide a, b;
+            load(a, dst + i);
+            load(b, src + i);
+            store(dst + i, a + b * g);
+        }
+        for (; i < n; ++i) dst[i] += src[i] * gain;
+    }
+};
+
+struct Multiply {
+    static void run(float* dst, const float* src, int n) {
+        int i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            FloatWide a, b;
+            load(a, dst + i);
+            load(b, src + i);
+            store(dst + i, a * b);
+        }
+        for (; i < n; ++i) dst[i] *= src[i];
+    }
+};
+
+struct Scale {
+    static void run(float* dst, float gain, int n) {
+        int i = 0;
+        FloatWide g = FloatWide{} + gain;
+        for (; i + LANES <= n; i += LANES) {
+            FloatWide a;
+            load(a, dst + i);
+            store(dst + i, a * g);
+        }
+        for (; i < n; ++i) dst[i] *= gain;
+    }
+};
+
+struct ScaleRamp {
+    static void run(float* dst, float start, float step, int n) {
+        int i = 0;
+        const FloatWide offsets = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+        for (; i + LANES <= n; i += LANES) {
+            FloatWide index = (FloatWide{} + (float)i) + offsets; // Exact: whole numbers below 2^24
+            FloatWide a;
+            load(a, dst + i);
+            store(dst + i, a * (start + step * index));
+        }
+        for (; i < n; ++i) dst[i] *= start + step * (i + 1);
+    }
+};
+
+// Four frames at a time: a two-input shuffle of 16 lanes lowers to scalar moves on
+// narrower targets, while unpack-low/high of four lanes is one instruction everywhere
+struct Interleave {
+    static void run(float* dst, const float* left, const float* right, int n) {
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            Float4 l, r;
+            std::memcpy(&l, left + i, sizeof(l));
+            std::memcpy(&r, right + i, sizeof(r));
+            Float4 low = __builtin_shufflevector(l, r, 0, 4, 1, 5);
+            Float4 high = __builtin_shufflevector(l, r, 2, 6, 3, 7);
+            std::memcpy(dst + i * 2, &low, sizeof(low));
+            std::memcpy(dst + i * 2 + 4, &high, sizeof(high));
+        }
+        for (; i < n; ++i) {
+            dst[i * 2] = left[i];
+            dst[i * 2 + 1] = right[i];
+        }
+    }
+};
+
+} // namespace kernels
+
+inline void clear(float* dst, int n) {
+    IsaDispatch<kernels::Clear, void (*)(float*, int)>::get()(dst, n);
+}
+
+// dst += src
+inline void add(float* dst, const float* src, int n) {
+    IsaDispatch<kernels::Add, void (*)(float*, const float*, int)>::get()(dst, src, n);
+}
+
+// dst += src * gain
+inline void addScaled(float* dst, const float* src, float gain, int n) {
+    IsaDispatch<kernels::AddScaled, void (*)(float*, const float*, float, int)>::get()(dst, src, gain, n);
+}
+
+// dst *= src, e.g. an envelope
+inline void multiply(float* dst, const float* src, int n) {
+    IsaDispatch<kernels::Multiply, void (*)(float*, const float*, int)>::get()(dst, src, n);
+}
+
+inline void scale(float* dst, float gain, int n) {
+    IsaDispatch<kernels::Scale, void (*)(float*, float, int)>::get()(dst, gain, n);
+}
+
+// dst[i] *= start + step * (i + 1): a linear fade that lands on start + step * n
+inline void scaleRamp(float* dst, float start, float step, int n) {
+    IsaDispatch<kernels::ScaleRamp, void (*)(float*, float, float, int)>::get()(dst, start, step, n);
+}
+
+// Planar stereo to left/right pairs
+inline void interleave(float* dst, const float* left, const float* right, int n) {
+    IsaDispatch<kernels::Interleave, void (*)(float*, const float*, const float*, int)>::get()(dst, left, right, n);
+}
+
+} // namespace VectorOps
@@ -10,8 +10,10 @@
 #include "AudioEngine.hpp"
 #include "MidiManager.hpp"
 #include "PresetManager.hpp"
+#include "Trace.hpp"
 #include <iostream>
 #include <cmath>
+#include <ctime>
 #include <vector>
 #include <string>
 
@@ -37,6 +39,24 @@ const ImU32 COL_KEY_WHITE     = IM_COL32(200, 200, 200, 255);
 const ImU32 COL_KEY_BLACK     = IM_COL32(10, 10, 10, 255);
 const ImU32 COL_KEY_ACTIVE    = COL_ACCENT;
 
+// Timestamped file name in the working directory, e.g. "BareMetalSynth-%Y%m%d-%H%M%S.wav"
+static std::string timestampedPath(const char* pattern) {
+    char name[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(name, sizeof(name), pattern, std::localtime(&now));
+    return name;
+}
+
+// Writes the trace rings out, at most once a second so a burst of xruns gives one file
+static void dumpTrace() {
+    static std::time_t lastDump = 0;
+    std::time_t now = std::time(nullptr);
+    if (now == lastDump) return;
+    lastDump = now;
+    std::string path = timestampedPath("BareMetalSynth-%Y%m%d-%H%M%S.trace.json");
+    if (Trace::writeChromeJson(path)) std::cerr << "trace written to " << path << std::endl;
+}
+
 // --- WIDGETS ---
 
 // Knob style
@@ -305,6 +325,27 @@ void frame(void) {
         ImGui::TextColored(ImVec4(0, 0.8f, 1.0f, 1.0f), "BARE METAL SYNTH"); 
         ImGui::SameLine(); ImGui::Text("Created by arasucar");
         
+        // Recorder: hour-long files so long sessions stay manageable
+        Recorder& recorder = g_audioEngine->getRecorder();
+        bool recording = recorder.isRecording();
+        ImGui::SameLine(width - 220);
+        if (ImGui::Button(recording ? "STOP" : "REC", ImVec2(60, 0))) {
+            if (recording) recorder.stop();
+            else if (!recorder.start(timestampedPath("BareMetalSynth-%Y%m%d-%H%M%S.wav"), 44100, RecordFormat::Wav, 3600.0)) std::cerr << recorder.getError() << std::endl;
+        }
+
+        // Tracing: the rings are dumped on every late callback, and once more when switched off
+        static uint64_t seenLate = 0;
+        bool tracing = Trace::isEnabled();
+        uint64_t late = g_audioEngine->getLateCallbacks();
+        if (tracing && late != seenLate) dumpTrace();
+        seenLate = late;
+        ImGui::SameLine(width - 290);
+        if (ImGui::Button(tracing ? "TRACING" : "TRACE", ImVec2(64, 0))) {
+            Trace::setEnabled(!tracing);
+            if (tracing) dumpTrace();
+        }
+
         ImGui::SameLine(width - 150);
         ImGui::SetNextItemWidth(100);
         if (ImGui::SliderFloat("##Master", &masterVol, 0.0f, 1.0f, "Vol %.2f")) {
@@ -340,7 +381,10 @@ void frame(void) {
         ImGui::Text("WAVE");
         
         ImGui::NextColumn();
-        Knob("DETUNE", &detune, 0.0f, 1.0f);
+        if (Knob("DETUNE", &detune, 0.0f, 1.0f)) {
+            // Any detune turns on a 7-voice unison stack
+            synth->setUnison(detune > 0.0f ? 7 : 1, detune, 1.0f);
+        }
         
         ImGui::NextColumn();
         Knob("LEVEL", &blend, 0.0f, 1.0f);
@@ -0,0 +1,112 @@
+/* rx-bare-metal embedding API.
+ *
+ * A plain C ABI for running the synth inside any host: create an engine, feed it MIDI
+ * events with sample offsets, and let it render straight into the host's buffers.
+ * Planar output is written in place with no intermediate copy; interleaved output is
+ * produced in the same pass that leaves the engine. All render state lives in one
+ * arena, so rx_process never allocates. An engine is not thread-safe: call rx_process
+ * from one thread and everything else between process calls (or send MIDI events).
+ */
+#ifndef RX_H
+#define RX_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define RX_EXPORT __declspec(dllexport)
+#else
+#define RX_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define RX_API_VERSION 3
+#define RX_CHANNELS 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rx_engine rx_engine;
+
+/* A MIDI channel message at a sample offset into the block passed to rx_process.
+ * Events are applied in order; an offset earlier than the previous one counts as that one. */
+typedef struct rx_event {
+    uint32_t frame;
+    uint8_t status; /* Status byte, channel in the low nibble */
+    uint8_t data1;
+    uint8_t data2;
+} rx_event;
+
+typedef enum rx_param {
+    RX_PARAM_MASTER_VOLUME,  /* 0..1 */
+    RX_PARAM_CUTOFF,         /* Hz */
+    RX_PARAM_RESONANCE,      /* 0..1 */
+    RX_PARAM_ATTACK,         /* Seconds */
+    RX_PARAM_DECAY,          /* Seconds */
+    RX_PARAM_SUSTAIN,        /* 0..1 */
+    RX_PARAM_RELEASE,        /* Seconds */
+    RX_PARAM_WAVEFORM,       /* 0 sine, 1 triangle, 2 saw, 3 square */
+    RX_PARAM_MOD_WHEEL,      /* 0..1 */
+    RX_PARAM_PITCH_BEND,     /* -1..1 of the bend range */
+    RX_PARAM_BEND_RANGE,     /* Semitones */
+    RX_PARAM_PORTAMENTO,     /* Seconds, 0 = off */
+    RX_PARAM_VIBRATO_RATE,   /* Hz */
+    RX_PARAM_VIBRATO_DEPTH,  /* Semitones, 0 = off */
+    RX_PARAM_COUNT
+} rx_param;
+
+/* Called after each rendered piece with the planar output, e.g. for meters or recording */
+typedef void (*rx_tap)(const float* const* channels, int frames, void* user);
+
+RX_EXPORT int rx_api_version(void);
+
+/* Starts on factory preset 0. NULL only if out of memory */
+RX_EXPORT rx_engine* rx_create(double sampleRate);
+/* Same, and records every MIDI event, parameter change and rendered block, with each
+ * process call's size and duration, to a binary log that rx-replay plays back. Logging
+ * is lock-free and costs a few stores per event. NULL if the log cannot be created. */
+RX_EXPORT rx_engine* rx_create_logged(double sampleRate, const char* eventLogPath);
+RX_EXPORT void rx_destroy(rx_engine* engine);
+
+/* Pins and touches the render state so the first blocks cannot page-fault; call before
+ * rendering in real time. Returns 1 if the memory is locked, 0 if only prefaulted. */
+RX_EXPORT int rx_prepare_realtime(rx_engine* engine);
+
+/* Renders `frames` into outs[0] (left) and outs[1] (right), overwriting them */
+RX_EXPORT void rx_process(rx_engine* engine, float** outs, int frames, const rx_event* events, int numEvents);
+/* Same, into one buffer of `frames` left/right pairs */
+RX_EXPORT void rx_process_interleaved(rx_engine* engine, float* out, int frames, const rx_event* events, int numEvents);
+
+RX_EXPORT void rx_set_param(rx_engine* engine, rx_param param, float value);
+RX_EXPORT float rx_get_param(const rx_engine* engine, rx_param param);
+RX_EXPORT const char* rx_param_name(rx_param param); /* "" if out of range */
+
+/* Factory presets; these allocate, so not from the audio thread */
+RX_EXPORT int rx_preset_count(void);
+RX_EXPORT const char* rx_preset_name(int index);
+RX_EXPORT int rx_load_preset(rx_engine* engine, int index); /* 0 if out of range */
+
+RX_EXPORT void rx_reset(rx_engine* engine); /* Silences every voice */
+RX_EXPORT void rx_set_tap(rx_engine* engine, rx_tap tap, void* user); /* NULL removes it */
+
+/* Automation lanes on a timeline of frames processed since rx_create or rx_set_position.
+ * Cutoff, resonance, the envelope stages and master volume can be automated; other
+ * parameters return 0. Lanes play back during rx_process unless recording. Adding points
+ * allocates, so not from the audio thread. */
+RX_EXPORT int rx_automation_add(rx_engine* engine, rx_param param, uint64_t frame, float value);
+RX_EXPORT void rx_automation_clear(rx_engine* engine);
+/* While on, rx_set_param also writes a breakpoint at the current position */
+RX_EXPORT void rx_automation_record(rx_engine* engine, int enabled);
+RX_EXPORT void rx_set_position(rx_engine* engine, uint64_t frame);
+RX_EXPORT uint64_t rx_get_position(const rx_engine* engine);
+
+#ifdef __cplusplus
+}
+
+// C++ hosts built with the engine (the app, tests) can reach it directly
+class SynthEngine;
+class RealtimeArena;
+RX_EXPORT SynthEngine* rx_get_synth(rx_engine* engine);
+RX_EXPORT const RealtimeArena* rx_get_arena(const rx_engine* engine);
+#endif
+
+#endif /* RX_H */
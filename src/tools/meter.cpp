@@ -0,0 +1,111 @@
+// Level meter on a running synth's shared output tap.
+//   rx-meter                   (peak and RMS per channel, ten times a second)
+//   rx-meter --blocks          (also the audio callback load and overruns)
+//   rx-meter -n /other-tap --interval 50 --seconds 30
+#include "../SharedTap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void usage() {
+    std::cerr << "usage: rx-meter [options]\n"
+              << "  -n <name>         shared tap to read (default: " << SharedTap::DEFAULT_NAME << ")\n"
+              << "  --interval <ms>   time between readings (default: 100)\n"
+              << "  --seconds <s>     stop after this long (default: run until killed)\n"
+              << "  --blocks          also show callback load and overruns from the block stats\n";
+}
+
+static float decibels(float level) {
+    return level > 1e-6f ? 20.0f * std::log10(level) : -120.0f;
+}
+
+// 30 columns from -60 to 0 dBFS
+static std::string bar(float db) {
+    int filled = std::max(0, std::min(30, (int)((db + 60.0f) / 2.0f)));
+    return std::string(filled, '#') + std::string(30 - filled, ' ');
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = SharedTap::DEFAULT_NAME;
+    int intervalMs = 100;
+    double seconds = 0.0;
+    bool showBlocks = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(arg, "-n") && hasValue) name = argv[++i];
+        else if (!std::strcmp(arg, "--interval") && hasValue) intervalMs = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--seconds") && hasValue) seconds = std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "--blocks")) showBlocks = true;
+        else { usage(); return 2; }
+    }
+
+    SharedTapReader reader;
+    std::vector<std::vector<float>> audio;
+    std::vector<float*> outs;
+    std::vector<SharedTapBlock> blocks(256);
+    uint64_t cursor = 0, blockCursor = 0;
+    uint64_t late = 0;
+    bool waiting = false;
+    auto start = std::chrono::steady_clock::now();
+
+    while (seconds <= 0.0 || std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        // Follow the synth across restarts
+        if (!reader.isLive()) {
+            if (!reader.open(name)) {
+                if (!waiting) std::cerr << reader.getError() << ", waiting..." << std::endl;
+                waiting = true;
+                continue;
+            }
+            waiting = false;
+            std::cerr << name << ": " << reader.getChannels() << " channels at " << reader.getSampleRate() << " Hz" << std::endl;
+            audio.assign(reader.getChannels(), std::vector<float>(reader.getCapacity()));
+            outs.clear();
+            for (auto& channel : audio) outs.push_back(channel.data());
+            cursor = reader.getWriteFrame(); // From now on, not the backlog
+            blockCursor = reader.getBlockCount();
+        }
+
+        int frames = reader.read(cursor, outs.data(), reader.getCapacity());
+        if (frames == 0) continue; // Nothing rendered: stopped, or the device is idle
+        std::string line;
+        for (int c = 0; c < reader.getChannels(); ++c) {
+            float peak = 0.0f;
+            double sum = 0.0;
+            for (int i = 0; i < frames; ++i) {
+                peak = std::max(peak, std::abs(audio[c][i]));
+                sum += (double)audio[c][i] * audio[c][i];
+            }
+            float rms = (float)std::sqrt(sum / frames);
+            char text[96];
+            std::snprintf(text, sizeof(text), "%c |%s| %6.1f peak %6.1f rms  ", c < 2 ? "LR"[c] : '0' + c,
+                          bar(decibels(peak)).c_str(), decibels(peak), decibels(rms));
+            line += text;
+        }
+        if (showBlocks) {
+            float load = 0.0f;
+            int n;
+            while ((n = reader.readBlocks(blockCursor, blocks.data(), (int)blocks.size())) > 0) {
+                for (int i = 0; i < n; ++i) {
+                    load = std::max(load, blocks[i].load);
+                    late = blocks[i].lateCallbacks;
+                }
+            }
+            char text[64];
+            std::snprintf(text, sizeof(text), "load %3.0f%%  late %llu", load * 100.0f, (unsigned long long)late);
+            line += text;
+        }
+        if (reader.getLostFrames() > 0) line += "  lost " + std::to_string(reader.getLostFrames());
+        std::cout << line << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+// Offline MIDI file renderer.
+//   rx-render song.mid -o song.wav
+//   rx-render -j 8 -o out/ corpus/*.mid      (batch mode, one engine per worker)
+//   rx-render --segmented long.mid -o long.wav (one file split across cores)
+//   rx-render --ir hall.wav --wet 0.4 song.mid  (convolution reverb on the master bus)
+//   rx-render --samples piano.map song.mid      (streamed multisample playback)
+//   rx-render --perf song.mid                   (hardware counters per render stage)
+//   rx-render --trace song.json song.mid        (Chrome trace of the render and worker threads)
+//   rx-render --automation sweep.txt song.mid   (parameter automation lanes)
+#include "../OfflineRenderer.hpp"
+#include "../SegmentedRenderer.hpp"
+#include "../Trace.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static void usage() {
+    std::cerr << "usage: rx-render [options] input.mid [more.mid ...]\n"
+              << "  -o <path>    output .wav (single file) or directory (batch)\n"
+              << "  -j <n>       worker threads for batch mode (default: all cores)\n"
+              << "  -r <rate>    sample rate (default: 44100)\n"
+              << "  -p <index>   factory preset (default: 0)\n"
+              << "  --pcm16      write 16-bit PCM instead of 32-bit float\n"
+              << "  --batch      batch mode even for a single input\n"
+              << "  --segmented  split a single input into segments rendered in parallel\n"
+              << "  --multi      16-part multitimbral playback (one part per MIDI channel)\n"
+              << "  --ir <wav>   convolution reverb impulse response (not with --multi or --segmented)\n"
+              << "  --wet <x>    reverb wet level (default: 0.3)\n"
+              << "  --samples <map>  play a sample map instead of the oscillators (not with --multi or --segmented)\n"
+              << "  --automation <txt>  automation lanes, lines of \"<target> <seconds> <value>\" (single input, not with --multi)\n"
+              << "  --perf       print per-stage hardware counters (single input, not with --multi)\n"
+              << "  --trace <json>  write a Chrome trace (chrome://tracing, ui.perfetto.dev) of the last events per thread\n";
+}
+
+static std::string wavPathFor(const std::string& midiPath, const std::string& outDir) {
+    std::string base = midiPath;
+    size_t slash = base.find_last_of('/');
+    if (!outDir.empty() && slash != std::string::npos) base = base.substr(slash + 1);
+    size_t dot = base.find_last_of('.');
+    if (dot != std::string::npos) base = base.substr(0, dot);
+    return (outDir.empty() ? "" : outDir + "/") + base + ".wav";
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string output;
+    int threads = 0;
+    double sampleRate = 44100.0;
+    int presetIndex = 0;
+    bool batch = false;
+    bool segmented = false;
+    bool multitimbral = false;
+    bool perf = false;
+    std::string tracePath;
+    std::string irPath;
+    std::string samplesPath;
+    std::string automationPath;
+    float wet = 0.3f;
+    WavFormat format = WavFormat::Float32;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(arg, "-o") && hasValue) output = argv[++i];
+        else if (!std::strcmp(arg, "-j") && hasValue) threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(arg, "-r") && hasValue) sampleRate = std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "-p") && hasValue) presetIndex = std::atoi(argv[++i]);
+        else if (!std::strcmp(arg, "--pcm16")) format = WavFormat::Pcm16;
+        else if (!std::strcmp(arg, "--batch")) batch = true;
+        else if (!std::strcmp(arg, "--segmented")) segmented = true;
+        else if (!std::strcmp(arg, "--multi")) multitimbral = true;
+        else if (!std::strcmp(arg, "--ir") && hasValue) irPath = argv[++i];
+        else if (!std::strcmp(arg, "--wet") && hasValue) wet = (float)std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "--samples") && hasValue) samplesPath = argv[++i];
+        else if (!std::strcmp(arg, "--automation") && hasValue) automationPath = argv[++i];
+        else if (!std::strcmp(arg, "--perf")) perf = true;
+        else if (!std::strcmp(arg, "--trace") && hasValue) tracePath = argv[++i];
+        else if (arg[0] == '-') { usage(); return 2; }
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) { usage(); return 2; }
+
+    Preset preset = PresetManager::getFactoryPreset(presetIndex);
+    if ((!irPath.empty() || !samplesPath.empty()) && (segmented || multitimbral)) {
+        std::cerr << "--ir and --samples are not supported with --segmented or --multi" << std::endl;
+        return 2;
+    }
+    if (!automationPath.empty() && (segmented || multitimbral || batch || inputs.size() > 1)) {
+        std::cerr << "--automation needs a single input without --segmented, --multi or --batch" << std::endl;
+        return 2;
+    }
+    if (perf && (segmented || multitimbral || batch || inputs.size() > 1)) {
+        std::cerr << "--perf needs a single input without --segmented, --multi or --batch" << std::endl;
+        return 2;
+    }
+
+    if (!tracePath.empty()) {
+        // Larger rings than the live default (~1.5 MB per thread) to keep more of the render
+        Trace::configure(1 << 16);
+        Trace::setEnabled(true);
+        RX_TRACE_THREAD("render");
+    }
+    // Written on every exit path below
+    struct TraceWriter {
+        const std::string& path;
+        ~TraceWriter() {
+            if (path.empty()) return;
+            Trace::setEnabled(false);
+            if (!Trace::writeChromeJson(path)) std::cerr << "cannot write " << path << std::endl;
+        }
+    } traceWriter{ tracePath };
+
+    if (segmented && inputs.size() == 1) {
+        MidiFile midi;
+        if (!midi.load(inputs[0])) {
+            std::cerr << inputs[0] << ": " << midi.getError() << std::endl;
+            return 1;
+        }
+        std::string wavPath = output.empty() ? wavPathFor(inputs[0], "") : output;
+        WavWriter writer;
+        if (!writer.open(wavPath, 2, (int)sampleRate, format)) {
+            std::cerr << "cannot write " << wavPath << std::endl;
+            return 1;
+        }
+        SegmentedRenderer renderer(sampleRate, threads);
+        renderer.setPreset(preset);
+        SegmentedStats stats = renderer.render(midi, writer);
+
+        int silentSeams = 0;
+        float worst = 0.0f;
+        for (const auto& seam : stats.seams) {
+            if (seam.silent) silentSeams++;
+            worst = std::max(worst, seam.maxError);
+        }
+        std::cout << wavPath << ": " << stats.segments.size() << " segments (" << silentSeams << "/" << stats.seams.size()
+                  << " seams at silence), worst seam error " << worst << (stats.seamsOk ? "" : " EXCEEDS TOLERANCE")
+                  << " (neighbouring segments only, not checked against a serial render)\n"
+                  << stats.audioSeconds << " s audio in " << stats.wallSeconds << " s ("
+                  << stats.audioSeconds / std::max(stats.wallSeconds, 1e-9) << "x realtime)" << std::endl;
+        return stats.seamsOk ? 0 : 1;
+    }
+
+    if (!batch && inputs.size() == 1) {
+        OfflineRenderer renderer(sampleRate);
+        renderer.setPreset(preset);
+        renderer.setFormat(format);
+        if (multitimbral) renderer.setMultitimbral(true, threads);
+        if (!irPath.empty()) renderer.setReverb(irPath, wet);
+        if (!samplesPath.empty()) renderer.setSamples(samplesPath);
+        if (!automationPath.empty()) {
+            Automation automation;
+            if (!automation.load(automationPath, sampleRate)) {
+                std::cerr << automation.getError() << std::endl;
+                return 1;
+            }
+            renderer.setAutomation(automation);
+        }
+        PerfProfiler profiler;
+        if (perf) {
+            profiler.open(); // Falls back to CPU time without counters
+            renderer.setProfiler(&profiler);
+        }
+        std::string wavPath = output.empty() ? wavPathFor(inputs[0], "") : output;
+        RenderStats stats = renderer.renderFile(inputs[0], wavPath);
+        if (!stats.ok) {
+            std::cerr << stats.error << std::endl;
+            return 1;
+        }
+        std::cout << wavPath << ": " << stats.audioSeconds << " s audio in " << stats.wallSeconds << " s ("
+                  << stats.audioSeconds / std::max(stats.wallSeconds, 1e-9) << "x realtime)" << std::endl;
+        if (perf) profiler.print(std::cout);
+        return 0;
+    }
+
+    std::vector<RenderJob> jobs;
+    for (const auto& in : inputs) jobs.push_back({ in, wavPathFor(in, output) });
+
+    BatchRenderer renderer(sampleRate, threads);
+    renderer.setPreset(preset);
+    renderer.setFormat(format);
+    if (!irPath.empty()) renderer.setReverb(irPath, wet);
+    if (!samplesPath.empty()) renderer.setSamples(samplesPath);
+    std::vector<RenderStats> results;
+    BatchStats stats = renderer.run(jobs, &results);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!results[i].ok) std::cerr << "FAILED " << results[i].error << std::endl;
+    }
+    std::cout << stats.files - stats.failed << "/" << stats.files << " files, "
+              << stats.audioSeconds << " s audio in " << stats.wallSeconds << " s wall, "
+              << "throughput " << stats.throughput() << " audio-s/wall-s" << std::endl;
+    return stats.failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+// Event log replay: reproduces a logged session offline.
+//   rx-replay session.rxlog -o session.wav        (the session's output, see OfflineRenderer::replay)
+//   rx-replay --timing blocks.csv session.rxlog   (every callback, as logged and as replayed)
+//   rx-replay --worst 20 session.rxlog            (the slowest callbacks the host saw)
+#include "../OfflineRenderer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static void usage() {
+    std::cerr << "usage: rx-replay [options] session.rxlog\n"
+              << "  -o <path>        output .wav (default: the log's name with .wav)\n"
+              << "  --timing <csv>   write each callback's frame, size, logged and replayed microseconds\n"
+              << "  --worst <n>      list the n slowest logged callbacks (default: 10)\n";
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    size_t i = std::min(values.size() - 1, (size_t)(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + i, values.end());
+    return values[i];
+}
+
+static void printTimes(const char* label, const std::vector<double>& us) {
+    double sum = 0.0;
+    for (double t : us) sum += t;
+    std::cout << label << " mean " << sum / std::max<size_t>(1, us.size()) << " us, p99 " << percentile(us, 0.99)
+              << " us, max " << percentile(us, 1.0) << " us" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string input;
+    std::string output;
+    std::string timingPath;
+    int worst = 10;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(arg, "-o") && hasValue) output = argv[++i];
+        else if (!std::strcmp(arg, "--timing") && hasValue) timingPath = argv[++i];
+        else if (!std::strcmp(arg, "--worst") && hasValue) worst = std::max(0, std::atoi(argv[++i]));
+        else if (arg[0] == '-' || !input.empty()) { usage(); return 2; }
+        else input = arg;
+    }
+    if (input.empty()) { usage(); return 2; }
+
+    EventLogFile log;
+    if (!log.load(input)) {
+        std::cerr << log.getError() << std::endl;
+        return 1;
+    }
+    if (output.empty()) {
+        size_t dot = input.find_last_of('.');
+        output = (dot == std::string::npos || input.find('/', dot) != std::string::npos ? input : input.substr(0, dot)) + ".wav";
+    }
+
+    bool markedOnly = false;
+    uint64_t blockEnd = 0;    // Position after the last logged render or skip
+    uint64_t duringBlock = 0; // Calls logged while that block was still running
+    for (const EventRecord& r : log.getRecords()) {
+        if (r.kind == EventKind::Render || r.kind == EventKind::Skip) blockEnd = r.frame + r.data;
+        bool first = r.kind == EventKind::Midi || (r.kind == EventKind::Call && r.extra == 0);
+        if (first && r.frame < blockEnd) duringBlock++;
+        if (r.kind != EventKind::Call) continue;
+        EventCall call = (EventCall)r.index;
+        if (call == EventCall::SampleLibrary || call == EventCall::Reverb) markedOnly = true;
+    }
+    if (!log.isComplete()) std::cerr << "warning: the log has no end record; the session did not shut down cleanly" << std::endl;
+    if (log.getDroppedRecords() > 0) {
+        std::cerr << "warning: " << log.getDroppedRecords() << " records were dropped; the replay will diverge" << std::endl;
+    }
+    if (markedOnly) std::cerr << "warning: the session loaded samples or a reverb impulse, which are not replayed" << std::endl;
+    if (duringBlock > 0) {
+        std::cerr << "warning: " << duringBlock << " calls came from another thread while a block was rendering; "
+                  << "they replay at the next block boundary, so the output around them matches only to the block" << std::endl;
+    }
+
+    WavWriter writer;
+    if (!writer.open(output, 2, (int)log.getSampleRate())) {
+        std::cerr << "cannot write " << output << std::endl;
+        return 1;
+    }
+    std::vector<CallbackTiming> timings;
+    RenderStats stats = OfflineRenderer(log.getSampleRate()).replay(log, writer, &timings);
+    if (!stats.ok) {
+        std::cerr << stats.error << std::endl;
+        return 1;
+    }
+    std::cout << output << ": " << log.getRecords().size() << " records, " << timings.size() << " callbacks, "
+              << stats.audioSeconds << " s audio at " << log.getSampleRate() << " Hz, replayed in " << stats.wallSeconds
+              << " s" << std::endl;
+    if (timings.empty()) return 0;
+
+    std::vector<double> logged, replayed;
+    for (const auto& t : timings) {
+        logged.push_back(t.loggedUs);
+        replayed.push_back(t.replayedUs);
+    }
+    printTimes("logged:  ", logged);
+    printTimes("replayed:", replayed);
+
+    // Slowest callbacks as the host timed them, against their deadline
+    std::vector<size_t> order(timings.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    size_t shown = std::min(order.size(), (size_t)worst);
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(),
+                      [&](size_t a, size_t b) { return timings[a].loggedUs > timings[b].loggedUs; });
+    for (size_t i = 0; i < shown; ++i) {
+        const CallbackTiming& t = timings[order[i]];
+        double deadlineUs = t.frames / log.getSampleRate() * 1e6;
+        std::cout << "  frame " << t.frame << " (" << t.frame / log.getSampleRate() << " s), " << t.frames
+                  << " frames: logged " << t.loggedUs << " us, replayed " << t.replayedUs << " us, "
+                  << 100.0 * t.loggedUs / std::max(deadlineUs, 1e-9) << "% of its deadline" << std::endl;
+    }
+
+    if (!timingPath.empty()) {
+        std::ofstream csv(timingPath);
+        if (!csv) {
+            std::cerr << "cannot write " << timingPath << std::endl;
+            return 1;
+        }
+        csv << "frame,frames,logged_us,replayed_us\n";
+        for (const auto& t : timings) csv << t.frame << "," << t.frames << "," << t.loggedUs << "," << t.replayedUs << "\n";
+    }
+    return 0;
+}
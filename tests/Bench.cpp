@@ -0,0 +1,654 @@
+// Micro-benchmarks for the hot paths. Run with `make bench`.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../src/Automation.hpp"
+#include "../src/ConvolutionReverb.hpp"
+#include "../src/EventLog.hpp"
+#include "../src/FmVoiceBank.hpp"
+#include "../src/MidiParser.hpp"
+#include "../src/SampleLibrary.hpp"
+#include "../src/PerfCounters.hpp"
+#include "../src/PresetManager.hpp"
+#include "../src/RealtimeArena.hpp"
+#include "../src/Recorder.hpp"
+#include "../src/ScopeBuffer.hpp"
+#include "../src/SharedTap.hpp"
+#include "../src/Trace.hpp"
+#include "../src/dsp/EnvelopeNode.hpp"
+#include "../src/dsp/FastMath.hpp"
+#include "../src/dsp/FilterNode.hpp"
+#include "../src/dsp/OscillatorNode.hpp"
+#include "../src/dsp/UnisonOscillatorNode.hpp"
+#include "../src/dsp/VectorOps.hpp"
+
+template <typename F>
+static double timeIt(F&& body, int repeats = 5) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+static void report(const char* name, double seconds, double items, const char* unit) {
+    std::printf("%-32s %10.3f ms  %10.2f M%s/s\n", name, seconds * 1e3, items / seconds / 1e6, unit);
+}
+
+static void benchMidiParser() {
+    // Dense controller stream: CC and pitch bend with running status, plus note pairs
+    std::mt19937 rng(42);
+    std::vector<uint8_t> stream;
+    size_t messages = 0;
+    while (stream.size() < (16u << 20)) {
+        switch (rng() % 4) {
+            case 0: stream.insert(stream.end(), { 0xB0, 1, (uint8_t)(rng() & 0x7F) }); break;
+            case 1: stream.insert(stream.end(), { (uint8_t)(rng() & 0x7F), (uint8_t)(rng() & 0x7F) }); break; // Running status
+            case 2: stream.insert(stream.end(), { 0xE3, (uint8_t)(rng() & 0x7F), 0x40 }); break;
+            case 3: stream.insert(stream.end(), { 0x90, 60, 100, 0x80, 60, 0 }); messages++; break;
+        }
+        messages++;
+    }
+
+    MidiParser parser;
+    MidiEventBatch batch;
+    size_t parsed = 0;
+    double t = timeIt([&] {
+        parsed = 0;
+        const uint8_t* data = stream.data();
+        size_t length = stream.size();
+        while (length > 0) {
+            size_t consumed = parser.parse(data, length, 0, batch);
+            parsed += batch.count;
+            batch.clear();
+            data += consumed;
+            length -= consumed;
+        }
+    });
+    report("MidiParser (dense stream)", t, (double)parsed, "msg");
+    if (parsed != messages) std::printf("  WARNING: parsed %zu of %zu messages\n", parsed, messages);
+}
+
+static void benchOscillators() {
+    const int frames = 512, blocks = 2000;
+    DspBuffer buffer(2, frames);
+
+    OscillatorNode osc;
+    osc.prepare(44100.0, frames);
+    osc.setFrequency(220.0f);
+    double single = timeIt([&] { for (int b = 0; b < blocks; ++b) osc.process(buffer); });
+    report("OscillatorNode saw", single, (double)frames * blocks, "smp");
+
+    for (int count : { 4, 8, 16 }) {
+        UnisonOscillatorNode unison;
+        unison.prepare(44100.0, frames);
+        unison.setFrequency(220.0f);
+        unison.setUnison(count, 0.5f, 1.0f);
+        double t = timeIt([&] { for (int b = 0; b < blocks; ++b) unison.process(buffer); });
+        char name[64];
+        std::snprintf(name, sizeof(name), "Unison saw x%d (%.1fx single)", count, t / single);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+}
+
+// Eight held voices: static patch against the modulation matrix at several control rates
+// Every specialized kernel, stereo, 512-sample blocks
+static void benchKernels() {
+    const int frames = 512, blocks = 2000;
+    DspBuffer buffer(2, frames);
+    const char* waveNames[] = { "sine", "triangle", "saw", "square" };
+    for (int w = 0; w < 4; ++w) {
+        OscillatorNode osc;
+        osc.prepare(44100.0, frames);
+        osc.setWaveform((Waveform)w);
+        osc.setFrequency(220.0f);
+        double t = timeIt([&] { for (int b = 0; b < blocks; ++b) osc.process(buffer); });
+        char name[64];
+        std::snprintf(name, sizeof(name), "Oscillator kernel %s", waveNames[w]);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+    const char* typeNames[] = { "low-pass", "high-pass", "band-pass" };
+    for (int type = 0; type < 3; ++type) {
+        FilterNode filter;
+        filter.prepare(44100.0, frames);
+        filter.setType((FilterType)type);
+        filter.setCutoff(1200.0f);
+        double t = timeIt([&] { for (int b = 0; b < blocks; ++b) filter.process(buffer); });
+        char name[64];
+        std::snprintf(name, sizeof(name), "Filter kernel %s", typeNames[type]);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+}
+
+// The dispatched kernels on every ISA this machine has
+static void benchIsa() {
+    const int frames = 512, blocks = 4000;
+    CpuIsa initial = CpuDispatch::isa();
+    std::vector<float> a(frames, 0.5f), b(frames, 0.25f), interleaved(2 * frames);
+    DspBuffer buffer(2, frames);
+    std::printf("active ISA: %s (best %s)\n", CpuDispatch::isaName(initial), CpuDispatch::isaName(CpuDispatch::best()));
+    for (int i = 0; i < CpuDispatch::ISA_COUNT; ++i) {
+        CpuIsa isa = (CpuIsa)i;
+        if (!CpuDispatch::setIsa(isa)) {
+            std::printf("%s: not supported here\n", CpuDispatch::isaName(isa));
+            continue;
+        }
+        char name[64];
+        double t = timeIt([&] { for (int k = 0; k < blocks; ++k) VectorOps::addScaled(a.data(), b.data(), 1e-6f, frames); });
+        std::snprintf(name, sizeof(name), "[%s] addScaled", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks, "smp");
+        t = timeIt([&] { for (int k = 0; k < blocks; ++k) VectorOps::scaleRamp(a.data(), 1.0f, 0.0f, frames); });
+        std::snprintf(name, sizeof(name), "[%s] scaleRamp", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks, "smp");
+        t = timeIt([&] { for (int k = 0; k < blocks; ++k) VectorOps::interleave(interleaved.data(), a.data(), b.data(), frames); });
+        std::snprintf(name, sizeof(name), "[%s] interleave", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks, "smp");
+
+        EnvelopeNode env;
+        env.prepare(44100.0, frames);
+        env.setParameters(1000.0f, 0.1f, 0.7f, 0.5f); // Held in the attack stage
+        env.enterStage(EnvelopeStage::Attack);
+        t = timeIt([&] { for (int k = 0; k < blocks; ++k) env.process(buffer); });
+        std::snprintf(name, sizeof(name), "[%s] envelope", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks, "smp");
+
+        OscillatorNode osc;
+        osc.prepare(44100.0, frames);
+        osc.setFrequency(220.0f);
+        t = timeIt([&] { for (int k = 0; k < blocks; ++k) osc.process(buffer); });
+        std::snprintf(name, sizeof(name), "[%s] oscillator saw", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks, "smp");
+
+        FilterNode filter;
+        filter.prepare(44100.0, frames);
+        filter.setCutoff(1200.0f);
+        t = timeIt([&] { for (int k = 0; k < blocks; ++k) filter.process(buffer); });
+        std::snprintf(name, sizeof(name), "[%s] filter", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks, "smp");
+
+        UnisonOscillatorNode unison;
+        unison.prepare(44100.0, frames);
+        unison.setFrequency(220.0f);
+        unison.setUnison(16, 0.5f, 1.0f);
+        t = timeIt([&] { for (int k = 0; k < blocks / 4; ++k) unison.process(buffer); });
+        std::snprintf(name, sizeof(name), "[%s] unison saw x16", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks / 4, "smp");
+
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(PresetManager::getFactoryPreset(0), synth);
+        for (int n = 0; n < 8; ++n) synth.noteOn(48 + n * 3, 100);
+        t = timeIt([&] { for (int k = 0; k < blocks / 8; ++k) synth.render(buffer); });
+        std::snprintf(name, sizeof(name), "[%s] synth 8 voices", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks / 8, "smp");
+
+        Fm::Lanes lanes = {};
+        for (int op = 0; op < Fm::OPERATORS; ++op) lanes.increment[op] = Fm::UIntLanes{} + 20000000u * (op + 1);
+        t = timeIt([&] { for (int k = 0; k < blocks / 4; ++k) Fm::render(0, lanes, buffer.getChannel(0), frames); });
+        std::snprintf(name, sizeof(name), "[%s] fm stack x8 voices", CpuDispatch::isaName(isa));
+        report(name, t, (double)frames * blocks / 4, "smp");
+    }
+    CpuDispatch::setIsa(initial);
+}
+
+static void benchModulation() {
+    const int frames = 512, blocks = 400;
+    DspBuffer buffer(2, frames);
+
+    auto timePreset = [&](const Preset& preset) {
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        for (int n = 0; n < 8; ++n) synth.noteOn(40 + n * 3, 100);
+        return timeIt([&] { for (int b = 0; b < blocks; ++b) synth.render(buffer); });
+    };
+
+    Preset plain = PresetManager::getFactoryPreset(0);
+    plain.sustain = 1.0f;
+    double base = timePreset(plain);
+    report("8 voices, static patch", base, (double)frames * blocks, "smp");
+
+    Preset modulated = PresetManager::getFactoryPreset(4); // Wobble Bass: five routes
+    modulated.sustain = 1.0f;
+    for (int interval : { 32, 16, 1 }) {
+        modulated.modulation.controlInterval = interval;
+        double t = timePreset(modulated);
+        char name[64];
+        std::snprintf(name, sizeof(name), "5 routes every %d smp (%.2fx)", interval, t / base);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+}
+
+// Pitch modulation renders at control rate with exponential per-sample glides between points
+static void benchPitchModulation() {
+    const int frames = 512, blocks = 400;
+    DspBuffer buffer(2, frames);
+    Preset plain = PresetManager::getFactoryPreset(0);
+    plain.sustain = 1.0f;
+
+    auto timePitch = [&](float bend, float glide, float vibrato) {
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(plain, synth);
+        synth.setPitchBend(bend);
+        synth.setPortamento(glide);
+        synth.setVibrato(5.0f, vibrato);
+        for (int n = 0; n < 8; ++n) synth.noteOn(40 + n * 3, 100);
+        return timeIt([&] { for (int b = 0; b < blocks; ++b) synth.render(buffer); });
+    };
+
+    double base = timePitch(0.0f, 0.0f, 0.0f);
+    report("8 voices, no pitch modulation", base, (double)frames * blocks, "smp");
+    struct { const char* name; float bend, glide, vibrato; } cases[] = {
+        { "bend", 0.5f, 0.0f, 0.0f },
+        { "glide", 0.0f, 1000.0f, 0.0f }, // Never lands during the run
+        { "vibrato", 0.0f, 0.0f, 0.5f },
+        { "all three", 0.5f, 1000.0f, 0.5f },
+    };
+    for (const auto& c : cases) {
+        double t = timePitch(c.bend, c.glide, c.vibrato);
+        char name[64];
+        std::snprintf(name, sizeof(name), "8 voices, %s (%.2fx)", c.name, t / base);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+}
+
+// The FM bank renders all eight voices in one pass; the subtractive voices one at a time
+static void benchFm() {
+    const int frames = 512, blocks = 400;
+    DspBuffer buffer(2, frames);
+
+    auto timePreset = [&](Preset preset, int notes) {
+        for (float& level : preset.sendLevel) level = 0.0f;
+        preset.sustain = 1.0f;
+        for (FmOperator& op : preset.fm.ops) op.sustain = 1.0f;
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        for (int n = 0; n < notes; ++n) synth.noteOn(40 + n * 3, 100);
+        return timeIt([&] { for (int b = 0; b < blocks; ++b) synth.render(buffer); });
+    };
+
+    double base = timePreset(PresetManager::getFactoryPreset(0), 8);
+    report("8 subtractive voices", base, (double)frames * blocks, "smp");
+    for (int notes : { 1, 8 }) {
+        double t = timePreset(PresetManager::getFactoryPreset(7), notes);
+        char name[64];
+        std::snprintf(name, sizeof(name), "%d FM voice%s, 4 operators (%.2fx)", notes, notes > 1 ? "s" : "", t / base);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+
+    Fm::Lanes lanes = {};
+    for (int op = 0; op < Fm::OPERATORS; ++op) lanes.increment[op] = Fm::UIntLanes{} + 20000000u * (op + 1);
+    for (int a = 0; a < Fm::ALGORITHMS; ++a) {
+        double t = timeIt([&] { for (int b = 0; b < blocks; ++b) Fm::render(a, lanes, buffer.getChannel(0), frames); });
+        char name[64];
+        std::snprintf(name, sizeof(name), "FM kernel algorithm %d", a + 1);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+}
+
+// Static lanes should cost nothing; ramping lanes render in Automation::INTERVAL pieces
+static void benchAutomation() {
+    const int frames = 512, blocks = 400;
+    DspBuffer buffer(2, frames);
+    Preset plain = PresetManager::getFactoryPreset(0);
+    plain.sustain = 1.0f;
+
+    auto timeLanes = [&](Automation* automation) {
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(plain, synth);
+        for (int n = 0; n < 8; ++n) synth.noteOn(40 + n * 3, 100);
+        return timeIt([&] {
+            if (automation) automation->seek(0);
+            for (int b = 0; b < blocks; ++b) {
+                if (automation) automation->render(synth, buffer, (uint64_t)b * frames);
+                else synth.render(buffer);
+            }
+        });
+    };
+
+    double base = timeLanes(nullptr);
+    report("8 voices, no automation", base, (double)frames * blocks, "smp");
+    Automation held;
+    for (int p = 0; p < 1000; ++p) {
+        // A long session of points that never change the value
+        held.lane(AutomationTarget::Cutoff).add((uint64_t)p * 4096, plain.cutoff);
+        held.lane(AutomationTarget::Volume).add((uint64_t)p * 4096, 0.2f);
+    }
+    double t = timeLanes(&held);
+    char name[64];
+    std::snprintf(name, sizeof(name), "static lanes, 2k points (%.2fx)", t / base);
+    report(name, t, (double)frames * blocks, "smp");
+
+    Automation sweep;
+    for (int p = 0; p < 20; ++p) sweep.lane(AutomationTarget::Cutoff).add((uint64_t)p * 10240, p % 2 ? 6000.0f : 300.0f);
+    t = timeLanes(&sweep);
+    std::snprintf(name, sizeof(name), "cutoff ramps every %d smp (%.2fx)", Automation::INTERVAL, t / base);
+    report(name, t, (double)frames * blocks, "smp");
+}
+
+// Send effects run once per bus, so their cost should not grow with the voice count
+static void benchSendEffects() {
+    const int frames = 512, blocks = 400;
+    DspBuffer buffer(2, frames);
+
+    auto timeVoices = [&](const Preset& preset, int voices) {
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        for (int n = 0; n < voices; ++n) synth.noteOn(48 + n * 2, 100);
+        return timeIt([&] { for (int b = 0; b < blocks; ++b) synth.render(buffer); });
+    };
+
+    Preset sends = PresetManager::getFactoryPreset(5); // Chorus Keys: chorus and echo buses
+    sends.sustain = 1.0f;
+    Preset dry = sends;
+    dry.sendLevel[0] = dry.sendLevel[1] = 0.0f;
+    for (int voices : { 1, 8 }) {
+        double base = timeVoices(dry, voices);
+        double t = timeVoices(sends, voices);
+        char name[64];
+        std::snprintf(name, sizeof(name), "%d voice%s + 2 sends (+%.1f ms)", voices, voices > 1 ? "s" : "", (t - base) * 1e3);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+}
+
+static double threadSeconds() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Eight sampled voices streaming a long file, paced like an audio callback.
+// The audio thread should only pay for interpolation, never for I/O.
+static void benchSampler() {
+    const int frames = 512, blocks = 100;
+    std::vector<float> left(44100 * 20), right(44100 * 20);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    for (size_t i = 0; i < left.size(); ++i) left[i] = right[i] = noise(rng);
+    WavWriter writer;
+    writer.open("/tmp/rx_bench_sample.wav", 2, 44100, WavFormat::Pcm16);
+    float* channels[2] = { left.data(), right.data() };
+    writer.write(channels, (int)left.size());
+    writer.close();
+    std::ofstream("/tmp/rx_bench.map") << "sample=rx_bench_sample.wav,60\n";
+
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    synth.setEnvelopeParams(0.001f, 0.1f, 1.0f, 0.1f);
+    synth.setSampleLibrary(SampleLibrary::load("/tmp/rx_bench.map"));
+    DspBuffer buffer(2, frames);
+    for (int n = 0; n < 8; ++n) synth.noteOn(55 + n * 2, 100);
+
+    double cpu = 0.0, worst = 0.0;
+    auto period = std::chrono::duration<double>((double)frames / 44100.0);
+    auto deadline = std::chrono::steady_clock::now();
+    for (int b = 0; b < blocks; ++b) {
+        double start = threadSeconds();
+        synth.render(buffer);
+        double t = threadSeconds() - start;
+        cpu += t;
+        worst = std::max(worst, t);
+        deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        std::this_thread::sleep_until(deadline);
+    }
+    report("sampler 8 voices, streamed", cpu, (double)frames * blocks, "smp");
+    std::printf("%-32s %10.3f ms worst block, %llu prefetch misses\n", "", worst * 1e3,
+                (unsigned long long)synth.getSampleStreamer()->getPrefetchMisses());
+    std::remove("/tmp/rx_bench_sample.wav");
+    std::remove("/tmp/rx_bench.map");
+}
+
+// What the audio callback pays for the recorder tap, next to the scope tap it already has
+static void benchRecorder() {
+    const int frames = 512, blocks = 1000;
+    std::vector<float> left(frames, 0.25f), right(frames, -0.25f);
+    const float* channels[2] = { left.data(), right.data() };
+
+    ScopeBuffer scope;
+    double t = timeIt([&] { for (int b = 0; b < blocks; ++b) scope.write(left.data(), frames); });
+    report("scope tap (1 channel)", t, (double)frames * blocks, "smp");
+
+    Recorder recorder(2, 1 << 20); // Holds all 1000 blocks, so nothing overflows
+    double best = 1e30;
+    for (int r = 0; r < 5; ++r) {
+        recorder.start("/tmp/rx_bench_rec.wav", 44100);
+        double start = threadSeconds();
+        for (int b = 0; b < blocks; ++b) recorder.push(channels, frames);
+        best = std::min(best, threadSeconds() - start);
+        recorder.stop();
+    }
+    report("recorder push (2 channels)", best, (double)frames * blocks, "smp");
+    std::remove("/tmp/rx_bench_rec.wav");
+
+    SharedTap tap;
+    if (tap.open("/rx-bench-tap", 2, 44100.0)) {
+        t = timeIt([&] {
+            for (int b = 0; b < blocks; ++b) {
+                tap.write(channels, frames);
+                tap.endBlock(0.1f, 0);
+            }
+        });
+        report("shared tap + levels (2 channels)", t, (double)frames * blocks, "smp");
+    }
+}
+
+// Callback-side cost of the reverb should not grow with IR length; the tail
+// is convolved on the background thread
+static void benchConvolution() {
+    const int frames = 256, blocks = 1000;
+    DspBuffer buffer(2, frames);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+    double base = 0.0;
+    for (double seconds : { 0.05, 2.0, 6.0 }) {
+        int length = (int)(seconds * 44100.0);
+        std::vector<std::vector<float>> samples(2, std::vector<float>(length));
+        for (auto& channel : samples) {
+            for (int i = 0; i < length; ++i) channel[i] = noise(rng) * std::exp(-i / (0.3f * length));
+        }
+        ConvolutionReverb reverb;
+        reverb.setImpulseResponse(ImpulseResponse::fromSamples(samples));
+        // Thread CPU time: on a single core the worker would otherwise be billed to the callback
+        double t = 1e30;
+        for (int r = 0; r < 5; ++r) {
+            double start = threadSeconds();
+            for (int b = 0; b < blocks; ++b) {
+                for (int c = 0; c < 2; ++c) {
+                    for (int i = 0; i < frames; ++i) buffer.getChannel(c)[i] = noise(rng) * 0.1f;
+                }
+                reverb.process(buffer);
+            }
+            t = std::min(t, threadSeconds() - start);
+        }
+        if (base == 0.0) base = t;
+        char name[64];
+        std::snprintf(name, sizeof(name), "reverb %.2f s IR (%.2fx)", seconds, t / base);
+        report(name, t, (double)frames * blocks, "smp");
+    }
+}
+
+// Each FastMath batch kernel against a plain libm loop over the same inputs
+static void benchFastMath() {
+    const int count = 4096, passes = 500;
+    std::vector<float> in(count), out(count);
+    float sink = 0.0f;
+
+    auto run = [&](const char* name, float lo, float hi, void (*fast)(const float*, float*, int), float (*ref)(float)) {
+        for (int i = 0; i < count; ++i) in[i] = lo + (hi - lo) * i / count;
+        double tLibm = timeIt([&] {
+            for (int p = 0; p < passes; ++p) {
+                for (int i = 0; i < count; ++i) out[i] = ref(in[i]);
+                sink += out[p % count];
+            }
+        });
+        double tFast = timeIt([&] {
+            for (int p = 0; p < passes; ++p) {
+                fast(in.data(), out.data(), count);
+                sink += out[p % count];
+            }
+        });
+        char label[64];
+        std::snprintf(label, sizeof(label), "libm %s", name);
+        report(label, tLibm, (double)count * passes, "val");
+        std::snprintf(label, sizeof(label), "FastMath %s (%.1fx)", name, tLibm / tFast);
+        report(label, tFast, (double)count * passes, "val");
+    };
+
+    run("sin", -10.0f, 10.0f, FastMath::sin, [](float x) { return std::sin(x); });
+    run("cos", -10.0f, 10.0f, FastMath::cos, [](float x) { return std::cos(x); });
+    run("tan", -1.5f, 1.5f, FastMath::tan, [](float x) { return std::tan(x); });
+    run("exp2", -20.0f, 20.0f, FastMath::exp2, [](float x) { return std::exp2(x); });
+    run("log2", 0.01f, 100.0f, FastMath::log2, [](float x) { return std::log2(x); });
+    run("tanh", -4.0f, 4.0f, FastMath::tanh, [](float x) { return std::tanh(x); });
+    run("mtof", 0.0f, 127.0f, FastMath::mtof, [](float x) { return 440.0f * std::pow(2.0f, (x - 69.0f) / 12.0f); });
+    if (sink == 12345.0f) std::printf("\n"); // Keep the results observable
+}
+
+// Where the block time goes, by stage and polyphony (hardware counters where the kernel allows)
+static void benchStageProfile() {
+    const int frames = 512, blocks = 200;
+    DspBuffer buffer(2, frames);
+    Preset preset = PresetManager::getFactoryPreset(5);
+    preset.sustain = 1.0f;
+
+    PerfProfiler profiler;
+    profiler.open();
+    for (int voices : { 1, 4, 8 }) {
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        synth.setProfiler(&profiler);
+        for (int n = 0; n < voices; ++n) synth.noteOn(48 + n * 2, 100);
+        for (int b = 0; b < blocks; ++b) synth.render(buffer);
+    }
+    std::cout.flush();
+    profiler.print(std::cout);
+}
+
+// Cost of leaving the trace rings running: markers on every voice, node and bus
+static void benchTrace() {
+    const int frames = 512, blocks = 400;
+    DspBuffer buffer(2, frames);
+    Preset preset = PresetManager::getFactoryPreset(5);
+    preset.sustain = 1.0f;
+    auto timeRender = [&](bool tracing) {
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        for (int n = 0; n < 8; ++n) synth.noteOn(48 + n * 2, 100);
+        Trace::setEnabled(tracing);
+        double t = timeIt([&] { for (int b = 0; b < blocks; ++b) synth.render(buffer); });
+        Trace::setEnabled(false);
+        return t;
+    };
+    double off = timeRender(false);
+    double on = timeRender(true);
+    report("8 voices, tracing off", off, (double)frames * blocks, "smp");
+    char name[64];
+    std::snprintf(name, sizeof(name), "8 voices, tracing on (%.2fx)", on / off);
+    report(name, on, (double)frames * blocks, "smp");
+    Trace::clear();
+}
+
+// Event logging on a busy engine (events and a parameter change every block), and per call
+static void benchEventLog() {
+    const int frames = 256, blocks = 800;
+    DspBuffer buffer(2, frames);
+    Preset preset = PresetManager::getFactoryPreset(5);
+    preset.sustain = 1.0f;
+    auto timeRender = [&](EventLog* log) {
+        SynthEngine synth;
+        synth.setEventLog(log);
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        for (int n = 0; n < 8; ++n) synth.noteOn(48 + n * 2, 100);
+        return timeIt([&] {
+            for (int b = 0; b < blocks; ++b) {
+                synth.handleMidiEvent({ 0, 0x90, (uint8_t)(72 + b % 12), 90 });
+                synth.handleMidiEvent({ 0, 0x80, (uint8_t)(72 + (b + 6) % 12), 0 });
+                synth.setFilterCutoff(500.0f + b);
+                synth.render(buffer);
+            }
+        });
+    };
+    EventLog log(1 << 20); // Room for every repeat below without drops
+    log.open("/tmp/rx_bench.rxlog");
+    double off = timeRender(nullptr);
+    double on = timeRender(&log);
+    report("8 voices, event log off", off, (double)frames * blocks, "smp");
+    char name[64];
+    std::snprintf(name, sizeof(name), "8 voices, event log on (%.3fx)", on / off);
+    report(name, on, (double)frames * blocks, "smp");
+
+    const int calls = 20000;
+    float args[4] = { 0.01f, 0.2f, 0.7f, 0.3f };
+    double t = timeIt([&] { for (int i = 0; i < calls; ++i) log.call(i, EventCall::Envelope, args, 4); });
+    report("EventLog::call, 4 args", t, calls, "call");
+    log.close();
+    std::remove("/tmp/rx_bench.rxlog");
+}
+
+// Engine on the heap vs built in a prefaulted arena, and the arena's footprint
+static void benchArena() {
+    const int frames = 512, blocks = 400;
+    Preset preset = PresetManager::getFactoryPreset(5);
+    preset.sustain = 1.0f;
+    auto timeEngine = [&](SynthEngine& synth, DspBuffer& buffer) {
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        for (int n = 0; n < 8; ++n) synth.noteOn(48 + n * 2, 100);
+        return timeIt([&] { for (int b = 0; b < blocks; ++b) synth.render(buffer); });
+    };
+
+    SynthEngine heap;
+    DspBuffer heapBuffer(2, frames);
+    double onHeap = timeEngine(heap, heapBuffer);
+
+    RealtimeArena arena(1 << 18);
+    SynthEngine* synth = arena.create<SynthEngine>();
+    synth->allocateFrom(arena);
+    DspBuffer buffer(2, frames);
+    buffer.allocateFrom(arena, frames);
+    arena.prefault();
+    double inArena = timeEngine(*synth, buffer);
+
+    report("8 voices, heap engine", onHeap, (double)frames * blocks, "smp");
+    report("8 voices, arena engine", inArena, (double)frames * blocks, "smp");
+    std::cout.flush();
+    arena.printFootprint(std::cout);
+}
+
+int main() {
+    benchOscillators();
+    benchKernels();
+    benchIsa();
+    benchModulation();
+    benchPitchModulation();
+    benchFm();
+    benchAutomation();
+    benchSendEffects();
+    benchStageProfile();
+    benchTrace();
+    benchEventLog();
+    benchArena();
+    benchConvolution();
+    benchSampler();
+    benchRecorder();
+    benchMidiParser();
+    benchFastMath();
+    return 0;
+}
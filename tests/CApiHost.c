@@ -0,0 +1,55 @@
+/* Minimal C host for the embedding API. Run with `make test`. */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "rx.h"
+
+#define FRAMES 2048
+
+static int failures = 0;
+
+static void check(int ok, const char* what) {
+    if (!ok) {
+        printf("  FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+int main(void) {
+    static float left[FRAMES], right[FRAMES], interleaved[FRAMES * 2];
+    float* outs[2] = { left, right };
+    /* A note 100 frames in, released three quarters of the way through */
+    rx_event events[2] = { { 100, 0x90, 60, 100 }, { FRAMES * 3 / 4, 0x80, 60, 0 } };
+    rx_engine* planar = rx_create(48000.0);
+    rx_engine* packed = rx_create(48000.0);
+    int i;
+    float peak = 0.0f;
+
+    printf("[RUN] C API Host...\n");
+    check(planar && packed, "rx_create");
+    if (!planar || !packed) return 1;
+    check(rx_api_version() == RX_API_VERSION, "rx_api_version");
+    check(rx_preset_count() > 0 && strlen(rx_preset_name(0)) > 0, "factory presets");
+
+    rx_set_param(planar, RX_PARAM_CUTOFF, 1500.0f);
+    rx_set_param(packed, RX_PARAM_CUTOFF, 1500.0f);
+    check(rx_get_param(planar, RX_PARAM_CUTOFF) == 1500.0f, "rx_get_param");
+    check(strcmp(rx_param_name(RX_PARAM_CUTOFF), "cutoff") == 0, "rx_param_name");
+
+    rx_process(planar, outs, FRAMES, events, 2);
+    rx_process_interleaved(packed, interleaved, FRAMES, events, 2);
+    for (i = 0; i < 100; ++i) check(left[i] == 0.0f && right[i] == 0.0f, "silent before the note-on offset");
+    for (i = 0; i < FRAMES; ++i) {
+        if (left[i] != interleaved[i * 2] || right[i] != interleaved[i * 2 + 1]) {
+            check(0, "planar and interleaved output match");
+            break;
+        }
+        if (fabsf(left[i]) > peak) peak = fabsf(left[i]);
+    }
+    check(peak > 0.01f && peak < 1.0f, "note is audible");
+
+    rx_destroy(planar);
+    rx_destroy(packed);
+    printf(failures ? "FAIL\n" : "PASS\n");
+    return failures ? 1 : 0;
+}
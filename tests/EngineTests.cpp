@@ -0,0 +1,2059 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include <random>
+#include <thread>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/MidiFile.hpp"
+#include "../src/MidiParser.hpp"
+#include "../src/OfflineRenderer.hpp"
+#include "../src/SegmentedRenderer.hpp"
+#include "../src/MultiTimbralEngine.hpp"
+#include "../src/WorkerPool.hpp"
+#include "../src/ModMatrix.hpp"
+#include "../src/Automation.hpp"
+#include "../src/EventLog.hpp"
+#include "../src/ConvolutionReverb.hpp"
+#include "../src/SamplerNode.hpp"
+#include "../src/Recorder.hpp"
+#include "../src/SharedTap.hpp"
+#include "../src/PerfCounters.hpp"
+#include "../src/Trace.hpp"
+#include "../src/RealtimeArena.hpp"
+#include "../src/rx.h"
+#include "../src/dsp/FastMath.hpp"
+#include "../src/dsp/FilterNode.hpp"
+#include "../src/dsp/KernelTable.hpp"
+#include "../src/dsp/OscillatorNode.hpp"
+#include "../src/dsp/VectorOps.hpp"
+#include "../src/dsp/UnisonOscillatorNode.hpp"
+#include "TestFramework.hpp"
+
+// Helpers
+
+static void putVarLen(std::vector<uint8_t>& out, uint32_t value) {
+    uint8_t bytes[4];
+    int n = 0;
+    do { bytes[n++] = value & 0x7F; value >>= 7; } while (value);
+    while (n--) out.push_back(bytes[n] | (n ? 0x80 : 0));
+}
+
+static void putTrack(std::vector<uint8_t>& out, const std::vector<uint8_t>& events) {
+    uint32_t len = (uint32_t)events.size();
+    out.insert(out.end(), { 'M', 'T', 'r', 'k', (uint8_t)(len >> 24), (uint8_t)(len >> 16), (uint8_t)(len >> 8), (uint8_t)len });
+    out.insert(out.end(), events.begin(), events.end());
+}
+
+// Format 1, division 96: conductor track halves the quarter note at tick 96,
+// note track uses running status for its second note-on and the note-off.
+static std::vector<uint8_t> makeTestSong() {
+    std::vector<uint8_t> smf = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96 };
+
+    std::vector<uint8_t> conductor;
+    putVarLen(conductor, 0);  conductor.insert(conductor.end(), { 0xFF, 0x51, 3, 0x07, 0xA1, 0x20 }); // 500000 us
+    putVarLen(conductor, 96); conductor.insert(conductor.end(), { 0xFF, 0x51, 3, 0x03, 0xD0, 0x90 }); // 250000 us
+    putVarLen(conductor, 0);  conductor.insert(conductor.end(), { 0xFF, 0x2F, 0 });
+    putTrack(smf, conductor);
+
+    std::vector<uint8_t> notes;
+    putVarLen(notes, 0);  notes.insert(notes.end(), { 0x90, 60, 100 });
+    putVarLen(notes, 96); notes.insert(notes.end(), { 64, 90 });        // Running status
+    putVarLen(notes, 0);  notes.insert(notes.end(), { 0xF0, 2, 0x7E, 0xF7 }); // Sysex is skipped
+    putVarLen(notes, 96); notes.insert(notes.end(), { 0x90, 60, 0 });
+    putVarLen(notes, 0);  notes.insert(notes.end(), { 64, 0 });          // Running status again
+    putVarLen(notes, 0);  notes.insert(notes.end(), { 0xFF, 0x2F, 0 });
+    putTrack(smf, notes);
+    return smf;
+}
+
+// Format 0 at 120 BPM / 480 ppq from (tick, status, data1, data2) tuples in time order
+struct SongEvent { uint32_t tick; uint8_t status, data1, data2; };
+static std::vector<uint8_t> makeSong(const std::vector<SongEvent>& song) {
+    std::vector<uint8_t> smf = { 'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xE0 };
+    std::vector<uint8_t> track;
+    uint32_t last = 0;
+    for (const auto& e : song) {
+        putVarLen(track, e.tick - last);
+        track.insert(track.end(), { e.status, e.data1, e.data2 });
+        last = e.tick;
+    }
+    putVarLen(track, 0);
+    track.insert(track.end(), { 0xFF, 0x2F, 0 });
+    putTrack(smf, track);
+    return smf;
+}
+
+// Phrases separated by silence, then one long chord that can only be split with a pre-roll
+static std::vector<uint8_t> makeLongSong() {
+    std::vector<SongEvent> song;
+    uint32_t tick = 0;
+    for (int phrase = 0; phrase < 6; ++phrase) {
+        for (int n : { 48, 55, 60 + phrase }) song.push_back({ tick, 0x90, (uint8_t)n, 100 });
+        song.push_back({ tick + 960, 0x90, 72, 80 });
+        song.push_back({ tick + 1440, 0x80, 72, 0 });
+        for (int n : { 48, 55, 60 + phrase }) song.push_back({ tick + 1920, 0x80, (uint8_t)n, 0 });
+        tick += 1920 + 1440; // Two seconds of notes, 1.5 s gap
+    }
+    for (int n : { 45, 52, 57 }) song.push_back({ tick, 0x90, (uint8_t)n, 110 });
+    for (int i = 0; i < 16; ++i) song.push_back({ tick + 480 * i + 240, 0x90, (uint8_t)(64 + i % 5), 70 });
+    for (int i = 0; i < 16; ++i) song.push_back({ tick + 480 * i + 480, 0x80, (uint8_t)(64 + i % 5), 0 });
+    for (int n : { 45, 52, 57 }) song.push_back({ tick + 480 * 18, 0x80, (uint8_t)n, 0 });
+    std::stable_sort(song.begin(), song.end(), [](const SongEvent& a, const SongEvent& b) { return a.tick < b.tick; });
+    return makeSong(song);
+}
+
+static std::vector<char> readFile(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+// Tests
+
+void testMidiFileTempoMapAndRunningStatus() {
+    std::vector<uint8_t> smf = makeTestSong();
+    MidiFile midi;
+    ASSERT_TRUE(midi.loadFromMemory(smf.data(), smf.size()));
+    ASSERT_TRUE(midi.getFormat() == 1);
+    ASSERT_TRUE(midi.getNumTracks() == 2);
+
+    MidiFileReader reader(midi, 44100.0);
+    std::vector<MidiEvent> events;
+    MidiEvent e;
+    while (reader.next(e)) events.push_back(e);
+
+    ASSERT_TRUE(events.size() == 4);
+    ASSERT_TRUE(events[0].time == 0 && events[0].data1 == 60);
+    // Tick 96 at 120 BPM = 0.5 s
+    ASSERT_TRUE(events[1].time == 22050 && events[1].status == 0x90 && events[1].data1 == 64);
+    // Next 96 ticks at 240 BPM = 0.25 s
+    ASSERT_TRUE(events[2].time == 33075 && events[2].data2 == 0);
+    ASSERT_TRUE(events[3].time == 33075 && events[3].data1 == 64);
+    ASSERT_TRUE(reader.getEndSample() == 33075);
+}
+
+void testMidiFileRejectsGarbage() {
+    const uint8_t junk[] = { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    MidiFile midi;
+    ASSERT_TRUE(!midi.loadFromMemory(junk, sizeof(junk)));
+    ASSERT_TRUE(!midi.getError().empty());
+}
+
+void testOfflineRenderWritesAudio() {
+    std::vector<uint8_t> smf = makeTestSong();
+    MidiFile midi;
+    ASSERT_TRUE(midi.loadFromMemory(smf.data(), smf.size()));
+
+    OfflineRenderer renderer(44100.0);
+    renderer.setTailSeconds(0.5);
+    WavWriter writer;
+    ASSERT_TRUE(writer.open("/tmp/rx_engine_test.wav", 2, 44100));
+    RenderStats stats = renderer.render(midi, writer);
+
+    ASSERT_TRUE(stats.ok);
+    ASSERT_TRUE(stats.frames == 33075 + 22050);
+    std::vector<char> wav = readFile("/tmp/rx_engine_test.wav");
+    ASSERT_TRUE(wav.size() == 44 + stats.frames * 2 * sizeof(float));
+
+    // Something audible was rendered after the first note-on
+    const float* samples = (const float*)(wav.data() + 44);
+    float peak = 0.0f;
+    for (size_t i = 0; i < 44100; ++i) peak = std::max(peak, std::abs(samples[i]));
+    ASSERT_TRUE(peak > 0.001f);
+    std::remove("/tmp/rx_engine_test.wav");
+}
+
+void testBatchRenderIsDeterministic() {
+    std::vector<uint8_t> smf = makeTestSong();
+    {
+        std::ofstream f("/tmp/rx_batch_test.mid", std::ios::binary);
+        f.write((const char*)smf.data(), smf.size());
+    }
+
+    BatchRenderer batch(44100.0, 2);
+    std::vector<RenderJob> jobs = {
+        { "/tmp/rx_batch_test.mid", "/tmp/rx_batch_a.wav" },
+        { "/tmp/rx_batch_test.mid", "/tmp/rx_batch_b.wav" },
+        { "/tmp/does_not_exist.mid", "/tmp/rx_batch_c.wav" },
+    };
+    std::vector<RenderStats> results;
+    BatchStats stats = batch.run(jobs, &results);
+
+    ASSERT_TRUE(stats.files == 3 && stats.failed == 1);
+    ASSERT_TRUE(results[0].ok && results[1].ok && !results[2].ok);
+    ASSERT_TRUE(stats.throughput() > 0.0);
+    ASSERT_TRUE(readFile("/tmp/rx_batch_a.wav") == readFile("/tmp/rx_batch_b.wav"));
+
+    std::remove("/tmp/rx_batch_test.mid");
+    std::remove("/tmp/rx_batch_a.wav");
+    std::remove("/tmp/rx_batch_b.wav");
+}
+
+// Largest sample difference between a serial and a segmented render of `midi`
+static float segmentedVsSerial(const MidiFile& midi, const Preset& preset, const std::vector<uint32_t>& splits,
+                               SegmentedStats& stats) {
+    OfflineRenderer serial(44100.0);
+    serial.setPreset(preset);
+    WavWriter serialWriter;
+    if (!serialWriter.open("/tmp/rx_serial.wav", 2, 44100)) return INFINITY;
+    RenderStats serialStats = serial.render(midi, serialWriter);
+
+    SegmentedRenderer segmented(44100.0, 3);
+    segmented.setPreset(preset);
+    segmented.setMaxSegmentSeconds(3.0);
+    segmented.setSplitPoints(splits);
+    WavWriter segmentedWriter;
+    if (!segmentedWriter.open("/tmp/rx_segmented.wav", 2, 44100)) return INFINITY;
+    stats = segmented.render(midi, segmentedWriter);
+
+    std::vector<char> a = readFile("/tmp/rx_serial.wav");
+    std::vector<char> b = readFile("/tmp/rx_segmented.wav");
+    std::remove("/tmp/rx_serial.wav");
+    std::remove("/tmp/rx_segmented.wav");
+    if (!stats.ok || stats.frames != serialStats.frames || a.size() != b.size()) return INFINITY;
+    const float* sa = (const float*)(a.data() + 44);
+    const float* sb = (const float*)(b.data() + 44);
+    float maxError = 0.0f;
+    for (size_t i = 0; i < (a.size() - 44) / sizeof(float); ++i) maxError = std::max(maxError, std::abs(sa[i] - sb[i]));
+    return maxError;
+}
+
+// Phrases that glide into each other, with a bend and a mod wheel move in the gaps.
+// The next phrase starts from silence but not from the controllers' defaults.
+static std::vector<uint8_t> makeExpressiveSong() {
+    std::vector<SongEvent> song;
+    uint32_t tick = 0;
+    for (int phrase = 0; phrase < 5; ++phrase) {
+        if (phrase == 2) song.push_back({ tick - 480, 0xE0, 0x00, 0x60 }); // Half way up, held from here on
+        if (phrase == 3) song.push_back({ tick - 480, 0xB0, 1, 127 });
+        uint8_t low = (uint8_t)(48 + phrase * 5), high = (uint8_t)(60 + phrase * 3);
+        song.push_back({ tick, 0x90, low, 100 });
+        song.push_back({ tick + 480, 0x90, high, 100 }); // Glides while the first is held
+        song.push_back({ tick + 960, 0x80, low, 0 });
+        song.push_back({ tick + 1440, 0x80, high, 0 });
+        tick += 1440 + 1440;
+    }
+    return makeSong(song);
+}
+
+void testSegmentedRenderMatchesSerial() {
+    std::vector<uint8_t> smf = makeLongSong();
+    MidiFile midi;
+    ASSERT_TRUE(midi.loadFromMemory(smf.data(), smf.size()));
+
+    SegmentedStats stats;
+    float maxError = segmentedVsSerial(midi, PresetManager::getFactoryPreset(0), { 44100 * 27 }, stats); // Inside the long chord
+    ASSERT_TRUE(stats.segments.size() > 6);
+    ASSERT_TRUE(stats.seamsOk);
+
+    int silentSeams = 0, warmSeams = 0;
+    for (const auto& seam : stats.seams) {
+        if (seam.silent) {
+            silentSeams++;
+            ASSERT_TRUE(seam.maxError == 0.0f); // Fresh engine at silence is bit-exact
+        } else {
+            warmSeams++;
+        }
+    }
+    ASSERT_TRUE(silentSeams >= 5 && warmSeams >= 1);
+    ASSERT_TRUE(maxError < 1e-4f);
+
+    // Glide, bend and mod wheel state from before a silent seam
+    smf = makeExpressiveSong();
+    ASSERT_TRUE(midi.loadFromMemory(smf.data(), smf.size()));
+    for (int p : { 4, 6 }) { // Wobble Bass (mod wheel to cutoff), Glide Lead
+        maxError = segmentedVsSerial(midi, PresetManager::getFactoryPreset(p), {}, stats);
+        int silent = 0;
+        for (const auto& seam : stats.seams) silent += seam.silent ? 1 : 0;
+        ASSERT_TRUE(silent >= 3);
+        ASSERT_TRUE(maxError == 0.0f);
+    }
+
+    // Seams only compare neighbouring segments, so check every preset (mod routes, glide,
+    // vibrato, sends, FM) against a serial render; the long chord forces warm seams
+    std::vector<uint8_t> songs[2] = { makeExpressiveSong(), makeLongSong() };
+    for (int s = 0; s < 2; ++s) {
+        ASSERT_TRUE(midi.loadFromMemory(songs[s].data(), songs[s].size()));
+        std::vector<uint32_t> splits;
+        if (s == 1) splits.push_back(44100 * 27);
+        for (int p = 0; p < PresetManager::getFactoryPresetCount(); ++p) {
+            maxError = segmentedVsSerial(midi, PresetManager::getFactoryPreset(p), splits, stats);
+            ASSERT_TRUE(stats.seamsOk && stats.seams.size() >= 2);
+            int warm = 0;
+            for (const auto& seam : stats.seams) warm += seam.silent ? 0 : 1;
+            ASSERT_TRUE(s == 0 || warm >= 1);
+            ASSERT_TRUE(maxError < 1e-4f);
+        }
+    }
+
+    // The plan only calls a point silent once the engine really is, for every model and tail
+    std::vector<MidiEvent> note = { { 0, 0x90, 60, 100 }, { 22050, 0x80, 60, 0 } };
+    std::vector<uint32_t> points;
+    for (uint32_t p = 22050; p < 44100 * 8; p += 1024) points.push_back(p);
+    for (int p = 0; p < PresetManager::getFactoryPresetCount(); ++p) {
+        Preset preset = PresetManager::getFactoryPreset(p);
+        SegmentedRenderer planner(44100.0, 1);
+        planner.setPreset(preset);
+        planner.setSplitPoints(points);
+        uint32_t silentAt = 0;
+        for (const auto& seg : planner.planSegments(note, 44100 * 8)) {
+            if (seg.start > 22050 && seg.silentStart()) {
+                silentAt = seg.start;
+                break;
+            }
+        }
+        ASSERT_TRUE(silentAt > 22050);
+
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        PresetManager::applyPreset(preset, synth);
+        DspBuffer buffer(2, 512);
+        uint32_t pos = 0;
+        for (const auto& e : note) {
+            for (; pos < e.time; pos += buffer.getNumFrames()) {
+                buffer.resize(2, (int)std::min<uint32_t>(512, e.time - pos));
+                synth.render(buffer);
+            }
+            synth.handleMidiEvent(e);
+        }
+        for (; pos < silentAt; pos += buffer.getNumFrames()) {
+            buffer.resize(2, (int)std::min<uint32_t>(512, silentAt - pos));
+            synth.render(buffer);
+        }
+        ASSERT_TRUE(synth.isSilent());
+    }
+}
+
+static std::vector<MidiEvent> parseAll(MidiParser& parser, const uint8_t* data, size_t length) {
+    std::vector<MidiEvent> events;
+    MidiEventBatch batch;
+    while (length > 0) {
+        size_t consumed = parser.parse(data, length, 0, batch);
+        events.insert(events.end(), batch.events, batch.events + batch.count);
+        batch.clear();
+        data += consumed;
+        length -= consumed;
+    }
+    return events;
+}
+
+void testMidiParserStreamFeatures() {
+    const uint8_t stream[] = {
+        0x91, 60, 100, 62, 101,        // Note on ch 2, then running status
+        0xF8,                          // Clock in between messages
+        64, 0xFE, 102,                 // Active sensing inside a running-status message
+        0xF0, 0x43, 0x10, 0x7F, 0xF7,  // Sysex is skipped
+        0x10,                          // Stray data byte: running status was cancelled
+        0xC3, 5, 6,                    // Program change with running status
+        0xE0, 0x00, 0x40,              // Pitch bend centre
+        0xB0, 1, 127, 7, 90,           // Mod wheel + volume via running status
+        0xD0, 33,                      // Channel pressure
+        0xF2, 1, 2,                    // Song position is skipped
+        0x80, 60,                      // Incomplete: finished by the next call
+    };
+    MidiParser parser;
+    std::vector<MidiEvent> events = parseAll(parser, stream, sizeof(stream));
+    ASSERT_TRUE(events.size() == 9);
+
+    const uint8_t rest[] = { 0 };
+    std::vector<MidiEvent> tail = parseAll(parser, rest, sizeof(rest));
+    events.insert(events.end(), tail.begin(), tail.end());
+    ASSERT_TRUE(events.size() == 10);
+    ASSERT_TRUE(events[0].status == 0x91 && events[0].data1 == 60 && events[0].data2 == 100);
+    ASSERT_TRUE(events[1].status == 0x91 && events[1].data1 == 62 && events[1].data2 == 101);
+    ASSERT_TRUE(events[2].status == 0x91 && events[2].data1 == 64 && events[2].data2 == 102);
+    ASSERT_TRUE(events[3].status == 0xC3 && events[3].data1 == 5);
+    ASSERT_TRUE(events[4].status == 0xC3 && events[4].data1 == 6);
+    ASSERT_TRUE(events[5].type() == 0xE0 && events[5].data1 == 0 && events[5].data2 == 0x40);
+    ASSERT_TRUE(events[6].type() == 0xB0 && events[6].data1 == 1 && events[6].data2 == 127);
+    ASSERT_TRUE(events[7].type() == 0xB0 && events[7].data1 == 7 && events[7].data2 == 90);
+    ASSERT_TRUE(events[8].type() == 0xD0 && events[8].data1 == 33);
+    ASSERT_TRUE(events[9].type() == 0x80 && events[9].data1 == 60 && events[9].data2 == 0);
+    ASSERT_TRUE(parser.getDroppedBytes() == 1);
+}
+
+void testMidiParserFuzz() {
+    // Random streams biased towards status bytes. Feeding in random-sized chunks
+    // (including chunks that fill the batch) must give the same events as one call.
+    std::mt19937 rng(1234);
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        std::vector<uint8_t> stream(4096);
+        for (auto& b : stream) {
+            uint32_t r = rng();
+            b = (r % 4 == 0) ? (uint8_t)(0x80 | (r >> 8)) : (uint8_t)((r >> 8) & 0x7F);
+        }
+
+        MidiParser whole;
+        std::vector<MidiEvent> expected = parseAll(whole, stream.data(), stream.size());
+
+        MidiParser chunked;
+        std::vector<MidiEvent> actual;
+        MidiEventBatch batch;
+        size_t pos = 0;
+        while (pos < stream.size()) {
+            size_t chunk = std::min<size_t>(1 + rng() % 17, stream.size() - pos);
+            size_t consumed = chunked.parse(stream.data() + pos, chunk, 0, batch);
+            ASSERT_TRUE(consumed <= chunk);
+            ASSERT_TRUE(batch.count <= MidiEventBatch::CAPACITY);
+            if (rng() % 3 == 0 || batch.full()) {
+                actual.insert(actual.end(), batch.events, batch.events + batch.count);
+                batch.clear();
+            }
+            pos += consumed;
+        }
+        actual.insert(actual.end(), batch.events, batch.events + batch.count);
+
+        ASSERT_TRUE(actual.size() == expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            const MidiEvent& e = actual[i];
+            ASSERT_TRUE(e.status >= 0x80 && e.status < 0xF0);
+            ASSERT_TRUE(e.data1 < 0x80 && e.data2 < 0x80);
+            ASSERT_TRUE(e.status == expected[i].status && e.data1 == expected[i].data1 && e.data2 == expected[i].data2);
+        }
+    }
+}
+
+void testWorkerPoolRunsEveryTask() {
+    WorkerPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    for (int round = 0; round < 50; ++round) {
+        int count = 1 + round * 19 % 1000;
+        auto task = [&](int i) { hits[i]++; };
+        pool.parallelFor(count, task);
+        for (int i = 0; i < count; ++i) {
+            ASSERT_TRUE(hits[i] == 1);
+            hits[i] = 0;
+        }
+    }
+}
+
+void testMultiTimbralRoutingAndDeterminism() {
+    MultiTimbralEngine parallel(4);
+    MultiTimbralEngine serial(1);
+    DspBuffer a(2, 256), b(2, 256);
+
+    for (MultiTimbralEngine* engine : { &parallel, &serial }) {
+        engine->setSampleRate(44100.0);
+        for (int ch = 0; ch < 16; ch += 3) {
+            engine->handleMidiEvent({ 0, (uint8_t)(0xC0 | ch), (uint8_t)ch, 0 });
+            engine->handleMidiEvent({ 0, (uint8_t)(0x90 | ch), (uint8_t)(48 + ch), 100 });
+        }
+    }
+    ASSERT_TRUE(parallel.getPart(1).isSilent());
+    ASSERT_TRUE(!parallel.getPart(3).isSilent());
+
+    for (int block = 0; block < 40; ++block) {
+        parallel.render(a);
+        serial.render(b);
+        ASSERT_TRUE(parallel.getActivePartCount() == 6);
+        for (int c = 0; c < 2; ++c) {
+            for (int i = 0; i < 256; ++i) ASSERT_TRUE(a.getChannel(c)[i] == b.getChannel(c)[i]);
+        }
+    }
+
+    // Each part's bus holds only that part
+    float* bus1 = parallel.getPartBus(1).getChannel(0);
+    float* bus3 = parallel.getPartBus(3).getChannel(0);
+    float energy1 = 0.0f, energy3 = 0.0f;
+    for (int i = 0; i < 256; ++i) { energy1 += bus1[i] * bus1[i]; energy3 += bus3[i] * bus3[i]; }
+    ASSERT_TRUE(energy1 == 0.0f && energy3 > 0.0f);
+
+    // Note-off on another channel leaves part 3 alone
+    parallel.handleMidiEvent({ 0, 0x84, 51, 0 });
+    ASSERT_TRUE(!parallel.getPart(3).isSilent());
+}
+
+void testUnisonStack() {
+    DspBuffer buffer(2, 512);
+    UnisonOscillatorNode unison;
+    unison.prepare(44100.0, 512);
+    unison.setFrequency(220.0f);
+
+    // No spread: both channels identical, bounded
+    unison.setUnison(16, 0.5f, 0.0f);
+    unison.process(buffer);
+    float peak = 0.0f;
+    for (int i = 0; i < 512; ++i) {
+        ASSERT_NEAR(buffer.getChannel(0)[i], buffer.getChannel(1)[i], 1e-6f);
+        peak = std::max(peak, std::abs(buffer.getChannel(0)[i]));
+    }
+    ASSERT_TRUE(peak > 0.05f && peak < 4.0f);
+
+    // Full spread decorrelates the channels
+    unison.setUnison(16, 0.5f, 1.0f);
+    unison.process(buffer);
+    float diff = 0.0f;
+    for (int i = 0; i < 512; ++i) diff += std::abs(buffer.getChannel(0)[i] - buffer.getChannel(1)[i]);
+    ASSERT_TRUE(diff > 1.0f);
+
+    // A single centred copy is a plain band-limited saw at the oscillator's level
+    unison.reset();
+    unison.setUnison(1, 0.0f, 0.0f);
+    unison.process(buffer);
+    for (int i = 0; i < 512; ++i) ASSERT_TRUE(std::abs(buffer.getChannel(0)[i]) <= 0.5f + 1e-5f);
+}
+
+template <int M, int W>
+struct TagKernel {
+    static int run() { return M * 10 + W; }
+};
+
+void testKernelSpecialization() {
+    // The table covers every combination and clamps the width
+    static constexpr auto table = KernelTable<int (*)(), 3, 2>::make<TagKernel>();
+    ASSERT_TRUE(table.select(0, 1)() == 1);
+    ASSERT_TRUE(table.select(2, 2)() == 22);
+    ASSERT_TRUE(table.select(1, 5)() == 12);
+    ASSERT_TRUE(table.select(1, 0)() == 11);
+
+    // Every waveform: mono and stereo kernels agree, channels past the second are left alone,
+    // and a glide split over two blocks matches one block
+    for (Waveform w : { Waveform::Sine, Waveform::Triangle, Waveform::Saw, Waveform::Square }) {
+        OscillatorNode mono, wide, split;
+        for (OscillatorNode* osc : { &mono, &wide, &split }) {
+            osc->prepare(44100.0, 512);
+            osc->setWaveform(w);
+            osc->setFrequency(220.0f);
+            osc->rampFrequency(440.0f, 300);
+        }
+        DspBuffer a(1, 512), b(3, 512), c(1, 256);
+        std::fill(b.getChannel(2), b.getChannel(2) + 512, 7.0f);
+        mono.process(a);
+        wide.process(b);
+        for (int i = 0; i < 512; ++i) {
+            ASSERT_TRUE(a.getChannel(0)[i] == b.getChannel(0)[i] && a.getChannel(0)[i] == b.getChannel(1)[i]);
+            ASSERT_TRUE(b.getChannel(2)[i] == 7.0f);
+        }
+        for (int half = 0; half < 2; ++half) {
+            split.process(c);
+            for (int i = 0; i < 256; ++i) ASSERT_TRUE(c.getChannel(0)[i] == a.getChannel(0)[half * 256 + i]);
+        }
+    }
+
+    // Filter outputs on a DC input: low-pass passes it, high- and band-pass settle to zero,
+    // the same for every channel count
+    for (FilterType type : { FilterType::LowPass, FilterType::HighPass, FilterType::BandPass }) {
+        for (int channels : { 1, 2, 3, DspBuffer::MAX_CHANNELS }) {
+            FilterNode filter;
+            filter.prepare(44100.0, 4096);
+            filter.setType(type);
+            filter.setCutoff(1000.0f);
+            filter.setResonance(0.5f);
+            filter.rampTo(500.0f, 0.3f, 100);
+            DspBuffer buffer(channels, 4096);
+            for (int ch = 0; ch < channels; ++ch) std::fill(buffer.getChannel(ch), buffer.getChannel(ch) + 4096, 1.0f);
+            filter.process(buffer);
+            float expected = type == FilterType::LowPass ? 1.0f : 0.0f;
+            for (int ch = 0; ch < channels; ++ch) {
+                ASSERT_NEAR(buffer.getChannel(ch)[4095], expected, 1e-3f);
+                for (int i = 0; i < 4096; ++i) ASSERT_TRUE(buffer.getChannel(ch)[i] == buffer.getChannel(0)[i]);
+            }
+        }
+    }
+}
+
+// Renders a few notes on a preset with the active ISA's kernels
+static std::vector<float> renderWithIsa(int preset) {
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(preset), synth);
+    synth.setMasterVolume(0.5f);
+    DspBuffer buffer(2, 333); // Not a multiple of any vector width
+    std::vector<float> out;
+    for (int b = 0; b < 40; ++b) {
+        if (b == 0) for (int n = 0; n < 5; ++n) synth.noteOn(48 + n * 4, 100);
+        if (b == 10) synth.setMasterVolume(0.8f); // Ramped
+        if (b == 25) synth.allNotesOff();
+        synth.render(buffer);
+        out.insert(out.end(), buffer.getChannel(0), buffer.getChannel(0) + 333);
+        out.insert(out.end(), buffer.getChannel(1), buffer.getChannel(1) + 333);
+    }
+    return out;
+}
+
+void testCpuDispatch() {
+    CpuIsa initial = CpuDispatch::isa();
+    ASSERT_TRUE(CpuDispatch::isSupported(CpuIsa::Baseline));
+    ASSERT_TRUE(CpuDispatch::isSupported(CpuDispatch::best()));
+
+    std::vector<float> reference[3];
+    for (int i = 0; i < CpuDispatch::ISA_COUNT; ++i) {
+        if (!CpuDispatch::setIsa((CpuIsa)i)) continue;
+        ASSERT_TRUE(CpuDispatch::isa() == (CpuIsa)i);
+
+        // Vector loops and their scalar tails against plain loops
+        for (int n : { 1, 15, 16, 37, 100 }) {
+            std::vector<float> a(n), b(n), c(2 * n), expected(n);
+            for (int k = 0; k < n; ++k) {
+                a[k] = 0.25f * k - 3.0f;
+                b[k] = std::sin(0.1f * k);
+            }
+            std::vector<float> dst = a;
+            VectorOps::addScaled(dst.data(), b.data(), 0.3f, n);
+            for (int k = 0; k < n; ++k) ASSERT_TRUE(dst[k] == a[k] + b[k] * 0.3f);
+            dst = a;
+            VectorOps::multiply(dst.data(), b.data(), n);
+            for (int k = 0; k < n; ++k) ASSERT_TRUE(dst[k] == a[k] * b[k]);
+            dst = a;
+            VectorOps::scaleRamp(dst.data(), 0.5f, 0.01f, n);
+            for (int k = 0; k < n; ++k) ASSERT_TRUE(dst[k] == a[k] * (0.5f + 0.01f * (k + 1)));
+            VectorOps::interleave(c.data(), a.data(), b.data(), n);
+            for (int k = 0; k < n; ++k) ASSERT_TRUE(c[2 * k] == a[k] && c[2 * k + 1] == b[k]);
+            VectorOps::clear(dst.data(), n);
+            for (int k = 0; k < n; ++k) ASSERT_TRUE(dst[k] == 0.0f);
+        }
+
+        // Whole renders are bit-identical on every ISA
+        const int presets[] = { 0, 3, 7 }; // Saw through the filter; Super Saw unison; FM
+        for (int k = 0; k < 3; ++k) {
+            std::vector<float> out = renderWithIsa(presets[k]);
+            std::vector<float>& ref = reference[k];
+            if (ref.empty()) ref = out;
+            else ASSERT_TRUE(out == ref);
+        }
+    }
+    CpuDispatch::setIsa(initial);
+}
+
+// One voice of the FM kernel in double precision, straight from the algorithm tables
+static std::vector<double> referenceFm(int algorithm, const Fm::Lanes& start, int lane, int frames) {
+    uint32_t phase[Fm::OPERATORS];
+    for (int op = 0; op < Fm::OPERATORS; ++op) phase[op] = start.phase[op][lane];
+    double h0 = 0.0, h1 = 0.0;
+    std::vector<double> out(frames);
+    for (int i = 0; i < frames; ++i) {
+        double y[Fm::OPERATORS];
+        for (int op = Fm::OPERATORS - 1; op >= 0; --op) {
+            double mod = op == 3 ? start.feedback * 0.5 * (h0 + h1) : 0.0;
+            for (int m = op + 1; m < Fm::OPERATORS; ++m) {
+                if (Fm::MODULATORS[algorithm][op] & (1 << m)) mod += y[m];
+            }
+            y[op] = std::sin(2.0 * M_PI * phase[op] / 4294967296.0 + mod) * start.gain[op][lane];
+            phase[op] += start.increment[op][lane];
+        }
+        h1 = h0;
+        h0 = y[3];
+        for (int op = 0; op < Fm::OPERATORS; ++op) {
+            if (Fm::CARRIERS[algorithm] & (1 << op)) out[i] += y[op];
+        }
+    }
+    return out;
+}
+
+void testFmVoices() {
+    // Every algorithm against the reference, one voice at a time and all lanes together
+    for (int a = 0; a < Fm::ALGORITHMS; ++a) {
+        Fm::Lanes lanes = {};
+        lanes.feedback = 0.6f;
+        for (int l = 0; l < Fm::LANES; ++l) {
+            for (int op = 0; op < Fm::OPERATORS; ++op) {
+                lanes.phase[op][l] = 0x10000000u * (uint32_t)(l + op);
+                lanes.increment[op][l] = (uint32_t)(4294967296.0 * 220.0 * (1 + op) * (1.0 + 0.1 * l) / 44100.0);
+                lanes.gain[op][l] = 0.3f + 0.2f * op;
+            }
+        }
+        const int frames = 2000;
+        std::vector<double> expected(frames, 0.0);
+        for (int l = 0; l < Fm::LANES; ++l) {
+            std::vector<double> voice = referenceFm(a, lanes, l, frames);
+            for (int i = 0; i < frames; ++i) expected[i] += voice[i];
+        }
+        std::vector<float> out(frames);
+        Fm::render(a, lanes, out.data(), 700); // Split, to carry state across calls
+        Fm::render(a, lanes, out.data() + 700, frames - 700);
+        double worst = 0.0;
+        for (int i = 0; i < frames; ++i) worst = std::max(worst, std::abs(out[i] - expected[i]));
+        ASSERT_TRUE(worst < 2e-3);
+    }
+
+    // Through the engine: the control grid does not depend on the block size (dry, as the
+    // send effects' modulation does)
+    auto renderFm = [](int preset, const std::vector<int>& blocks) {
+        SynthEngine synth;
+        synth.setSampleRate(44100.0);
+        Preset dry = PresetManager::getFactoryPreset(preset);
+        for (float& level : dry.sendLevel) level = 0.0f;
+        PresetManager::applyPreset(dry, synth);
+        std::vector<float> out;
+        DspBuffer buffer(2, SynthEngine::MAX_BLOCK);
+        for (int n = 0; n < 10; ++n) synth.noteOn(48 + n * 3, 60 + n * 6); // Steals two voices
+        size_t b = 0;
+        for (int rendered = 0; rendered < 30000;) {
+            if (rendered == 15000) synth.allNotesOff();
+            int end = rendered < 15000 ? 15000 : 30000;
+            buffer.resize(2, std::min(blocks[b++ % blocks.size()], end - rendered));
+            synth.render(buffer);
+            out.insert(out.end(), buffer.getChannel(0), buffer.getChannel(0) + buffer.getNumFrames());
+            rendered += buffer.getNumFrames();
+        }
+        return out;
+    };
+    for (int preset : { 7, 8 }) { // E.Piano, Bell
+        std::vector<float> even = renderFm(preset, { 500 });
+        ASSERT_TRUE(even == renderFm(preset, { 37, 1000, 3, 460 }));
+        float peak = 0.0f;
+        for (float v : even) peak = std::max(peak, std::abs(v));
+        ASSERT_TRUE(peak > 0.05f && peak < 1.0f);
+    }
+
+    // Voices finish after their release, also when skipped through (sends off, so only the voices count)
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    Preset piano = PresetManager::getFactoryPreset(7);
+    for (float& level : piano.sendLevel) level = 0.0f;
+    PresetManager::applyPreset(piano, synth);
+    synth.noteOn(60, 100);
+    DspBuffer buffer(2, 512);
+    synth.render(buffer);
+    ASSERT_TRUE(!synth.isSilent());
+    synth.noteOff(60);
+    synth.skip(44100);
+    ASSERT_TRUE(synth.isSilent());
+
+    // Notes go to the model selected when they start
+    synth.noteOn(60, 100);
+    synth.setSynthesisModel(0);
+    synth.noteOn(64, 100);
+    synth.setFmPatch(FmPatch()); // Silent operators: only the subtractive note is left
+    synth.noteOff(64);
+    synth.skip(44100);
+    ASSERT_TRUE(!synth.isSilent()); // The FM note is still held
+    synth.allNotesOff();
+    synth.skip(44100);
+    ASSERT_TRUE(synth.isSilent());
+
+    // Preset files round trip
+    Preset bell = PresetManager::getFactoryPreset(8);
+    PresetManager::savePreset("/tmp/rx_fm_preset.txt", bell);
+    Preset loaded = PresetManager::getFactoryPreset(0);
+    ASSERT_TRUE(PresetManager::loadPreset("/tmp/rx_fm_preset.txt", loaded));
+    std::remove("/tmp/rx_fm_preset.txt");
+    ASSERT_TRUE(loaded.synthesisModel == 1 && loaded.fm.algorithm == bell.fm.algorithm);
+    for (int op = 0; op < Fm::OPERATORS; ++op) {
+        ASSERT_NEAR(loaded.fm.ops[op].ratio, bell.fm.ops[op].ratio, 1e-6f);
+        ASSERT_NEAR(loaded.fm.ops[op].detune, bell.fm.ops[op].detune, 1e-6f);
+        ASSERT_NEAR(loaded.fm.ops[op].level, bell.fm.ops[op].level, 1e-6f);
+        ASSERT_NEAR(loaded.fm.ops[op].release, bell.fm.ops[op].release, 1e-6f);
+    }
+}
+
+void testUnisonVoiceThroughEngine() {
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(3), synth); // Super Saw
+    synth.noteOn(57, 110);
+    DspBuffer buffer(2, 512);
+    float energy = 0.0f;
+    for (int b = 0; b < 8; ++b) {
+        synth.render(buffer);
+        for (int i = 0; i < 512; ++i) energy += std::abs(buffer.getChannel(0)[i] - buffer.getChannel(1)[i]);
+    }
+    ASSERT_TRUE(energy > 0.0f); // Stereo spread reaches the output
+
+    synth.reset();
+    synth.setUnison(1, 0.0f, 0.0f); // Back to the single oscillator: mono again
+    synth.noteOn(57, 110);
+    synth.render(buffer);
+    for (int i = 0; i < 512; ++i) ASSERT_TRUE(buffer.getChannel(0)[i] == buffer.getChannel(1)[i]);
+
+    // From another thread while rendering: the change lands between blocks
+    std::atomic<bool> done{false};
+    std::thread ui([&] {
+        for (int k = 0; !done.load(); ++k) synth.setUnison(k % 2 ? 7 : 1, 0.5f, 1.0f);
+    });
+    for (int b = 0; b < 200; ++b) {
+        if (b % 8 == 0) synth.noteOn(50 + b % 24, 100);
+        synth.render(buffer);
+    }
+    done = true;
+    ui.join();
+    synth.setUnison(1, 0.0f, 0.0f);
+    synth.reset();
+    synth.noteOn(57, 110);
+    synth.render(buffer);
+    for (int i = 0; i < 512; ++i) ASSERT_TRUE(buffer.getChannel(0)[i] == buffer.getChannel(1)[i]);
+}
+
+void testModMatrixSources() {
+    ModSettings settings;
+    settings.lfoRate[0] = 10.0f;
+    settings.lfoShape[0] = LfoShape::Square;
+    settings.addRoute(ModSource::Velocity, ModDestination::Amp, -0.5f);
+    settings.addRoute(ModSource::KeyTrack, ModDestination::Cutoff, 1.0f);
+    settings.addRoute(ModSource::Lfo1, ModDestination::Pitch, 2.0f);
+    settings.addRoute(ModSource::Envelope2, ModDestination::Resonance, 0.5f);
+
+    ModMatrix matrix;
+    matrix.setSampleRate(1000.0);
+    matrix.setSettings(settings);
+    matrix.noteOn(72, 1.0f, true);
+
+    ModTargets t = matrix.evaluate();
+    ASSERT_NEAR(t.amp, 0.5f, 1e-6f);
+    ASSERT_NEAR(t.cutoffOctaves, 1.0f, 1e-6f); // One octave above middle C
+    ASSERT_NEAR(t.pitchSemitones, 2.0f, 1e-6f); // Square LFO starts high
+    ASSERT_NEAR(t.resonance, 0.0f, 1e-6f);
+
+    matrix.advance(60); // Past half an LFO period, and through the 10 ms attack
+    t = matrix.evaluate();
+    ASSERT_NEAR(t.pitchSemitones, -2.0f, 1e-6f);
+    ASSERT_TRUE(t.resonance > 0.3f);
+
+    matrix.noteOff();
+    matrix.advance(1000);
+    ASSERT_NEAR(matrix.evaluate().resonance, 0.0f, 1e-6f);
+
+    // Control interval is clamped to the voice's sub-block buffer
+    settings.controlInterval = 1000;
+    matrix.setSettings(settings);
+    ASSERT_TRUE(matrix.getControlInterval() == ModSettings::MAX_CONTROL_INTERVAL);
+}
+
+static std::vector<float> renderNote(SynthEngine& synth, int blocks) {
+    DspBuffer buffer(2, 512);
+    std::vector<float> out;
+    synth.noteOn(48, 100);
+    for (int b = 0; b < blocks; ++b) {
+        if (b == blocks / 2) synth.noteOff(48);
+        synth.render(buffer);
+        out.insert(out.end(), buffer.getChannel(0), buffer.getChannel(0) + 512);
+    }
+    return out;
+}
+
+void testModulatedVoice() {
+    Preset preset = PresetManager::getFactoryPreset(0);
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    PresetManager::applyPreset(preset, synth);
+    std::vector<float> staticPatch = renderNote(synth, 16);
+
+    // Zero-depth routes take the control-rate path but must not change a sample:
+    // sub-block rendering and parameter glides are seamless
+    for (int source = 0; source <= (int)ModSource::ModWheel; ++source) {
+        preset.modulation.addRoute((ModSource)source, ModDestination::Cutoff, 0.0f);
+    }
+    preset.modulation.addRoute(ModSource::Lfo1, ModDestination::Pitch, 0.0f);
+    preset.modulation.controlInterval = 24; // Does not divide the block size
+    synth.reset();
+    PresetManager::applyPreset(preset, synth);
+    ASSERT_TRUE(renderNote(synth, 16) == staticPatch);
+
+    // A real sweep changes the sound but stays bounded
+    synth.reset();
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(4), synth); // Wobble Bass
+    synth.setModWheel(1.0f);
+    std::vector<float> wobble = renderNote(synth, 16);
+    float peak = 0.0f;
+    for (float v : wobble) peak = std::max(peak, std::abs(v));
+    ASSERT_TRUE(peak > 0.01f && peak < 1.0f);
+
+    // Clearing the routes restores the static patch exactly
+    synth.reset();
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(0), synth);
+    ASSERT_TRUE(renderNote(synth, 16) == staticPatch);
+}
+
+// Mod routes can push the cutoff to the Nyquist guard; the filter must stay stable there
+void testFactoryPresetsStayBounded() {
+    DspBuffer buffer(2, 512);
+    for (int p = 0; p < PresetManager::getFactoryPresetCount(); ++p) {
+        for (uint8_t wheel : { 0, 127 }) {
+            for (int note : { 24, 36, 48, 55, 60, 64, 72, 84, 96, 108 }) {
+                SynthEngine synth;
+                synth.setSampleRate(44100.0);
+                PresetManager::applyPreset(PresetManager::getFactoryPreset(p), synth);
+                synth.handleMidiEvent({ 0, 0xB0, 1, wheel });
+                synth.noteOn(note, 127);
+                float peak = 0.0f;
+                for (int b = 0; b < 120; ++b) {
+                    if (b == 100) synth.noteOff(note);
+                    synth.render(buffer);
+                    for (int c = 0; c < 2; ++c) {
+                        for (int i = 0; i < 512; ++i) {
+                            float v = std::abs(buffer.getChannel(c)[i]);
+                            peak = v <= peak ? peak : v; // NaN lands here too
+                        }
+                    }
+                }
+                ASSERT_TRUE(peak > 0.0f && peak < 1.0f);
+            }
+        }
+    }
+}
+
+// A note played after the engine has gone silent sounds as it would on a fresh engine,
+// however the voices were left (SegmentedRenderer relies on this)
+void testNoteAfterSilenceMatchesFresh() {
+    auto play = [](SynthEngine& synth, int note, int blocks) {
+        DspBuffer buffer(2, 512);
+        std::vector<float> out;
+        synth.noteOn(note, 100);
+        for (int b = 0; b < blocks; ++b) {
+            if (b == blocks / 2) synth.noteOff(note);
+            synth.render(buffer);
+            out.insert(out.end(), buffer.getChannel(0), buffer.getChannel(0) + 512);
+            out.insert(out.end(), buffer.getChannel(1), buffer.getChannel(1) + 512);
+        }
+        return out;
+    };
+    for (int p = 0; p < PresetManager::getFactoryPresetCount(); ++p) {
+        Preset preset = PresetManager::getFactoryPreset(p);
+        SynthEngine fresh, reused;
+        for (SynthEngine* synth : { &fresh, &reused }) {
+            synth->setSampleRate(44100.0);
+            PresetManager::applyPreset(preset, *synth);
+        }
+        play(reused, 55, 20); // A glide would start from here
+        DspBuffer buffer(2, 300); // Leaves FM's 16-frame control grid out of step with the block
+        for (int b = 0; b < 1000 && !reused.isSilent(); ++b) reused.render(buffer);
+        ASSERT_TRUE(reused.isSilent());
+        ASSERT_TRUE(play(reused, 48, 40) == play(fresh, 48, 40));
+    }
+}
+
+void testPresetModulationRoundTrip() {
+    Preset original = PresetManager::getFactoryPreset(4);
+    original.modulation.lfoShape[1] = LfoShape::Saw;
+    original.modulation.controlInterval = 32;
+    PresetManager::savePreset("/tmp/rx_mod_preset.txt", original);
+
+    Preset loaded = PresetManager::getFactoryPreset(0);
+    loaded.modulation.addRoute(ModSource::Lfo2, ModDestination::Amp, 1.0f); // Must be replaced, not appended to
+    ASSERT_TRUE(PresetManager::loadPreset("/tmp/rx_mod_preset.txt", loaded));
+    std::remove("/tmp/rx_mod_preset.txt");
+
+    ASSERT_TRUE(loaded.modulation.numRoutes == original.modulation.numRoutes);
+    for (int i = 0; i < loaded.modulation.numRoutes; ++i) {
+        ASSERT_TRUE(loaded.modulation.routes[i].source == original.modulation.routes[i].source);
+        ASSERT_TRUE(loaded.modulation.routes[i].destination == original.modulation.routes[i].destination);
+        ASSERT_NEAR(loaded.modulation.routes[i].amount, original.modulation.routes[i].amount, 1e-6f);
+    }
+    ASSERT_TRUE(loaded.modulation.lfoShape[1] == LfoShape::Saw);
+    ASSERT_TRUE(loaded.modulation.controlInterval == 32);
+    ASSERT_NEAR(loaded.modulation.lfoRate[0], 3.0f, 1e-6f);
+}
+
+// Rising zero crossings per second over `frames` of a held note
+static float measurePitch(SynthEngine& synth, int frames) {
+    DspBuffer buffer(2, 256);
+    int crossings = 0;
+    float previous = 0.0f;
+    for (int done = 0; done < frames; done += 256) {
+        synth.render(buffer);
+        const float* left = buffer.getChannel(0);
+        for (int i = 0; i < 256; ++i) {
+            if (previous < 0.0f && left[i] >= 0.0f) crossings++;
+            previous = left[i];
+        }
+    }
+    return crossings * 44100.0f / frames;
+}
+
+void testPitchModulation() {
+    Preset sine = { "Sine", 8000.0f, 0.2f, 0.001f, 0.1f, 1.0f, 0.01f, 0 };
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    PresetManager::applyPreset(sine, synth);
+    std::vector<float> plain = renderNote(synth, 16);
+
+    // Portamento with nothing to glide from and zero-depth vibrato keep the static path
+    synth.reset();
+    synth.setPortamento(0.1f);
+    synth.setVibrato(6.0f, 0.0f);
+    ASSERT_TRUE(renderNote(synth, 16) == plain);
+    synth.setPortamento(0.0f);
+
+    // A full bend over an octave range doubles the pitch; MIDI bend messages drive it too
+    synth.reset();
+    synth.setPitchBendRange(12.0f);
+    synth.noteOn(57, 100); // 220 Hz
+    measurePitch(synth, 2048);
+    ASSERT_NEAR(measurePitch(synth, 44032), 220.0f, 2.0f);
+    synth.handleMidiEvent({ 0, 0xE0, 0x7F, 0x7F });
+    measurePitch(synth, 256);
+    ASSERT_NEAR(measurePitch(synth, 44032), 440.0f, 2.0f);
+    synth.handleMidiEvent({ 0, 0xE0, 0x00, 0x40 }); // Centre
+    measurePitch(synth, 256);
+    ASSERT_NEAR(measurePitch(synth, 44032), 220.0f, 2.0f);
+    synth.noteOff(57);
+    while (!synth.isSilent()) measurePitch(synth, 256);
+
+    // Glides up from a note that is still sounding (releasing, here) and lands on the target
+    synth.setPortamento(0.2f);
+    synth.noteOn(57, 100);
+    measurePitch(synth, 2048);
+    synth.noteOff(57);
+    synth.noteOn(69, 100); // From 57: 220 Hz to 440 Hz
+    measurePitch(synth, 512); // Past 57's release
+    float early = measurePitch(synth, 2048);
+    ASSERT_TRUE(early > 215.0f && early < 330.0f);
+    measurePitch(synth, 8192);
+    ASSERT_NEAR(measurePitch(synth, 44032), 440.0f, 2.0f);
+    synth.noteOff(69);
+    while (!synth.isSilent()) measurePitch(synth, 256);
+
+    // After silence there is nothing to glide from
+    synth.noteOn(57, 100);
+    ASSERT_NEAR(measurePitch(synth, 8192), 220.0f, 6.0f); // Gliding from 69 would average far above
+    synth.noteOff(57);
+    while (!synth.isSilent()) measurePitch(synth, 256);
+    synth.setPortamento(0.0f);
+
+    // Vibrato swings around the note and averages out over whole cycles
+    synth.setVibrato(5.0f, 1.0f);
+    synth.noteOn(57, 100);
+    float lowest = 1e9f, highest = 0.0f;
+    for (int i = 0; i < 40; ++i) {
+        float f = measurePitch(synth, 2048);
+        lowest = std::min(lowest, f);
+        highest = std::max(highest, f);
+    }
+    ASSERT_TRUE(lowest < 212.0f && highest > 228.0f);
+    ASSERT_TRUE(lowest > 190.0f && highest < 250.0f); // 1 semitone: 207.7..233.1 Hz
+    ASSERT_NEAR(measurePitch(synth, 44100 / 5 * 5), 220.0f, 3.0f);
+}
+
+void testPresetPitchRoundTrip() {
+    Preset original = PresetManager::getFactoryPreset(6); // Glide Lead
+    original.bendRange = 7.0f;
+    PresetManager::savePreset("/tmp/rx_pitch_preset.txt", original);
+    Preset loaded = PresetManager::getFactoryPreset(0);
+    ASSERT_TRUE(PresetManager::loadPreset("/tmp/rx_pitch_preset.txt", loaded));
+    std::remove("/tmp/rx_pitch_preset.txt");
+    ASSERT_NEAR(loaded.glideTime, original.glideTime, 1e-6f);
+    ASSERT_NEAR(loaded.bendRange, 7.0f, 1e-6f);
+    ASSERT_NEAR(loaded.vibratoRate, original.vibratoRate, 1e-6f);
+    ASSERT_NEAR(loaded.vibratoDepth, original.vibratoDepth, 1e-6f);
+}
+
+void testAutomationLanes() {
+    AutomationLane lane;
+    lane.add(1000, 2.0f);
+    lane.add(0, 0.0f); // Out of order
+    lane.add(3000, 2.0f);
+    lane.add(1000, 1.0f); // Replaces
+    ASSERT_TRUE(lane.getPoints().size() == 3);
+    ASSERT_NEAR(lane.valueAt(500), 0.5f, 1e-6f);
+    ASSERT_NEAR(lane.valueAt(2000), 1.5f, 1e-6f);
+    ASSERT_NEAR(lane.valueAt(9000), 2.0f, 1e-6f); // Held after the last point
+    ASSERT_NEAR(lane.valueAt(250), 0.25f, 1e-6f); // Backwards re-seeks
+    ASSERT_TRUE(!lane.isFlat(0, 64) && lane.isFlat(3000, 512) && lane.isFlat(5000, 64));
+    lane.seek(2500);
+    ASSERT_NEAR(lane.valueAt(2500), 1.75f, 1e-6f);
+
+    // Capture keeps only the ends of a held value
+    AutomationLane captured;
+    for (uint64_t f = 0; f < 10000; f += 100) captured.record(f, f < 5000 ? 1.0f : 3.0f);
+    ASSERT_TRUE(captured.getPoints().size() == 4);
+    ASSERT_NEAR(captured.valueAt(4900), 1.0f, 1e-6f);
+    ASSERT_NEAR(captured.valueAt(9900), 3.0f, 1e-6f);
+
+    // Lanes that never move render exactly like no automation at all
+    SynthEngine plain, automated;
+    Preset preset = PresetManager::getFactoryPreset(0);
+    PresetManager::applyPreset(preset, plain);
+    PresetManager::applyPreset(preset, automated);
+    Automation flat;
+    flat.lane(AutomationTarget::Cutoff).add(0, preset.cutoff);
+    flat.lane(AutomationTarget::Sustain).add(44100, preset.sustain);
+    flat.lane(AutomationTarget::Volume).add(22050, 0.2f);
+    DspBuffer a(2, 512), b(2, 512);
+    plain.noteOn(48, 100);
+    automated.noteOn(48, 100);
+    bool same = true;
+    for (int block = 0; block < 40; ++block) {
+        plain.render(a);
+        flat.render(automated, b, (uint64_t)block * 512);
+        same = same && std::equal(a.getChannel(0), a.getChannel(0) + 512, b.getChannel(0));
+    }
+    ASSERT_TRUE(same);
+}
+
+void testAutomatedRender() {
+    std::vector<uint8_t> smf = makeTestSong();
+    MidiFile midi;
+    ASSERT_TRUE(midi.loadFromMemory(smf.data(), smf.size()));
+    Automation automation;
+    AutomationLane& cutoff = automation.lane(AutomationTarget::Cutoff);
+    cutoff.add(0, 200.0f);
+    cutoff.add(20000, 6000.0f);
+    cutoff.add(40000, 300.0f);
+    automation.lane(AutomationTarget::Volume).add(30000, 0.2f);
+    automation.lane(AutomationTarget::Volume).add(50000, 0.05f);
+    automation.lane(AutomationTarget::Release).add(0, 0.05f);
+
+    // The timeline does not depend on the block size
+    auto renderWith = [&](int blockSize, bool automated) {
+        OfflineRenderer renderer(44100.0, blockSize);
+        renderer.setTailSeconds(0.5);
+        if (automated) renderer.setAutomation(automation);
+        WavWriter writer;
+        writer.open("/tmp/rx_automation.wav", 2, 44100);
+        renderer.render(midi, writer);
+        WavReader reader;
+        reader.load("/tmp/rx_automation.wav");
+        std::remove("/tmp/rx_automation.wav");
+        return reader.getChannel(0);
+    };
+    std::vector<float> big = renderWith(512, true);
+    ASSERT_TRUE(big == renderWith(96, true));
+    ASSERT_TRUE(big != renderWith(512, false));
+
+    // Text round trip lands on the same frames
+    ASSERT_TRUE(automation.save("/tmp/rx_automation.txt", 44100.0));
+    Automation loaded;
+    ASSERT_TRUE(loaded.load("/tmp/rx_automation.txt", 44100.0));
+    std::remove("/tmp/rx_automation.txt");
+    const auto& points = loaded.lane(AutomationTarget::Cutoff).getPoints();
+    ASSERT_TRUE(points.size() == 3 && points[1].frame == 20000 && points[1].value == 6000.0f);
+    ASSERT_TRUE(loaded.lane(AutomationTarget::Volume).getPoints().size() == 2);
+
+    // Recording a fader through the C API, then playing it back
+    rx_engine* engine = rx_create(44100.0);
+    std::vector<float> left(256), right(256);
+    float* outs[2] = { left.data(), right.data() };
+    rx_event note = { 0, 0x90, 48, 100 };
+    rx_automation_record(engine, 1);
+    for (int block = 0; block < 8; ++block) {
+        rx_set_param(engine, RX_PARAM_MASTER_VOLUME, block < 4 ? 0.2f : 0.0f);
+        rx_process(engine, outs, 256, &note, block == 0 ? 1 : 0);
+    }
+    rx_automation_record(engine, 0);
+    ASSERT_TRUE(rx_get_position(engine) == 8 * 256);
+    ASSERT_TRUE(rx_automation_add(engine, RX_PARAM_WAVEFORM, 0, 1.0f) == 0); // No lane
+
+    rx_reset(engine);
+    rx_set_param(engine, RX_PARAM_MASTER_VOLUME, 0.2f); // Not recorded; playback overrides it
+    rx_set_position(engine, 0);
+    float first = 0.0f, last = 0.0f;
+    for (int block = 0; block < 8; ++block) {
+        rx_process(engine, outs, 256, &note, block == 0 ? 1 : 0);
+        for (float v : left) {
+            if (block == 1) first = std::max(first, std::abs(v));
+            if (block == 7) last = std::max(last, std::abs(v));
+        }
+    }
+    ASSERT_TRUE(first > 0.01f && last == 0.0f);
+    rx_destroy(engine);
+}
+
+void testModulatedDelay() {
+    // Integer delay, no modulation: exact echoes at 100 and 200 frames
+    ModulatedDelay echo;
+    echo.prepare(1000.0, 64);
+    echo.setSettings({ 100.0f, 0.0f, 0.0f, 0.5f, 0.0f });
+    std::vector<float> out;
+    std::mt19937 rng(5);
+    DspBuffer buffer(2, 1);
+    for (int pos = 0; pos < 400;) {
+        int n = std::min(1 + (int)(rng() % 37), 400 - pos);
+        buffer.resize(2, n);
+        buffer.clear();
+        if (pos == 0) buffer.getChannel(0)[0] = 1.0f;
+        echo.process(buffer);
+        out.insert(out.end(), buffer.getChannel(0), buffer.getChannel(0) + n);
+        pos += n;
+    }
+    for (int i = 0; i < 400; ++i) {
+        float expected = i == 100 ? 1.0f : i == 200 ? 0.5f : i == 300 ? 0.25f : 0.0f;
+        ASSERT_TRUE(out[i] == expected);
+    }
+    ASSERT_TRUE(ModulatedDelay::tailFrames(echo.getSettings(), 1000.0) >= 1300);
+
+    // Fractional delay of a slow sine
+    ModulatedDelay fractional;
+    fractional.prepare(1000.0, 256);
+    fractional.setSettings({ 10.5f, 0.0f, 0.0f, 0.0f, 0.0f });
+    buffer.resize(2, 256);
+    for (int i = 0; i < 256; ++i) buffer.getChannel(0)[i] = buffer.getChannel(1)[i] = std::sin(2.0f * (float)M_PI * 10.0f * i / 1000.0f);
+    fractional.process(buffer);
+    for (int i = 20; i < 256; ++i) {
+        ASSERT_NEAR(buffer.getChannel(0)[i], std::sin(2.0f * (float)M_PI * 10.0f * (i - 10.5f) / 1000.0f), 1e-4f);
+    }
+
+    // A swept chorus does not depend on how the stream is cut into blocks
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> input(8000);
+    for (auto& v : input) v = noise(rng);
+    auto run = [&](int maxBlock) {
+        ModulatedDelay chorus;
+        chorus.prepare(44100.0, 512);
+        chorus.setSettings(DelaySettings::flanger());
+        std::vector<float> result;
+        DspBuffer block(2, 1);
+        for (int pos = 0; pos < (int)input.size();) {
+            int n = std::min(1 + (int)(rng() % maxBlock), (int)input.size() - pos);
+            block.resize(2, n);
+            for (int c = 0; c < 2; ++c) std::copy(input.begin() + pos, input.begin() + pos + n, block.getChannel(c));
+            chorus.process(block);
+            result.insert(result.end(), block.getChannel(1), block.getChannel(1) + n);
+            pos += n;
+        }
+        return result;
+    };
+    std::vector<float> whole = run(1), pieces = run(300);
+    float worst = 0.0f;
+    for (size_t i = 0; i < whole.size(); ++i) worst = std::max(worst, std::abs(whole[i] - pieces[i]));
+    ASSERT_TRUE(worst < 1e-3f);
+}
+
+void testSendBuses() {
+    // A configured bus with nothing sent to it leaves the output untouched
+    SynthEngine dry, idle;
+    dry.setSampleRate(44100.0);
+    idle.setSampleRate(44100.0);
+    idle.setSendEffect(0, DelaySettings::chorus());
+    ASSERT_TRUE(renderNote(dry, 40) == renderNote(idle, 40));
+
+    // Echo keeps the engine busy after the voices finish, then lets it go idle
+    SynthEngine wet;
+    wet.setSampleRate(44100.0);
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(5), wet);
+    renderNote(wet, 40);
+    DspBuffer buffer(2, 512);
+    int blocks = 0;
+    float tailEnergy = 0.0f;
+    while (!wet.isSilent() && blocks < 1000) {
+        wet.render(buffer);
+        for (int i = 0; i < 512; ++i) tailEnergy += std::abs(buffer.getChannel(0)[i]);
+        blocks++;
+    }
+    ASSERT_TRUE(tailEnergy > 1.0f);
+    ASSERT_TRUE(blocks > 100 && blocks < 1000); // Echo tail of several seconds, but it ends
+
+    // Send levels and effect settings survive a preset round trip
+    Preset original = PresetManager::getFactoryPreset(5);
+    original.sendEffect[1].feedback = 0.6f;
+    PresetManager::savePreset("/tmp/rx_send_preset.txt", original);
+    Preset loaded = PresetManager::getFactoryPreset(0);
+    ASSERT_TRUE(PresetManager::loadPreset("/tmp/rx_send_preset.txt", loaded));
+    std::remove("/tmp/rx_send_preset.txt");
+    ASSERT_NEAR(loaded.sendLevel[0], 0.8f, 1e-6f);
+    ASSERT_NEAR(loaded.sendLevel[1], 0.35f, 1e-6f);
+    ASSERT_NEAR(loaded.sendEffect[0].delayMs, original.sendEffect[0].delayMs, 1e-6f);
+    ASSERT_NEAR(loaded.sendEffect[1].feedback, 0.6f, 1e-6f);
+}
+
+void testStageProfiler() {
+    // Profiling splits the graph into separate node calls but must not change a sample
+    SynthEngine plain, profiled;
+    plain.setSampleRate(44100.0);
+    profiled.setSampleRate(44100.0);
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(5), plain); // Sends exercise the output stage
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(5), profiled);
+    PerfProfiler profiler;
+    profiler.open(); // Counters may be unavailable here; timing still works
+    profiled.setProfiler(&profiler);
+    ASSERT_TRUE(renderNote(plain, 16) == renderNote(profiled, 16));
+
+    // One voice for 16 blocks: three node stages and one mix per voice, one output pass per block
+    for (PerfStage stage : { PerfStage::Oscillator, PerfStage::Filter, PerfStage::Envelope, PerfStage::Mix }) {
+        ASSERT_TRUE(profiler.get(stage, 1).calls == 16);
+    }
+    ASSERT_TRUE(profiler.get(PerfStage::Output, 1).calls == 16);
+    ASSERT_TRUE(profiler.total(PerfStage::Oscillator).nanoseconds > 0);
+    if (profiler.isAvailable(PerfProfiler::Instructions)) {
+        ASSERT_TRUE(profiler.total(PerfStage::Oscillator).value[PerfProfiler::Instructions] > 0);
+    }
+
+    // Filed under the number of voices sounding in the block
+    DspBuffer buffer(2, 512);
+    for (int b = 0; b < 1000 && !profiled.isSilent(); ++b) profiled.render(buffer); // Let the release and echo finish
+    profiler.clear();
+    for (int note : { 60, 64, 67 }) profiled.noteOn(note, 100);
+    profiled.render(buffer);
+    ASSERT_TRUE(profiler.get(PerfStage::Filter, 3).calls == 3);
+    ASSERT_TRUE(profiler.get(PerfStage::Output, 3).calls == 1);
+    ASSERT_TRUE(profiler.total(PerfStage::Filter).calls == 3);
+
+    std::ostringstream report;
+    profiler.print(report);
+    ASSERT_TRUE(report.str().find(profiler.getStatus()) != std::string::npos);
+    ASSERT_TRUE(report.str().find("oscillator") != std::string::npos);
+
+    // Detached, nothing more is recorded
+    profiled.setProfiler(nullptr);
+    profiled.render(buffer);
+    ASSERT_TRUE(profiler.total(PerfStage::Filter).calls == 3);
+}
+
+static int countOf(const std::string& text, const std::string& needle) {
+    int n = 0;
+    for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) n++;
+    return n;
+}
+
+void testTraceExport() {
+    Trace::setEnabled(false);
+    Trace::configure(256);
+    Trace::setEnabled(true);
+
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(0), synth);
+    renderNote(synth, 4);
+
+    // A named worker overrunning its ring keeps only its latest events
+    std::thread worker([] {
+        RX_TRACE_THREAD("test-worker");
+        for (int i = 0; i < 1000; ++i) RX_TRACE_SCOPE_ARG("work", i);
+    });
+    worker.join();
+    Trace::setEnabled(false);
+    renderNote(synth, 4); // Not recorded
+
+    std::ostringstream out;
+    Trace::writeChromeJson(out);
+    std::string json = out.str();
+    ASSERT_TRUE(json.rfind("{\"traceEvents\":[", 0) == 0);
+    ASSERT_TRUE(countOf(json, "\"name\":\"SynthEngine::render\"") == 4);
+    ASSERT_TRUE(countOf(json, "\"name\":\"Voice::render\"") == 4);
+    ASSERT_TRUE(countOf(json, "\"name\":\"FilterNode\"") == 4);
+    ASSERT_TRUE(countOf(json, "PresetManager::applyPreset") == 1);
+    ASSERT_TRUE(countOf(json, "\"args\":{\"name\":\"test-worker\"}") == 1);
+    // One slot is held back in case its owner is mid-write
+    ASSERT_TRUE(countOf(json, "\"name\":\"work\"") == 255);
+    ASSERT_TRUE(countOf(json, "\"value\":999}") == 1);
+    ASSERT_TRUE(countOf(json, "\"value\":744}") == 0);
+
+    // Snapshots taken while a thread keeps writing only contain whole events
+    Trace::clear();
+    Trace::setEnabled(true);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        while (!done.load()) RX_TRACE_SCOPE_ARG("spin", 7);
+    });
+    bool wellFormed = true;
+    for (int i = 0; i < 20; ++i) {
+        std::ostringstream snapshot;
+        Trace::writeChromeJson(snapshot);
+        std::string s = snapshot.str();
+        wellFormed &= countOf(s, "\"name\":\"spin\"") == countOf(s, "\"value\":7}");
+    }
+    done = true;
+    writer.join();
+    Trace::setEnabled(false);
+    Trace::clear();
+    ASSERT_TRUE(wellFormed);
+
+    // Threads that name themselves while tracing is off take no ring, so a full set of
+    // them does not crowd out a thread that records once tracing is on
+    std::atomic<bool> release{false};
+    std::atomic<int> named{0};
+    std::vector<std::thread> idle;
+    for (int i = 0; i < Trace::MAX_THREADS; ++i) {
+        idle.emplace_back([&] {
+            RX_TRACE_THREAD("idle");
+            named++;
+            while (!release.load()) std::this_thread::yield();
+        });
+    }
+    while (named.load() < Trace::MAX_THREADS) std::this_thread::yield();
+    Trace::setEnabled(true);
+    std::thread late([] {
+        RX_TRACE_THREAD("late");
+        RX_TRACE_INSTANT("late-event");
+    });
+    late.join();
+    Trace::setEnabled(false);
+    release = true;
+    for (auto& t : idle) t.join();
+    std::ostringstream lateOut;
+    Trace::writeChromeJson(lateOut);
+    std::string lateJson = lateOut.str();
+    ASSERT_TRUE(countOf(lateJson, "\"name\":\"late-event\"") == 1);
+    ASSERT_TRUE(countOf(lateJson, "\"args\":{\"name\":\"late\"}") == 1);
+    ASSERT_TRUE(countOf(lateJson, "\"args\":{\"name\":\"idle\"}") == 0);
+    Trace::clear();
+}
+
+static long minorFaults() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_minflt;
+}
+
+void testRealtimeArena() {
+    RealtimeArena arena(100000);
+    ASSERT_TRUE(arena.getCapacity() >= 100000 && arena.getCapacity() % 4096 == 0);
+    void* a = arena.allocate(10);
+    void* b = arena.allocate(10);
+    ASSERT_TRUE(a && b && ((uintptr_t)a % RealtimeArena::ALIGNMENT) == 0 && ((uintptr_t)b % RealtimeArena::ALIGNMENT) == 0);
+    ASSERT_TRUE(arena.allocate(200000) == nullptr);
+    ASSERT_TRUE(!arena.getError().empty());
+
+    // An engine built in an arena renders exactly like one on the heap
+    RealtimeArena engineArena(1 << 18);
+    SynthEngine* inArena = engineArena.create<SynthEngine>();
+    ASSERT_TRUE(inArena != nullptr);
+    ASSERT_TRUE(inArena->allocateFrom(engineArena));
+    SynthEngine onHeap;
+    for (SynthEngine* synth : { inArena, &onHeap }) {
+        synth->setSampleRate(44100.0);
+        PresetManager::applyPreset(PresetManager::getFactoryPreset(5), *synth);
+    }
+    ASSERT_TRUE(renderNote(*inArena, 16) == renderNote(onHeap, 16));
+    ASSERT_TRUE(engineArena.getUsed() >= sizeof(SynthEngine));
+
+    engineArena.lock(); // May fail under a low RLIMIT_MEMLOCK; prefaulting alone stops the faults
+    engineArena.prefault();
+    std::ostringstream footprint;
+    engineArena.printFootprint(footprint);
+    ASSERT_TRUE(footprint.str().find("prefaulted") != std::string::npos);
+
+    // Voices waking for the first time touch nothing outside the prefaulted region
+    DspBuffer out(2, 512);
+    out.allocateFrom(engineArena, 512);
+    inArena->render(out);
+    long before = minorFaults();
+    for (int note = 60; note < 68; ++note) inArena->noteOn(note, 100);
+    for (int b = 0; b < 50; ++b) inArena->render(out);
+    ASSERT_TRUE(minorFaults() == before);
+}
+
+// Deterministic test content: a ramp every 1000 frames, inverted on the right
+struct TapLog {
+    const float* first = nullptr; // Left channel of the first piece
+    int frames = 0;
+};
+
+static void logTap(const float* const* channels, int frames, void* user) {
+    TapLog* log = (TapLog*)user;
+    if (!log->first) log->first = channels[0];
+    log->frames += frames;
+}
+
+void testCApiZeroCopy() {
+    // Longer than MAX_BLOCK, with events mid-block
+    const int frames = SynthEngine::MAX_BLOCK * 2 + 300;
+    std::vector<float> left(frames), right(frames);
+    float* outs[2] = { left.data(), right.data() };
+    rx_event events[] = { { 0, 0x90, 48, 100 }, { 700, 0x90, 55, 90 }, { 1500, 0xE0, 0x00, 0x60 }, { 2100, 0x80, 48, 0 } };
+    rx_engine* engine = rx_create(44100.0);
+    TapLog log;
+    rx_set_tap(engine, logTap, &log);
+    rx_process(engine, outs, frames, events, 4);
+    ASSERT_TRUE(log.first == left.data()); // The tap sees the host's memory: rendered in place
+    ASSERT_TRUE(log.frames == frames);
+    ASSERT_NEAR(rx_get_param(engine, RX_PARAM_PITCH_BEND), 0.5f, 1e-6f); // Tracked from the event
+
+    // Same as driving the engine directly, split at the same offsets
+    SynthEngine synth;
+    synth.setSampleRate(44100.0);
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(0), synth);
+    synth.setMasterVolume(0.2f);
+    std::vector<float> expected;
+    DspBuffer buffer(2, SynthEngine::MAX_BLOCK);
+    int cuts[] = { 0, 700, SynthEngine::MAX_BLOCK, 1500, 2048, 2100, frames };
+    for (int i = 0; i + 1 < 7; ++i) {
+        for (const rx_event& e : events) {
+            if ((int)e.frame == cuts[i]) synth.handleMidiEvent({ 0, e.status, e.data1, e.data2 });
+        }
+        buffer.resize(2, cuts[i + 1] - cuts[i]);
+        synth.render(buffer);
+        expected.insert(expected.end(), buffer.getChannel(0), buffer.getChannel(0) + buffer.getNumFrames());
+    }
+    ASSERT_TRUE(expected == left);
+
+    // Parameters reach the engine and read back
+    rx_set_param(engine, RX_PARAM_CUTOFF, 900.0f);
+    ASSERT_NEAR(rx_get_param(engine, RX_PARAM_CUTOFF), 900.0f, 1e-6f);
+    ASSERT_TRUE(rx_load_preset(engine, 3) == 1 && rx_load_preset(engine, 99) == 0);
+    ASSERT_NEAR(rx_get_param(engine, RX_PARAM_CUTOFF), PresetManager::getFactoryPreset(3).cutoff, 1e-6f);
+    rx_destroy(engine);
+}
+
+void testEventLogReplay() {
+    const char* logPath = "/tmp/rx_session.rxlog";
+    rx_engine* engine = rx_create_logged(44100.0, logPath);
+    ASSERT_TRUE(engine != nullptr);
+    ASSERT_TRUE(rx_create_logged(44100.0, "/nonexistent/dir/x.rxlog") == nullptr);
+
+    // Ragged callbacks, events mid-block, parameter and preset changes, an automation lane
+    rx_automation_add(engine, RX_PARAM_CUTOFF, 0, 300.0f);
+    rx_automation_add(engine, RX_PARAM_CUTOFF, 6000, 5000.0f);
+    std::vector<float> session;
+    std::vector<float> left(SynthEngine::MAX_BLOCK * 2), right(left.size());
+    float* outs[2] = { left.data(), right.data() };
+    int sizes[] = { 64, 441, 1500, 7, 256, 2048, 333 };
+    int callbacks = 0;
+    for (int round = 0; round < 3; ++round) {
+        for (int frames : sizes) {
+            rx_event events[] = { { 0, 0x90, (uint8_t)(48 + callbacks % 12), 100 },
+                                  { (uint32_t)frames / 2, 0x80, (uint8_t)(48 + (callbacks + 11) % 12), 0 },
+                                  { (uint32_t)frames / 3, 0xB0, 1, (uint8_t)(callbacks * 9 % 128) } };
+            if (callbacks == 5) rx_set_param(engine, RX_PARAM_WAVEFORM, 3.0f);
+            if (callbacks == 9) rx_load_preset(engine, 2);
+            if (callbacks == 15) rx_load_preset(engine, 7); // FM
+            if (callbacks == 12) rx_set_param(engine, RX_PARAM_PITCH_BEND, -0.4f);
+            rx_process(engine, outs, frames, events, 3);
+            session.insert(session.end(), left.begin(), left.begin() + frames);
+            callbacks++;
+        }
+    }
+    rx_destroy(engine); // Closes the log
+
+    EventLogFile log;
+    ASSERT_TRUE(log.load(logPath));
+    ASSERT_TRUE(log.isComplete() && log.getDroppedRecords() == 0);
+    ASSERT_NEAR(log.getSampleRate(), 44100.0, 1e-9);
+
+    // The replay is sample for sample the session, with one timing per callback
+    WavWriter writer;
+    ASSERT_TRUE(writer.open("/tmp/rx_replay.wav", 2, 44100));
+    std::vector<CallbackTiming> timings;
+    RenderStats stats = OfflineRenderer(44100.0).replay(log, writer, &timings);
+    ASSERT_TRUE(stats.ok && stats.frames == session.size());
+    WavReader reader;
+    ASSERT_TRUE(reader.load("/tmp/rx_replay.wav"));
+    ASSERT_TRUE(reader.getChannel(0) == session);
+    ASSERT_TRUE((int)timings.size() == callbacks);
+    ASSERT_TRUE(timings[2].frame == 64 + 441 && timings[2].frames == 1500);
+    for (const auto& t : timings) ASSERT_TRUE(t.loggedUs > 0.0 && t.replayedUs > 0.0);
+
+    // A log cut short by a crash still replays up to where it stops
+    std::vector<char> bytes = readFile(logPath);
+    bytes.resize(bytes.size() - 40 * sizeof(EventRecord));
+    {
+        std::ofstream f(logPath, std::ios::binary);
+        f.write(bytes.data(), bytes.size());
+    }
+    EventLogFile truncated;
+    ASSERT_TRUE(truncated.load(logPath) && !truncated.isComplete());
+    ASSERT_TRUE(truncated.getRecords().size() < log.getRecords().size());
+
+    // Overflow drops whole calls and counts them
+    EventLog small(4);
+    ASSERT_TRUE(small.open(logPath));
+    EventRecord begin = {};
+    begin.kind = EventKind::Begin;
+    begin.value = 48000.0f;
+    float args[EventLog::MAX_ARGS] = {};
+    ASSERT_TRUE(small.write(&begin, 1) && small.call(0, EventCall::Unison, args, 3));
+    ASSERT_TRUE(!small.call(0, EventCall::NoteOn, args, 2));
+    ASSERT_TRUE(small.getDroppedRecords() == 2);
+    small.close();
+    ASSERT_TRUE(log.load(logPath) && log.getRecords().size() == 4 && log.getDroppedRecords() == 2);
+    ASSERT_NEAR(log.getSampleRate(), 48000.0, 1e-9);
+
+    // A MIDI thread flooding the engine with controllers while the audio thread renders loses no blocks
+    {
+        EventLog shared(1 << 20);
+        ASSERT_TRUE(shared.open(logPath));
+        SynthEngine synth;
+        synth.setEventLog(&shared);
+        synth.setSampleRate(44100.0);
+        synth.noteOn(48, 100);
+        const int blocks = 20000;
+        std::atomic<bool> started{false}, done{false};
+        std::thread midi([&] {
+            started = true;
+            // Fewer records than the ring holds, so none are dropped even if nothing is drained
+            for (int i = 0; i < 500000 && !done.load(); ++i) {
+                if (i & 1) synth.handleMidiEvent({ 0, 0xB0, 1, (uint8_t)(i & 127) });
+                else synth.handleMidiEvent({ 0, 0xE0, 0, (uint8_t)(i & 127) });
+            }
+        });
+        while (!started.load()) std::this_thread::yield();
+        DspBuffer buffer(2, 64);
+        for (int b = 0; b < blocks; ++b) synth.render(buffer);
+        done = true;
+        midi.join();
+        synth.setEventLog(nullptr);
+        shared.close();
+    }
+    ASSERT_TRUE(log.load(logPath) && log.isComplete() && log.getDroppedRecords() == 0);
+    int renders = 0;
+    for (const auto& r : log.getRecords()) renders += r.kind == EventKind::Render ? 1 : 0;
+    ASSERT_TRUE(renders == 20000);
+    std::remove(logPath);
+    std::remove("/tmp/rx_replay.wav");
+}
+
+static void publishTap(const float* const* channels, int frames, void* user) {
+    ((SharedTap*)user)->write(channels, frames);
+}
+
+void testSharedTap() {
+    const char* name = "/rx-engine-test-tap";
+    SharedTap tap;
+    ASSERT_TRUE(tap.open(name, 2, 48000.0, 1000, 10)); // Rounded up to 1024 frames, 16 blocks
+    SharedTapReader reader;
+    ASSERT_TRUE(reader.open(name) && reader.isLive());
+    ASSERT_TRUE(reader.getChannels() == 2 && reader.getCapacity() == 1024);
+    ASSERT_NEAR(reader.getSampleRate(), 48000.0, 1e-9);
+
+    // Published from an rx tap, as the app does
+    rx_engine* engine = rx_create(48000.0);
+    rx_set_tap(engine, publishTap, &tap);
+    std::vector<float> left(5000), right(5000), session;
+    float* outs[2] = { left.data(), right.data() };
+    auto process = [&](int frames, uint64_t block) {
+        rx_event note = { 0, 0x90, (uint8_t)(50 + block), 100 };
+        rx_process(engine, outs, frames, &note, 1);
+        tap.endBlock(0.25f, block);
+        session.insert(session.end(), left.begin(), left.begin() + frames);
+    };
+    for (int b = 0; b < 3; ++b) process(300, b);
+
+    std::vector<float> gotLeft(1024), gotRight(1024);
+    float* got[2] = { gotLeft.data(), gotRight.data() };
+    uint64_t cursor = 0;
+    ASSERT_TRUE(reader.read(cursor, got, 1024) == 900 && cursor == 900);
+    ASSERT_TRUE(std::equal(session.begin(), session.end(), gotLeft.begin()));
+    ASSERT_TRUE(reader.read(cursor, got, 1024) == 0);
+
+    // Zero-copy view of the same frames
+    const float* ring = reader.channel(0);
+    ASSERT_TRUE(reader.firstValid() == 0 && ring[899] == session[899]);
+
+    // A reader that falls a lap behind skips to the oldest frame still there
+    process(5000, 3);
+    ASSERT_TRUE(reader.read(cursor, got, 1024) == 1024 && cursor == 5900);
+    ASSERT_TRUE(reader.getLostFrames() == 5900 - 900 - 1024);
+    ASSERT_TRUE(std::equal(session.end() - 1024, session.end(), gotLeft.begin()));
+
+    // Per-block stats
+    SharedTapBlock blocks[16];
+    uint64_t blockCursor = 0;
+    ASSERT_TRUE(reader.readBlocks(blockCursor, blocks, 16) == 4 && reader.getBlockCount() == 4);
+    ASSERT_TRUE(blocks[1].frame == 300 && blocks[1].frames == 300 && blocks[1].lateCallbacks == 1);
+    ASSERT_NEAR(blocks[3].load, 0.25f, 1e-6f);
+    float peak = 0.0f;
+    for (int i = 900; i < 5900; ++i) peak = std::max(peak, std::abs(session[i]));
+    ASSERT_TRUE(peak > 0.0f && blocks[3].peak[0] == peak && blocks[3].rms[0] > 0.0f && blocks[3].rms[0] < peak);
+
+    // Another process sees the same frames
+    double sum = 0.0;
+    for (int i = 5900 - 1024; i < 5900; ++i) sum += session[i];
+    pid_t child = fork();
+    if (child == 0) {
+        SharedTapReader other;
+        uint64_t from = 5900 - 1024;
+        std::vector<float> l(1024), r(1024);
+        float* o[2] = { l.data(), r.data() };
+        double otherSum = 0.0;
+        bool ok = other.open(name) && other.read(from, o, 1024) == 1024;
+        for (float v : l) otherSum += v;
+        _exit(ok && otherSum == sum ? 0 : 1);
+    }
+    int status = -1;
+    ASSERT_TRUE(child > 0 && waitpid(child, &status, 0) == child);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    rx_destroy(engine);
+    tap.close();
+    ASSERT_TRUE(!reader.isLive());
+    SharedTapReader late;
+    ASSERT_TRUE(!late.open(name));
+}
+
+static float sampleValue(size_t frame) {
+    return (frame % 1000) / 1000.0f - 0.5f;
+}
+
+static std::string writeSampleMap() {
+    std::vector<float> left(96000), right(96000);
+    for (size_t i = 0; i < left.size(); ++i) {
+        left[i] = sampleValue(i);
+        right[i] = -left[i];
+    }
+    WavWriter writer;
+    writer.open("/tmp/rx_test_sample.wav", 2, 48000);
+    float* channels[2] = { left.data(), right.data() };
+    writer.write(channels, (int)left.size());
+    writer.close();
+
+    std::ofstream map("/tmp/rx_test_samples.map");
+    map << "# test instrument\npreload=50\nsample=rx_test_sample.wav,60\n";
+    return "/tmp/rx_test_samples.map";
+}
+
+void testSamplerStreaming() {
+    std::string mapPath = writeSampleMap();
+    auto library = SampleLibrary::load(mapPath);
+    ASSERT_TRUE(library && library == SampleLibrary::load(mapPath));
+    ASSERT_TRUE(library->getNumSamples() == 1 && library->find(64, 100));
+    const Sample& sample = library->getSample(0);
+    ASSERT_TRUE(sample.getPreloadFrames() == 2400); // 50 ms at 48 kHz
+    ASSERT_TRUE(library->getResidentBytes() == 2400 * 2 * sizeof(float));
+
+    // Offline: every frame comes back exactly, across the resident head into the stream
+    SampleStreamer streamer(library, 2);
+    streamer.setWaitForData(true);
+    SamplerNode node;
+    node.prepare(48000.0, 512);
+    node.setStreamer(&streamer, 0);
+    node.noteOn(60, 100);
+    DspBuffer buffer(2, 512);
+    size_t frame = 0;
+    bool exact = true;
+    while (node.isPlaying()) {
+        node.process(buffer);
+        for (int i = 0; i < 512 && frame + 1 < sample.getNumFrames(); ++i, ++frame) {
+            exact &= buffer.getChannel(0)[i] == sampleValue(frame) && buffer.getChannel(1)[i] == -sampleValue(frame);
+        }
+    }
+    ASSERT_TRUE(exact && frame + 1 == sample.getNumFrames());
+    ASSERT_TRUE(streamer.getPrefetchMisses() == 0);
+
+    // An octave up reads every other frame
+    node.noteOn(72, 100);
+    for (int b = 0; b < 40; ++b) {
+        node.process(buffer);
+        for (int i = 0; i < 512; ++i) ASSERT_NEAR(buffer.getChannel(0)[i], sampleValue(2 * (b * 512 + i)), 1e-6f);
+    }
+
+    // Live: never waits. Every frame is either exact or a counted gap
+    SampleStreamer live(library, 1);
+    SamplerNode liveNode;
+    liveNode.prepare(48000.0, 512);
+    liveNode.setStreamer(&live, 0);
+    liveNode.noteOn(60, 100);
+    frame = 0;
+    uint64_t gaps = 0;
+    bool consistent = true;
+    while (liveNode.isPlaying()) {
+        liveNode.process(buffer);
+        for (int i = 0; i < 512 && frame + 1 < sample.getNumFrames(); ++i, ++frame) {
+            float v = buffer.getChannel(0)[i];
+            if (v != sampleValue(frame)) {
+                consistent &= v == 0.0f && frame + 1 >= sample.getPreloadFrames(); // Interpolation needs the next frame too
+                gaps++;
+            }
+        }
+    }
+    ASSERT_TRUE(consistent);
+    ASSERT_TRUE(gaps <= live.getMissedFrames());
+
+    // Retriggered while the previous stream still fills the ring: the new stream must
+    // get the ring back, offline (which would otherwise wait forever) and live
+    for (bool offline : { true, false }) {
+        SampleStreamer retrigger(library, 1);
+        retrigger.setWaitForData(true); // So the first note is being streamed and released
+        SamplerNode voice;
+        voice.prepare(48000.0, 512);
+        voice.setStreamer(&retrigger, 0);
+        voice.noteOn(60, 100);
+        for (int b = 0; b < 10; ++b) voice.process(buffer);
+        // Released up to frame 5120 of the stream that started at 2400; wait for a full ring
+        const SampleStreamer::Slot* slot = retrigger.getSlot(0);
+        while (slot->getWriteIndex() < 5120 - 2400 + SampleStreamer::RING_FRAMES) std::this_thread::yield();
+
+        retrigger.setWaitForData(offline);
+        voice.noteOn(60, 100);
+        uint64_t missed = retrigger.getMissedFrames();
+        bool exact = true;
+        for (int b = 0; b < 40; ++b) {
+            if (!offline) std::this_thread::sleep_for(std::chrono::milliseconds(2)); // Real time
+            voice.process(buffer);
+            for (int i = 0; i < 512; ++i) exact &= buffer.getChannel(0)[i] == sampleValue(b * 512 + i);
+        }
+        ASSERT_TRUE(exact);
+        ASSERT_TRUE(retrigger.getMissedFrames() == missed);
+    }
+}
+
+void testSampledRenderIsDeterministic() {
+    std::string mapPath = writeSampleMap();
+    std::vector<uint8_t> smf = makeTestSong();
+    MidiFile midi;
+    ASSERT_TRUE(midi.loadFromMemory(smf.data(), smf.size()));
+
+    std::vector<char> renders[2];
+    for (auto& wav : renders) {
+        OfflineRenderer renderer(48000.0);
+        renderer.setSamples(mapPath);
+        WavWriter writer;
+        ASSERT_TRUE(writer.open("/tmp/rx_sampled.wav", 2, 48000));
+        ASSERT_TRUE(renderer.render(midi, writer).ok);
+        wav = readFile("/tmp/rx_sampled.wav");
+    }
+    ASSERT_TRUE(renders[0] == renders[1]);
+    const float* samples = (const float*)(renders[0].data() + 44);
+    float peak = 0.0f;
+    for (size_t i = 0; i < (renders[0].size() - 44) / sizeof(float); ++i) peak = std::max(peak, std::abs(samples[i]));
+    ASSERT_TRUE(peak > 0.01f);
+
+    OfflineRenderer broken(48000.0);
+    broken.setSamples("/tmp/does_not_exist.map");
+    WavWriter writer;
+    ASSERT_TRUE(writer.open("/tmp/rx_sampled.wav", 2, 48000));
+    ASSERT_TRUE(!broken.render(midi, writer).ok);
+
+    std::remove("/tmp/rx_sampled.wav");
+    std::remove("/tmp/rx_test_sample.wav");
+    std::remove(mapPath.c_str());
+}
+
+// Pushes `frames` frames of a known ramp in `block`-sized pieces, as an audio callback would
+static void pushRamp(Recorder& recorder, int frames, int block) {
+    std::vector<float> left(block), right(block);
+    for (int pos = 0; pos < frames; pos += block) {
+        int n = std::min(block, frames - pos);
+        for (int i = 0; i < n; ++i) {
+            left[i] = (pos + i) * 1e-5f;
+            right[i] = -left[i];
+        }
+        const float* channels[2] = { left.data(), right.data() };
+        recorder.push(channels, n);
+    }
+}
+
+void testRecorder() {
+    // Everything pushed comes back, in order, from a valid WAV
+    Recorder recorder(2, 1 << 16);
+    pushRamp(recorder, 1000, 100); // Not recording yet: ignored
+    ASSERT_TRUE(recorder.start("/tmp/rx_rec.wav", 48000));
+    pushRamp(recorder, 51200, 256);
+    recorder.stop();
+    ASSERT_TRUE(recorder.getError().empty() && recorder.getOverflows() == 0);
+    ASSERT_TRUE(recorder.getFramesWritten() == 51200 && recorder.getFilesWritten() == 1);
+    WavReader wav;
+    ASSERT_TRUE(wav.load("/tmp/rx_rec.wav"));
+    ASSERT_TRUE(wav.getNumFrames() == 51200 && wav.getSampleRate() == 48000);
+    bool exact = true;
+    for (int i = 0; i < 51200; ++i) exact &= wav.getChannel(0)[i] == i * 1e-5f && wav.getChannel(1)[i] == -i * 1e-5f;
+    ASSERT_TRUE(exact);
+    std::remove("/tmp/rx_rec.wav");
+
+    // Rotation splits on whole chunks; the files join back into the stream
+    ASSERT_TRUE(recorder.start("/tmp/rx_rot.wav", Recorder::CHUNK_FRAMES, RecordFormat::Wav, 1.0));
+    pushRamp(recorder, 40000, 512);
+    recorder.stop();
+    ASSERT_TRUE(recorder.getFilesWritten() == 3);
+    int joined = 0;
+    for (const char* name : { "/tmp/rx_rot-0001.wav", "/tmp/rx_rot-0002.wav", "/tmp/rx_rot-0003.wav" }) {
+        ASSERT_TRUE(wav.load(name));
+        for (int i = 0; i < wav.getNumFrames(); ++i, ++joined) exact &= wav.getChannel(0)[i] == joined * 1e-5f;
+        std::remove(name);
+    }
+    ASSERT_TRUE(exact && joined == 40000);
+
+    // Raw float is headerless and interleaved
+    ASSERT_TRUE(recorder.start("/tmp/rx_rec.raw", 48000, RecordFormat::RawFloat));
+    pushRamp(recorder, 3000, 128);
+    recorder.stop();
+    std::vector<char> raw = readFile("/tmp/rx_rec.raw");
+    ASSERT_TRUE(raw.size() == 3000 * 2 * sizeof(float));
+    ASSERT_TRUE(((const float*)raw.data())[2 * 1234 + 1] == -1234 * 1e-5f);
+    std::remove("/tmp/rx_rec.raw");
+
+    // A ring too small for the burst drops whole blocks and accounts for every frame
+    Recorder small(2, 1024);
+    ASSERT_TRUE(small.start("/tmp/rx_small.wav", 48000));
+    pushRamp(small, 64 * 512, 512);
+    small.stop();
+    ASSERT_TRUE(small.getFramesWritten() + small.getDroppedFrames() == 64 * 512);
+    ASSERT_TRUE(small.getDroppedFrames() == small.getOverflows() * 512);
+    std::remove("/tmp/rx_small.wav");
+
+    ASSERT_TRUE(!recorder.start("/nonexistent/dir/take.wav", 48000) && !recorder.getError().empty());
+}
+
+void testConvolutionMatchesDirect() {
+    // Stereo IR long enough to use the head and several tail partitions
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    const int irLength = ImpulseResponse::TAIL_OFFSET + 2 * ImpulseResponse::TAIL_SIZE + 333;
+    std::vector<std::vector<float>> irSamples(2, std::vector<float>(irLength));
+    for (int c = 0; c < 2; ++c) {
+        for (int i = 0; i < irLength; ++i) irSamples[c][i] = noise(rng) * std::exp(-i / 3000.0f);
+    }
+    auto ir = ImpulseResponse::fromSamples(irSamples);
+
+    const int length = 16000;
+    std::vector<float> input[2];
+    for (auto& in : input) {
+        in.resize(length);
+        for (auto& v : in) v = noise(rng) * 0.5f;
+    }
+
+    // Arbitrary block sizes, as OfflineRenderer produces when it splits at events
+    auto run = [&](ConvolutionReverb& reverb) {
+        std::vector<float> out[2] = { std::vector<float>(length), std::vector<float>(length) };
+        std::mt19937 sizes(3);
+        DspBuffer buffer(2, 1);
+        for (int pos = 0; pos < length;) {
+            int n = std::min(1 + (int)(sizes() % 700), length - pos);
+            buffer.resize(2, n);
+            for (int c = 0; c < 2; ++c) std::copy(input[c].begin() + pos, input[c].begin() + pos + n, buffer.getChannel(c));
+            reverb.process(buffer);
+            for (int c = 0; c < 2; ++c) std::copy(buffer.getChannel(c), buffer.getChannel(c) + n, out[c].begin() + pos);
+            pos += n;
+        }
+        return std::vector<std::vector<float>>{ out[0], out[1] };
+    };
+
+    ConvolutionReverb reverb;
+    reverb.setImpulseResponse(ir);
+    reverb.setMix(0.0f, 1.0f);
+    reverb.setWaitForTail(true);
+    auto wet = run(reverb);
+
+    // Direct-form reference, delayed by the head latency
+    int latency = reverb.getLatency();
+    float worst = 0.0f;
+    for (int c = 0; c < 2; ++c) {
+        for (int n = 0; n < length; ++n) {
+            double expected = 0.0;
+            int t = n - latency;
+            for (int k = 0; k <= t && k < irLength; ++k) expected += (double)input[c][t - k] * irSamples[c][k];
+            worst = std::max(worst, (float)std::abs(expected - wet[c][n]));
+        }
+    }
+    ASSERT_TRUE(worst < 1e-3f); // Signal peaks are around 10 here
+    ASSERT_TRUE(reverb.getMissedDeadlines() == 0);
+
+    // Reset brings back the exact same output
+    reverb.reset();
+    ASSERT_TRUE(run(reverb) == wet);
+
+    // Live, a block far longer than the ring submits more chunks than the worker can
+    // take; the callback drops them rather than waiting, and a reset recovers exactly
+    ConvolutionReverb live;
+    live.setImpulseResponse(ir);
+    live.setMix(0.0f, 1.0f);
+    DspBuffer big(2, 20 * ImpulseResponse::TAIL_SIZE);
+    for (int c = 0; c < 2; ++c) std::fill(big.getChannel(c), big.getChannel(c) + big.getNumFrames(), 0.5f);
+    live.process(big);
+    for (int c = 0; c < 2; ++c) {
+        for (int i = 0; i < big.getNumFrames(); ++i) ASSERT_TRUE(std::isfinite(big.getChannel(c)[i]));
+    }
+    live.reset();
+    live.setWaitForTail(true);
+    ASSERT_TRUE(run(live) == wet);
+}
+
+void testImpulseResponseLoadAndCache() {
+    const char* path = "/tmp/rx_test_ir.wav";
+    std::vector<float> left(6000), right(6000);
+    for (int i = 0; i < 6000; ++i) {
+        left[i] = std::exp(-i / 500.0f) * ((i % 7) - 3) / 3.0f;
+        right[i] = -left[i];
+    }
+    WavWriter writer;
+    ASSERT_TRUE(writer.open(path, 2, 48000, WavFormat::Pcm16));
+    float* channels[2] = { left.data(), right.data() };
+    writer.write(channels, 6000);
+    writer.close();
+
+    WavReader wav;
+    ASSERT_TRUE(wav.load(path));
+    ASSERT_TRUE(wav.getNumChannels() == 2 && wav.getNumFrames() == 6000 && wav.getSampleRate() == 48000);
+    ASSERT_NEAR(wav.getChannel(0)[7], left[7], 1e-4f);
+    ASSERT_NEAR(wav.getChannel(1)[7], right[7], 1e-4f);
+
+    auto a = ImpulseResponse::load(path, 48000.0);
+    auto b = ImpulseResponse::load(path, 48000.0);
+    auto c = ImpulseResponse::load(path, 24000.0);
+    ASSERT_TRUE(a && a == b); // Cached spectral form is shared
+    ASSERT_TRUE(c && c != a && c->getLength() == 3000);
+    std::remove(path);
+
+    ASSERT_TRUE(!ImpulseResponse::load("/tmp/does_not_exist.wav", 44100.0));
+
+    // A header claiming 0 Hz is rejected rather than divided by
+    ASSERT_TRUE(writer.open(path, 2, 0, WavFormat::Pcm16));
+    writer.write(channels, 6000);
+    writer.close();
+    ASSERT_TRUE(!ImpulseResponse::load(path, 44100.0));
+    std::remove(path);
+}
+
+// Largest error of f against a double-precision reference over [lo, hi]
+template <typename F, typename R>
+static double maxError(F f, R reference, double lo, double hi, bool relative) {
+    double worst = 0.0;
+    const int steps = 200000;
+    for (int i = 0; i <= steps; ++i) {
+        float x = (float)(lo + (hi - lo) * i / steps);
+        double expected = reference((double)x);
+        double error = std::abs((double)f(x) - expected);
+        if (relative) error /= std::max(std::abs(expected), 1e-30);
+        worst = std::max(worst, error);
+    }
+    return worst;
+}
+
+void testFastMathErrorBounds() {
+    // Bounds documented in FastMath.hpp
+    ASSERT_TRUE(maxError([](float x) { return FastMath::sin2pi(x); }, [](double x) { return std::sin(2.0 * M_PI * x); }, -1000.0, 1000.0, false) < 2e-7);
+    ASSERT_TRUE(maxError([](float x) { return FastMath::cos2pi(x); }, [](double x) { return std::cos(2.0 * M_PI * x); }, -2.0, 2.0, false) < 2e-7);
+    ASSERT_TRUE(maxError([](float x) { return FastMath::sin(x); }, [](double x) { return std::sin(x); }, -10.0, 10.0, false) < 1e-6);
+    ASSERT_TRUE(maxError([](float x) { return FastMath::tan(x); }, [](double x) { return std::tan(x); }, -1.5, 1.5, true) < 3e-6);
+    ASSERT_TRUE(maxError([](float x) { return FastMath::exp2(x); }, [](double x) { return std::exp2(x); }, -126.0, 127.0, true) < 3e-7);
+    ASSERT_TRUE(maxError([](float x) { return FastMath::log2(x); }, [](double x) { return std::log2(x); }, 0.01, 100.0, false) < 4e-7);
+    ASSERT_TRUE(maxError([](float x) { return FastMath::tanh(x); }, [](double x) { return std::tanh(x); }, -20.0, 20.0, false) < 2e-7);
+    ASSERT_TRUE(maxError([](float x) { return FastMath::mtof(x); }, [](double x) { return 440.0 * std::pow(2.0, (x - 69.0) / 12.0); }, 0.0, 127.0, true) < 7e-7);
+
+    // Saturation limits and exact points
+    ASSERT_NEAR(FastMath::tanh(1000.0f), 1.0f, 1e-7f);
+    ASSERT_NEAR(FastMath::tanh(-1000.0f), -1.0f, 1e-7f);
+    ASSERT_NEAR(FastMath::exp2(10.0f), 1024.0f, 1e-4f);
+    ASSERT_NEAR(FastMath::mtof(69.0f), 440.0f, 1e-4f);
+
+    // Batch versions match the scalar kernels lane for lane, including the tail
+    std::vector<float> in(103), out(103);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = -3.0f + 0.07f * i;
+    FastMath::sin2pi(in.data(), out.data(), (int)in.size());
+    for (size_t i = 0; i < in.size(); ++i) ASSERT_TRUE(out[i] == FastMath::sin2pi(in[i]));
+    FastMath::tanh(in.data(), out.data(), (int)in.size());
+    for (size_t i = 0; i < in.size(); ++i) ASSERT_TRUE(out[i] == FastMath::tanh(in[i]));
+    FastMath::exp2(in.data(), in.data(), (int)in.size()); // In place
+    for (size_t i = 0; i < in.size(); ++i) ASSERT_NEAR(in[i], std::exp2(-3.0f + 0.07f * i), 1e-5f);
+}
+
+int main() {
+    TestRunner runner;
+
+    runner.run("MIDI File Tempo Map + Running Status", testMidiFileTempoMapAndRunningStatus);
+    runner.run("MIDI File Rejects Garbage", testMidiFileRejectsGarbage);
+    runner.run("MIDI Parser Stream Features", testMidiParserStreamFeatures);
+    runner.run("MIDI Parser Fuzz", testMidiParserFuzz);
+    runner.run("Offline Render Writes Audio", testOfflineRenderWritesAudio);
+    runner.run("Batch Render Is Deterministic", testBatchRenderIsDeterministic);
+    runner.run("Segmented Render Matches Serial", testSegmentedRenderMatchesSerial);
+    runner.run("Worker Pool Runs Every Task", testWorkerPoolRunsEveryTask);
+    runner.run("Multitimbral Routing + Determinism", testMultiTimbralRoutingAndDeterminism);
+    runner.run("Unison Stack", testUnisonStack);
+    runner.run("Unison Voice Through Engine", testUnisonVoiceThroughEngine);
+    runner.run("Kernel Specialization", testKernelSpecialization);
+    runner.run("CPU Dispatch", testCpuDispatch);
+    runner.run("FM Voices", testFmVoices);
+    runner.run("FastMath Error Bounds", testFastMathErrorBounds);
+    runner.run("Mod Matrix Sources", testModMatrixSources);
+    runner.run("Modulated Voice", testModulatedVoice);
+    runner.run("Factory Presets Stay Bounded", testFactoryPresetsStayBounded);
+    runner.run("Note After Silence Matches Fresh", testNoteAfterSilenceMatchesFresh);
+    runner.run("Preset Modulation Round Trip", testPresetModulationRoundTrip);
+    runner.run("Pitch Bend, Glide + Vibrato", testPitchModulation);
+    runner.run("Preset Pitch Round Trip", testPresetPitchRoundTrip);
+    runner.run("Automation Lanes", testAutomationLanes);
+    runner.run("Automated Render", testAutomatedRender);
+    runner.run("Modulated Delay", testModulatedDelay);
+    runner.run("Send Buses", testSendBuses);
+    runner.run("Stage Profiler", testStageProfiler);
+    runner.run("Trace Export", testTraceExport);
+    runner.run("Realtime Arena", testRealtimeArena);
+    runner.run("C API Zero-Copy", testCApiZeroCopy);
+    runner.run("Event Log Replay", testEventLogReplay);
+    runner.run("Shared Tap", testSharedTap);
+    runner.run("Sampler Streaming", testSamplerStreaming);
+    runner.run("Sampled Render Is Deterministic", testSampledRenderIsDeterministic);
+    runner.run("Recorder", testRecorder);
+    runner.run("Convolution Matches Direct Form", testConvolutionMatchesDirect);
+    runner.run("Impulse Response Load + Cache", testImpulseResponseLoadAndCache);
+
+    runner.report();
+    return runner.getExitCode();
+}
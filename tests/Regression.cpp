@@ -0,0 +1,285 @@
+// Golden-audio and performance regression suite. Run with `make regress`.
+//
+// Renders fixed scenes through SynthEngine and compares them with the reference audio in
+// tests/golden. A scene passes if every sample is within --max-ulp ULPs of the reference,
+// or if the error is at least --min-snr dB below the signal (room for another compiler's
+// rounding). Each scene is also timed in ns per sample and fails when it runs more than
+// --slowdown times slower than the baseline in tests/golden/perf.txt.
+//
+//   --update        rewrite the reference audio (after an intended change in sound)
+//   --update-perf   record this machine's timings as the baseline
+//   --no-perf       audio only, e.g. under `make test` or on a loaded machine
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/PresetManager.hpp"
+#include "../src/SynthEngine.hpp"
+#include "../src/WavFile.hpp"
+
+static const int SAMPLE_RATE = 44100;
+static const int BLOCK = 256;
+
+struct Scene {
+    const char* name;
+    double seconds;
+    void (*setup)(SynthEngine& synth);
+    void (*events)(SynthEngine& synth, int block, double time); // Before rendering `block`
+};
+
+static int blockAt(double seconds) { return (int)(seconds * SAMPLE_RATE / BLOCK); }
+
+// Scenes
+
+static void setupDefault(SynthEngine& synth) {
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(0), synth);
+}
+
+// A held seventh chord and its release
+static void chordEvents(SynthEngine& synth, int block, double) {
+    static const int notes[] = { 48, 52, 55, 59, 62 };
+    for (int n : notes) {
+        if (block == 0) synth.noteOn(n, 100);
+        if (block == blockAt(0.45)) synth.noteOff(n);
+    }
+}
+
+// More notes than voices, so voices are stolen mid-note. The seed is fixed and only raw
+// mt19937 output is used: identical on every standard library
+static std::mt19937 stormRng;
+
+static void setupStorm(SynthEngine& synth) {
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(3), synth); // Super Saw
+    stormRng.seed(1234);
+}
+
+static void stormEvents(SynthEngine& synth, int, double) {
+    for (int i = 0; i < 3; ++i) {
+        uint32_t r = stormRng();
+        int note = 36 + (int)(r % 48);
+        if (r & (1u << 20)) synth.noteOn(note, 40 + (int)((r >> 8) % 87));
+        else synth.noteOff(note);
+    }
+}
+
+static void setupSweep(SynthEngine& synth) {
+    Preset preset = PresetManager::getFactoryPreset(2); // Square Bass
+    preset.resonance = 0.85f;
+    preset.sustain = 1.0f;
+    PresetManager::applyPreset(preset, synth);
+}
+
+// Resonant cutoff sweep from 100 Hz to 10 kHz and back, one step per block
+static void sweepEvents(SynthEngine& synth, int block, double time) {
+    if (block == 0) {
+        synth.noteOn(36, 110);
+        synth.noteOn(43, 90);
+    }
+    double position = time < 0.375 ? time / 0.375 : (0.75 - time) / 0.375;
+    synth.setFilterCutoff((float)(100.0 * std::pow(100.0, position)));
+}
+
+// Every factory preset in turn while a phrase keeps playing: mod routes, sends and
+// pitch settings switching under sounding voices
+static void presetEvents(SynthEngine& synth, int block, double) {
+    int perPreset = blockAt(0.2);
+    if (block % perPreset == 0) {
+        int index = block / perPreset;
+        if (index < PresetManager::getFactoryPresetCount()) {
+            PresetManager::applyPreset(PresetManager::getFactoryPreset(index), synth);
+        }
+        synth.noteOn(48 + index * 2, 100);
+        synth.noteOn(55 + index * 2, 80);
+    }
+    if (block % perPreset == perPreset / 2) synth.allNotesOff();
+}
+
+static void setupExpression(SynthEngine& synth) {
+    PresetManager::applyPreset(PresetManager::getFactoryPreset(6), synth); // Glide Lead
+}
+
+// A legato line with glides, bend and mod wheel moves
+static void expressionEvents(SynthEngine& synth, int block, double time) {
+    static const int line[] = { 60, 67, 64, 72, 55 };
+    int step = blockAt(0.2);
+    if (block % step == 0 && block / step < 5) {
+        if (block > 0) synth.noteOff(line[block / step - 1]);
+        synth.noteOn(line[block / step], 100);
+    }
+    int bend = 8192 + (int)(4000.0 * std::sin(time * 7.0));
+    synth.handleMidiEvent({ 0, 0xE0, (uint8_t)(bend & 0x7F), (uint8_t)(bend >> 7) });
+    synth.setModWheel((float)time);
+}
+
+static const Scene scenes[] = {
+    { "chord", 0.75, setupDefault, chordEvents },
+    { "note-storm", 1.0, setupStorm, stormEvents },
+    { "filter-sweep", 0.75, setupSweep, sweepEvents },
+    { "preset-changes", 1.8, nullptr, presetEvents },
+    { "expression", 1.0, setupExpression, expressionEvents },
+};
+
+// Rendering and comparison
+
+static std::vector<std::vector<float>> render(const Scene& scene) {
+    SynthEngine synth;
+    synth.setSampleRate(SAMPLE_RATE);
+    if (scene.setup) scene.setup(synth);
+    int blocks = (int)(scene.seconds * SAMPLE_RATE / BLOCK);
+    std::vector<std::vector<float>> out(2, std::vector<float>((size_t)blocks * BLOCK));
+    DspBuffer buffer(2, BLOCK);
+    for (int b = 0; b < blocks; ++b) {
+        scene.events(synth, b, (double)b * BLOCK / SAMPLE_RATE);
+        synth.render(buffer);
+        for (int c = 0; c < 2; ++c) std::copy(buffer.getChannel(c), buffer.getChannel(c) + BLOCK, out[c].begin() + (size_t)b * BLOCK);
+    }
+    return out;
+}
+
+// Distance in representable floats; 0 for identical samples
+static uint64_t ulpDistance(float a, float b) {
+    int32_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    // Map sign-magnitude onto a monotonic integer line
+    int64_t la = ia < 0 ? (int64_t)INT32_MIN - ia : ia;
+    int64_t lb = ib < 0 ? (int64_t)INT32_MIN - ib : ib;
+    return (uint64_t)std::llabs(la - lb);
+}
+
+struct Comparison {
+    bool sameLength = false;
+    double snrDb = 0.0; // Infinite when identical
+    uint64_t maxUlp = 0;
+    double maxError = 0.0;
+};
+
+static Comparison compare(const std::vector<std::vector<float>>& audio, const WavReader& reference) {
+    Comparison result;
+    if (reference.getNumChannels() != 2 || (size_t)reference.getNumFrames() != audio[0].size()) return result;
+    result.sameLength = true;
+    double signal = 0.0, noise = 0.0;
+    for (int c = 0; c < 2; ++c) {
+        const std::vector<float>& expected = reference.getChannel(c);
+        for (size_t i = 0; i < expected.size(); ++i) {
+            double error = (double)audio[c][i] - expected[i];
+            signal += (double)expected[i] * expected[i];
+            noise += error * error;
+            result.maxError = std::max(result.maxError, std::abs(error));
+            result.maxUlp = std::max(result.maxUlp, ulpDistance(audio[c][i], expected[i]));
+        }
+    }
+    result.snrDb = noise == 0.0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(signal / noise);
+    return result;
+}
+
+// Best of `repeats`, so a preempted run does not count as a slowdown
+static double nsPerSample(const Scene& scene, int repeats) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        render(scene);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, seconds * 1e9 / (scene.seconds * SAMPLE_RATE));
+    }
+    return best;
+}
+
+static std::map<std::string, double> loadBaseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        char name[64];
+        double ns;
+        if (line.empty() || line[0] == '#') continue;
+        if (std::sscanf(line.c_str(), "%63s %lf", name, &ns) == 2) baseline[name] = ns;
+    }
+    return baseline;
+}
+
+int main(int argc, char** argv) {
+    std::string golden = "tests/golden";
+    bool update = false, updatePerf = false, perf = true;
+    double slowdown = 1.5, minSnr = 90.0;
+    uint64_t maxUlp = 16;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--update") update = true;
+        else if (arg == "--update-perf") updatePerf = true;
+        else if (arg == "--no-perf") perf = false;
+        else if (arg == "--slowdown" && i + 1 < argc) slowdown = std::atof(argv[++i]);
+        else if (arg == "--min-snr" && i + 1 < argc) minSnr = std::atof(argv[++i]);
+        else if (arg == "--max-ulp" && i + 1 < argc) maxUlp = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--golden" && i + 1 < argc) golden = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--update] [--update-perf] [--no-perf] [--slowdown x] [--min-snr dB] "
+                                 "[--max-ulp n] [--golden dir]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::string perfPath = golden + "/perf.txt";
+    std::map<std::string, double> baseline = loadBaseline(perfPath);
+    std::map<std::string, double> measured;
+    int failed = 0;
+    for (const Scene& scene : scenes) {
+        std::string path = golden + "/" + scene.name + ".wav";
+        std::printf("[RUN] %-15s ", scene.name);
+        std::vector<std::vector<float>> audio = render(scene);
+        bool ok = true;
+
+        if (update) {
+            WavWriter writer;
+            float* channels[2] = { audio[0].data(), audio[1].data() };
+            ok = writer.open(path, 2, SAMPLE_RATE);
+            if (ok) writer.write(channels, (int)audio[0].size());
+            std::printf("%s", ok ? "reference written" : "cannot write reference");
+        } else {
+            WavReader reference;
+            if (!reference.load(path)) {
+                std::printf("no reference (%s)", reference.getError().c_str());
+                ok = false;
+            } else {
+                Comparison c = compare(audio, reference);
+                ok = c.sameLength && (c.maxUlp <= maxUlp || c.snrDb >= minSnr);
+                if (!c.sameLength) std::printf("length or channels differ");
+                else std::printf("snr %6.1f dB, max %llu ulp, max error %.2e", c.snrDb, (unsigned long long)c.maxUlp, c.maxError);
+            }
+        }
+
+        if (perf || updatePerf) {
+            double ns = nsPerSample(scene, 5);
+            measured[scene.name] = ns;
+            std::printf(", %7.1f ns/sample", ns);
+            auto it = baseline.find(scene.name);
+            if (!updatePerf && it != baseline.end()) {
+                double ratio = ns / it->second;
+                std::printf(" (%.2fx baseline)", ratio);
+                if (ratio > slowdown) ok = false;
+            }
+        }
+        std::printf(" %s\n", ok ? "PASS" : "FAIL");
+        failed += ok ? 0 : 1;
+    }
+
+    if (updatePerf) {
+        std::ofstream file(perfPath);
+        file << "# ns per sample, best of 5; regenerate with --update-perf on the machine that runs the suite\n";
+        for (const auto& entry : measured) file << entry.first << " " << entry.second << "\n";
+        std::printf("baseline written to %s\n", perfPath.c_str());
+    }
+    std::printf("\n--------------------------------------------------\n");
+    std::printf("Scenes Passed: %d\nScenes Failed: %d\n", (int)(sizeof(scenes) / sizeof(scenes[0])) - failed, failed);
+    std::printf("--------------------------------------------------\n");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+// Worst-case latency harness. Run with `make stress`.
+//
+// Replays adversarial event patterns through SynthEngine at several block sizes and
+// records how long every single block takes, events included, as an audio callback would
+// see it. Averages hide the blocks that miss their deadline, so the report is the tail:
+// p99, p99.9 and max. A pattern fails when any block takes more than --budget of its
+// deadline (block duration at 44.1 kHz).
+//
+// Blocks are timed in thread CPU time, so being preempted by the OS does not count and
+// runs are repeatable on a loaded machine; --wall times them on the wall clock instead.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/PresetManager.hpp"
+#include "../src/SynthEngine.hpp"
+
+static const double SAMPLE_RATE = 44100.0;
+
+struct Pattern {
+    const char* name;
+    int preset;
+    void (*events)(SynthEngine& synth, int block, std::mt19937& rng); // Before rendering `block`
+};
+
+// 64 note-ons in a single callback every 50 blocks, released 25 blocks later
+static void noteBurst(SynthEngine& synth, int block, std::mt19937&) {
+    if (block % 50 == 0) {
+        for (int n = 0; n < 64; ++n) synth.noteOn(36 + n, 100);
+    } else if (block % 50 == 25) {
+        for (int n = 0; n < 64; ++n) synth.noteOff(36 + n);
+    }
+}
+
+// A new note every block with all voices busy: each one steals a sounding voice
+static void voiceSteal(SynthEngine& synth, int block, std::mt19937& rng) {
+    synth.noteOn(36 + (int)(rng() % 48), 60 + (int)(rng() % 60));
+    if (block % 3 == 0) synth.noteOff(36 + (int)(rng() % 48));
+}
+
+// Every voice waking from silence at once, then released and left to go idle
+static void allWake(SynthEngine& synth, int block, std::mt19937&) {
+    int phase = block % 40;
+    if (phase == 0) {
+        for (int n = 0; n < 8; ++n) synth.noteOn(40 + n * 3, 110);
+    } else if (phase == 20) {
+        synth.allNotesOff();
+    }
+}
+
+// A UI slider pushing a new cutoff 128 times between two callbacks
+static void cutoffFlood(SynthEngine& synth, int block, std::mt19937& rng) {
+    if (block == 0) {
+        for (int n = 0; n < 8; ++n) synth.noteOn(40 + n * 3, 100);
+    }
+    for (int i = 0; i < 128; ++i) synth.setFilterCutoff(200.0f + (float)(rng() % 8000));
+}
+
+// Controller streams on modulated voices: mod wheel and pitch bend, 64 of each per block
+static void controllerFlood(SynthEngine& synth, int block, std::mt19937& rng) {
+    if (block == 0) {
+        for (int n = 0; n < 8; ++n) synth.noteOn(40 + n * 3, 100);
+    }
+    for (int i = 0; i < 64; ++i) {
+        synth.handleMidiEvent({ 0, 0xB0, 1, (uint8_t)(rng() & 0x7F) });
+        synth.handleMidiEvent({ 0, 0xE0, (uint8_t)(rng() & 0x7F), (uint8_t)(rng() & 0x7F) });
+    }
+}
+
+static const Pattern patterns[] = {
+    { "note-burst-64", 3, noteBurst },        // Super Saw: the heaviest voices
+    { "voice-steal", 3, voiceSteal },
+    { "all-wake", 3, allWake },
+    { "cutoff-flood", 0, cutoffFlood },
+    { "controller-flood", 4, controllerFlood }, // Wobble Bass: mod wheel routed to cutoff
+};
+
+static const int blockSizes[] = { 32, 64, 128, 256, 512 };
+
+static uint64_t nowNs(bool wall) {
+    if (wall) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+int main(int argc, char** argv) {
+    double budget = 0.5;  // Fraction of the deadline a block may use
+    double seconds = 4.0; // Of audio per pattern and block size
+    bool wall = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--budget" && i + 1 < argc) budget = std::atof(argv[++i]);
+        else if (arg == "--seconds" && i + 1 < argc) seconds = std::atof(argv[++i]);
+        else if (arg == "--wall") wall = true;
+        else {
+            std::fprintf(stderr, "usage: %s [--budget fraction] [--seconds s] [--wall]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("per-block render time (%s), budget %.0f%% of the deadline\n", wall ? "wall clock" : "thread CPU",
+                budget * 100.0);
+    std::printf("%-17s %6s %7s %9s %9s %9s %9s %9s %7s\n", "pattern", "block", "blocks", "mean us", "p99 us",
+                "p99.9 us", "max us", "deadline", "max");
+    int failed = 0;
+    DspBuffer buffer(2, SynthEngine::MAX_BLOCK);
+    std::vector<double> times;
+    for (const Pattern& pattern : patterns) {
+        for (int frames : blockSizes) {
+            SynthEngine synth;
+            synth.setSampleRate(SAMPLE_RATE);
+            PresetManager::applyPreset(PresetManager::getFactoryPreset(pattern.preset), synth);
+            buffer.resize(2, frames);
+            std::mt19937 rng(7);
+
+            int blocks = std::max(100, (int)(seconds * SAMPLE_RATE / frames));
+            int warmup = 10; // First touches of buffers and code are not what we measure
+            times.clear();
+            for (int b = 0; b < blocks + warmup; ++b) {
+                uint64_t start = nowNs(wall);
+                pattern.events(synth, b, rng);
+                synth.render(buffer);
+                uint64_t end = nowNs(wall);
+                if (b >= warmup) times.push_back((end - start) * 1e-3);
+            }
+
+            double mean = 0.0;
+            for (double t : times) mean += t;
+            mean /= times.size();
+            std::sort(times.begin(), times.end());
+            double deadline = frames / SAMPLE_RATE * 1e6;
+            double worst = times.back();
+            bool ok = worst <= budget * deadline;
+            std::printf("%-17s %6d %7d %9.1f %9.1f %9.1f %9.1f %9.1f %6.0f%% %s\n", pattern.name, frames, blocks, mean,
+                        percentile(times, 99.0), percentile(times, 99.9), worst, deadline, worst / deadline * 100.0,
+                        ok ? "PASS" : "FAIL");
+            failed += ok ? 0 : 1;
+        }
+    }
+    std::printf("\n%d of %d runs over budget\n", failed, (int)(sizeof(patterns) / sizeof(patterns[0]) * sizeof(blockSizes) / sizeof(blockSizes[0])));
+    return failed ? 1 : 0;
+}
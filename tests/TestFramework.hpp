@@ -0,0 +1,50 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <functional>
+
+// Simple Test Framework
+struct TestFailure {
+    std::string message;
+    std::string file;
+    int line;
+};
+
+class TestRunner {
+public:
+    void run(std::string name, std::function<void()> test) {
+        std::cout << "[RUN] " << name << "... ";
+        try {
+            test();
+            std::cout << "PASS" << std::endl;
+            passed++;
+        } catch (const TestFailure& f) {
+            std::cout << "FAIL" << std::endl;
+            std::cout << "  " << f.file << ":" << f.line << " - " << f.message << std::endl;
+            failed++;
+        } catch (...) {
+            std::cout << "FAIL (Unknown Exception)" << std::endl;
+            failed++;
+        }
+    }
+
+    void report() {
+        std::cout << "\n--------------------------------------------------" << std::endl;
+        std::cout << "Tests Passed: " << passed << std::endl;
+        std::cout << "Tests Failed: " << failed << std::endl;
+        std::cout << "--------------------------------------------------" << std::endl;
+    }
+    
+    int getExitCode() { return failed > 0 ? 1 : 0; }
+
+private:
+    int passed = 0;
+    int failed = 0;
+};
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) throw TestFailure{#condition, __FILE__, __LINE__};
+
+#define ASSERT_NEAR(a, b, epsilon) \
+    if (std::abs((a) - (b)) > (epsilon)) throw TestFailure{"Values not near: " + std::to_string(a) + " vs " + std::to_string(b), __FILE__, __LINE__};